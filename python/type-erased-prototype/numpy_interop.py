@@ -0,0 +1,20 @@
+import numpy as np
+from dataset_exports import *
+
+d = Dataset()
+d.insert(Variable(Coord.Tof, Dimensions(Dimension.Tof, 3), [1.0, 2.0, 3.0]))
+dims = Dimensions([(Dimension.Tof, 3), (Dimension.Spectrum, 2)])
+d.insert(Variable(Data.Value, "sample", dims,
+                  np.arange(6.0).reshape(3, 2, order='F')))
+
+# Read-only arrays keep the data alive, modifying the Dataset triggers a copy.
+snapshot = d.get_const(Data.Value, "sample")
+
+# Axis i of the array corresponds to dimension i, data is not copied.
+values = d.get(Data.Value, "sample")
+print(values.shape, values.flags['F_CONTIGUOUS'])
+values[0, 0] = 42.0
+print(snapshot[0, 0], d.get_const(Data.Value, "sample")[0, 0])
+
+# Reductions in NumPy operate directly on the Dataset's memory.
+print(np.sum(values, axis=0))
@@ -0,0 +1,23 @@
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor
+from dataset_exports import *
+
+def make_run(n_spec, n_tof):
+    d = Dataset()
+    d.insert(Variable(Coord.Tof, Dimensions(Dimension.Tof, n_tof),
+                      np.arange(n_tof, dtype=float)))
+    dims = Dimensions([(Dimension.Tof, n_tof), (Dimension.Spectrum, n_spec)])
+    d.insert(Variable(Data.Value, "sample", dims, np.ones(n_tof * n_spec)))
+    d.insert(Variable(Data.Variance, "sample", dims, np.ones(n_tof * n_spec)))
+    return d
+
+# Operations release the GIL, so processing runs from several Python threads
+# proceeds in parallel.
+def process(run):
+    run *= run
+    return slice(run, Dimension.Spectrum, 0)
+
+runs = [make_run(1000, 1000) for i in range(8)]
+with ThreadPoolExecutor(max_workers=4) as pool:
+    results = list(pool.map(process, runs))
+print(len(results))
@@ -0,0 +1,621 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "arrow.h"
+
+namespace {
+struct SchemaData {
+  std::string format;
+  std::string name;
+  std::string metadata;
+  std::vector<ArrowSchema> children;
+  std::vector<ArrowSchema *> childPointers;
+  std::unique_ptr<ArrowSchema> dictionary;
+};
+
+struct ArrayData {
+  // Holding a copy of the exported variable keeps its data alive. Every array
+  // referencing the data holds a copy since the consumer may move children out
+  // and release them independently of the parent.
+  std::unique_ptr<const Variable> owner;
+  std::vector<const void *> buffers;
+  std::vector<ArrowArray> children;
+  std::vector<ArrowArray *> childPointers;
+  std::unique_ptr<ArrowArray> dictionary;
+};
+
+void releaseSchema(ArrowSchema *schema) {
+  // Children may have been moved out by the consumer, in which case their
+  // release callback has been set to null.
+  for (int64_t i = 0; i < schema->n_children; ++i)
+    if (schema->children[i]->release)
+      schema->children[i]->release(schema->children[i]);
+  if (schema->dictionary && schema->dictionary->release)
+    schema->dictionary->release(schema->dictionary);
+  delete static_cast<SchemaData *>(schema->private_data);
+  schema->release = nullptr;
+}
+
+void releaseArray(ArrowArray *array) {
+  for (int64_t i = 0; i < array->n_children; ++i)
+    if (array->children[i]->release)
+      array->children[i]->release(array->children[i]);
+  if (array->dictionary && array->dictionary->release)
+    array->dictionary->release(array->dictionary);
+  delete static_cast<ArrayData *>(array->private_data);
+  array->release = nullptr;
+}
+
+SchemaData &initSchema(ArrowSchema *schema, std::string format,
+                       std::string name, std::string metadata,
+                       const int64_t nChildren) {
+  auto data = new SchemaData{std::move(format), std::move(name),
+                             std::move(metadata), {}, {}, nullptr};
+  data->children.resize(nChildren);
+  for (auto &child : data->children)
+    data->childPointers.push_back(&child);
+  schema->format = data->format.c_str();
+  schema->name = data->name.c_str();
+  schema->metadata = data->metadata.empty() ? nullptr : data->metadata.data();
+  schema->flags = 0;
+  schema->n_children = nChildren;
+  schema->children = data->childPointers.data();
+  schema->dictionary = nullptr;
+  schema->release = releaseSchema;
+  schema->private_data = data;
+  return *data;
+}
+
+ArrayData &initArray(ArrowArray *array, const int64_t length,
+                     const int64_t nBuffers, const int64_t nChildren,
+                     const Variable *owner = nullptr) {
+  auto data = new ArrayData;
+  if (owner)
+    data->owner = std::make_unique<const Variable>(*owner);
+  // Buffer 0 is the validity bitmap, we never have null entries.
+  data->buffers.resize(nBuffers, nullptr);
+  data->children.resize(nChildren);
+  for (auto &child : data->children)
+    data->childPointers.push_back(&child);
+  array->length = length;
+  array->null_count = 0;
+  array->offset = 0;
+  array->n_buffers = nBuffers;
+  array->n_children = nChildren;
+  array->buffers = data->buffers.data();
+  array->children = data->childPointers.data();
+  array->dictionary = nullptr;
+  array->release = releaseArray;
+  array->private_data = data;
+  return *data;
+}
+
+std::string
+encodeMetadata(const std::vector<std::pair<std::string, std::string>> &items) {
+  std::string metadata;
+  const auto append = [&metadata](const int32_t value) {
+    metadata.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  append(static_cast<int32_t>(items.size()));
+  for (const auto &item : items) {
+    append(static_cast<int32_t>(item.first.size()));
+    metadata += item.first;
+    append(static_cast<int32_t>(item.second.size()));
+    metadata += item.second;
+  }
+  return metadata;
+}
+
+std::map<std::string, std::string> decodeMetadata(const char *metadata) {
+  std::map<std::string, std::string> items;
+  if (!metadata)
+    return items;
+  const auto read = [&metadata]() {
+    int32_t value;
+    std::memcpy(&value, metadata, sizeof(value));
+    metadata += sizeof(value);
+    return value;
+  };
+  const auto readString = [&metadata, &read]() {
+    const auto size = read();
+    std::string value(metadata, size);
+    metadata += size;
+    return value;
+  };
+  const auto count = read();
+  for (int32_t i = 0; i < count; ++i) {
+    auto key = readString();
+    items[key] = readString();
+  }
+  return items;
+}
+
+const char *coordName(const uint16_t id) {
+  switch (id) {
+  case tag_id<Coord::X>:
+    return "X";
+  case tag_id<Coord::Y>:
+    return "Y";
+  case tag_id<Coord::Z>:
+    return "Z";
+  case tag_id<Coord::Tof>:
+    return "Tof";
+  case tag_id<Coord::MonitorTof>:
+    return "MonitorTof";
+  case tag_id<Coord::DetectorId>:
+    return "DetectorId";
+  case tag_id<Coord::SpectrumNumber>:
+    return "SpectrumNumber";
+  case tag_id<Coord::DetectorPosition>:
+    return "DetectorPosition";
+  case tag_id<Coord::DetectorGrouping>:
+    return "DetectorGrouping";
+  case tag_id<Coord::RowLabel>:
+    return "RowLabel";
+  case tag_id<Coord::Polarization>:
+    return "Polarization";
+  case tag_id<Coord::Temperature>:
+    return "Temperature";
+  case tag_id<Coord::TimeInterval>:
+    return "TimeInterval";
+  case tag_id<Coord::Mask>:
+    return "Mask";
+  case tag_id<Coord::Time>:
+    return "Time";
+  case tag_id<Coord::L1>:
+    return "L1";
+  case tag_id<Coord::L2>:
+    return "L2";
+  case tag_id<Coord::TwoTheta>:
+    return "TwoTheta";
+  case tag_id<Coord::DSpacing>:
+    return "DSpacing";
+  case tag_id<Coord::Wavelength>:
+    return "Wavelength";
+  case tag_id<Coord::DeltaE>:
+    return "DeltaE";
+  case tag_id<Coord::SourcePosition>:
+    return "SourcePosition";
+  case tag_id<Coord::SamplePosition>:
+    return "SamplePosition";
+  default:
+    throw std::runtime_error("Unknown coordinate.");
+  }
+}
+
+void checkNoNulls(const ArrowArray &array) {
+  if (array.null_count != 0)
+    throw std::runtime_error("Cannot import Arrow array with null entries.");
+}
+
+/// Copies `length` elements starting at `offset` from an Arrow buffer with
+/// primitive type given by `format` to `out`, converting to T.
+template <class T>
+void copyConverted(const char format, const void *buffer, const int64_t offset,
+                   const int64_t length, T *out) {
+  const auto convert = [&](const auto *data) {
+    std::transform(data + offset, data + offset + length, out,
+                   [](const auto x) { return static_cast<T>(x); });
+  };
+  switch (format) {
+  case 'g':
+    return convert(static_cast<const double *>(buffer));
+  case 'f':
+    return convert(static_cast<const float *>(buffer));
+  case 'l':
+    return convert(static_cast<const int64_t *>(buffer));
+  case 'L':
+    return convert(static_cast<const uint64_t *>(buffer));
+  case 'i':
+    return convert(static_cast<const int32_t *>(buffer));
+  case 'I':
+    return convert(static_cast<const uint32_t *>(buffer));
+  case 's':
+    return convert(static_cast<const int16_t *>(buffer));
+  case 'S':
+    return convert(static_cast<const uint16_t *>(buffer));
+  case 'c':
+    return convert(static_cast<const int8_t *>(buffer));
+  case 'C':
+    return convert(static_cast<const uint8_t *>(buffer));
+  default:
+    throw std::runtime_error("Unsupported Arrow format `" +
+                             std::string(1, format) + "`.");
+  }
+}
+
+bool isPrimitive(const char *format) {
+  return std::strlen(format) == 1 && std::strchr("gflLiIsScC", format[0]);
+}
+
+template <class T> struct ArrowColumn;
+
+template <class T> struct PrimitiveColumn {
+  static gsl::index children() { return 0; }
+  static void exportData(gsl::span<const T> data, ArrowSchema *,
+                         ArrowArray *array, const Variable &owner) {
+    auto &arrayData = initArray(array, data.size(), 2, 0, &owner);
+    arrayData.buffers[1] = data.data();
+  }
+  static Vector<T> importData(const ArrowSchema &schema,
+                              const ArrowArray &array) {
+    if (!isPrimitive(schema.format))
+      throw std::runtime_error("Arrow column has non-numeric type.");
+    Vector<T> data(array.length);
+    if (array.length > 0)
+      copyConverted(schema.format[0], array.buffers[1], array.offset,
+                    array.length, data.data());
+    return data;
+  }
+};
+
+template <> struct ArrowColumn<Vector<double>> : PrimitiveColumn<double> {
+  static const char *format() { return "g"; }
+};
+template <> struct ArrowColumn<Vector<int32_t>> : PrimitiveColumn<int32_t> {
+  static const char *format() { return "i"; }
+};
+template <> struct ArrowColumn<Vector<int64_t>> : PrimitiveColumn<int64_t> {
+  static const char *format() { return "l"; }
+};
+
+template <class Offset> StringColumn importStrings(const ArrowArray &array) {
+  if (array.length == 0)
+    return StringColumn();
+  const auto offsets =
+      static_cast<const Offset *>(array.buffers[1]) + array.offset;
+  const auto chars = static_cast<const char *>(array.buffers[2]);
+  Vector<int64_t> columnOffsets(array.length + 1);
+  for (int64_t i = 0; i <= array.length; ++i)
+    columnOffsets[i] = offsets[i] - offsets[0];
+  return StringColumn(std::move(columnOffsets),
+                      Vector<char>(chars + offsets[0],
+                                   chars + offsets[array.length]));
+}
+
+StringColumn importStrings(const ArrowSchema &schema, const ArrowArray &array) {
+  checkNoNulls(array);
+  if (std::strcmp(schema.format, "u") == 0)
+    return importStrings<int32_t>(array);
+  if (std::strcmp(schema.format, "U") == 0)
+    return importStrings<int64_t>(array);
+  throw std::runtime_error("Arrow column does not contain strings.");
+}
+
+Vector<int32_t> importCodes(const ArrowSchema &schema,
+                            const ArrowArray &array) {
+  if (!isPrimitive(schema.format))
+    throw std::runtime_error("Arrow dictionary has non-integer indices.");
+  Vector<int32_t> codes(array.length);
+  if (array.length > 0)
+    copyConverted(schema.format[0], array.buffers[1], array.offset,
+                  array.length, codes.data());
+  return codes;
+}
+
+// Large UTF-8, i.e., with 64 bit offsets. This is the memory layout of
+// StringColumn, so the data is shared.
+template <> struct ArrowColumn<StringColumn> {
+  static const char *format() { return "U"; }
+  static gsl::index children() { return 0; }
+  static void exportData(const ColumnSpan<const StringColumn> &data,
+                         ArrowSchema *, ArrowArray *array,
+                         const Variable &owner) {
+    auto &arrayData = initArray(array, data.size(), 3, 0, &owner);
+    array->offset = data.offset();
+    arrayData.buffers[1] = data.column().offsets().data();
+    arrayData.buffers[2] = data.column().values().data();
+  }
+  static StringColumn importData(const ArrowSchema &schema,
+                                 const ArrowArray &array) {
+    if (!schema.dictionary)
+      return importStrings(schema, array);
+    // Decode dictionary-encoded data.
+    const auto codes = importCodes(schema, array);
+    const auto dictionary =
+        importStrings(*schema.dictionary, *array.dictionary);
+    StringColumn data;
+    for (const auto code : codes) {
+      if (code < 0 || code >= dictionary.size())
+        throw std::runtime_error("Dictionary code out of range.");
+      data.push_back(dictionary[code]);
+    }
+    return data;
+  }
+};
+
+// Dictionary-encoded array with int32 indices. Both codes and dictionary are
+// shared.
+template <> struct ArrowColumn<DictionaryColumn> {
+  static const char *format() { return "i"; }
+  static gsl::index children() { return 0; }
+  static void exportData(const ColumnSpan<const DictionaryColumn> &data,
+                         ArrowSchema *schema, ArrowArray *array,
+                         const Variable &owner) {
+    auto &schemaData = *static_cast<SchemaData *>(schema->private_data);
+    schemaData.dictionary = std::make_unique<ArrowSchema>();
+    initSchema(schemaData.dictionary.get(), "U", "", "", 0);
+    schema->dictionary = schemaData.dictionary.get();
+
+    auto &arrayData = initArray(array, data.size(), 2, 0, &owner);
+    array->offset = data.offset();
+    arrayData.buffers[1] = data.column().codes().data();
+    arrayData.dictionary = std::make_unique<ArrowArray>();
+    ArrowColumn<StringColumn>::exportData(data.column().dictionary(), nullptr,
+                                          arrayData.dictionary.get(), owner);
+    array->dictionary = arrayData.dictionary.get();
+  }
+  static DictionaryColumn importData(const ArrowSchema &schema,
+                                     const ArrowArray &array) {
+    if (schema.dictionary)
+      return DictionaryColumn(
+          importCodes(schema, array),
+          importStrings(*schema.dictionary, *array.dictionary));
+    const auto strings = importStrings(schema, array);
+    return DictionaryColumn(strings.begin(), strings.end());
+  }
+};
+
+// Coord::TimeInterval as fixed-size list of two int64. The memory layout of
+// std::pair<int64_t, int64_t> matches that of the flat child, so the data is
+// shared.
+template <> struct ArrowColumn<Vector<std::pair<int64_t, int64_t>>> {
+  static const char *format() { return "+w:2"; }
+  static gsl::index children() { return 1; }
+  static void exportData(gsl::span<const std::pair<int64_t, int64_t>> data,
+                         ArrowSchema *schema, ArrowArray *array,
+                         const Variable &owner) {
+    static_assert(sizeof(std::pair<int64_t, int64_t>) == 2 * sizeof(int64_t),
+                  "Unexpected padding in std::pair.");
+    auto &arrayData = initArray(array, data.size(), 1, 1, &owner);
+    initSchema(schema->children[0], "l", "item", "", 0);
+    auto &child =
+        initArray(&arrayData.children[0], 2 * data.size(), 2, 0, &owner);
+    child.buffers[1] = data.data();
+  }
+  static Vector<std::pair<int64_t, int64_t>>
+  importData(const ArrowSchema &schema, const ArrowArray &array) {
+    if (std::strcmp(schema.format, format()) != 0)
+      throw std::runtime_error("Arrow column does not contain time intervals.");
+    const auto &child = *array.children[0];
+    checkNoNulls(child);
+    Vector<int64_t> flat(2 * array.length);
+    if (array.length > 0)
+      copyConverted(schema.children[0]->format[0], child.buffers[1],
+                    child.offset + 2 * array.offset, flat.size(),
+                    flat.data());
+    Vector<std::pair<int64_t, int64_t>> data(array.length);
+    for (int64_t i = 0; i < array.length; ++i)
+      data[i] = {flat[2 * i], flat[2 * i + 1]};
+    return data;
+  }
+};
+
+// Coord::DetectorGrouping as large list of int64. This is the memory layout of
+// IndexListColumn, so the data is shared.
+template <> struct ArrowColumn<IndexListColumn> {
+  static const char *format() { return "+L"; }
+  static gsl::index children() { return 1; }
+  static void exportData(const ColumnSpan<const IndexListColumn> &data,
+                         ArrowSchema *schema, ArrowArray *array,
+                         const Variable &owner) {
+    static_assert(sizeof(gsl::index) == sizeof(int64_t),
+                  "gsl::index does not match Arrow int64.");
+    const auto &column = data.column();
+    auto &arrayData = initArray(array, data.size(), 2, 1, &owner);
+    array->offset = data.offset();
+    arrayData.buffers[1] = column.offsets().data();
+    initSchema(schema->children[0], "l", "item", "", 0);
+    auto &child =
+        initArray(&arrayData.children[0], column.values().size(), 2, 0, &owner);
+    child.buffers[1] = column.values().data();
+  }
+  static IndexListColumn importData(const ArrowSchema &schema,
+                                    const ArrowArray &array) {
+    if (std::strcmp(schema.format, format()) != 0)
+      throw std::runtime_error("Arrow column does not contain lists.");
+    if (array.length == 0)
+      return IndexListColumn();
+    const auto offsets =
+        static_cast<const int64_t *>(array.buffers[1]) + array.offset;
+    const auto &child = *array.children[0];
+    checkNoNulls(child);
+    Vector<int64_t> columnOffsets(array.length + 1);
+    for (int64_t i = 0; i <= array.length; ++i)
+      columnOffsets[i] = offsets[i] - offsets[0];
+    Vector<gsl::index> values(columnOffsets.back());
+    if (!values.empty())
+      copyConverted(schema.children[0]->format[0], child.buffers[1],
+                    child.offset + offsets[0], values.size(), values.data());
+    return IndexListColumn(std::move(columnOffsets), std::move(values));
+  }
+};
+
+// Positions as struct of three double arrays x, y, and z. This is the memory
+// layout of PositionColumn, so the data is shared.
+template <> struct ArrowColumn<PositionColumn> {
+  static const char *format() { return "+s"; }
+  static gsl::index children() { return 3; }
+  static void exportData(const ColumnSpan<const PositionColumn> &data,
+                         ArrowSchema *schema, ArrowArray *array,
+                         const Variable &owner) {
+    const auto &column = data.column();
+    auto &arrayData = initArray(array, data.size(), 1, 3, &owner);
+    array->offset = data.offset();
+    const char *names[] = {"x", "y", "z"};
+    const double *components[] = {column.x().data(), column.y().data(),
+                                  column.z().data()};
+    for (gsl::index i = 0; i < 3; ++i) {
+      initSchema(schema->children[i], "g", names[i], "", 0);
+      auto &child =
+          initArray(&arrayData.children[i], column.size(), 2, 0, &owner);
+      child.buffers[1] = components[i];
+    }
+  }
+  static PositionColumn importData(const ArrowSchema &schema,
+                                   const ArrowArray &array) {
+    if (std::strcmp(schema.format, format()) != 0 || schema.n_children != 3)
+      throw std::runtime_error("Arrow column does not contain positions.");
+    std::array<Vector<double>, 3> components;
+    for (gsl::index i = 0; i < 3; ++i) {
+      const auto &child = *array.children[i];
+      checkNoNulls(child);
+      if (!isPrimitive(schema.children[i]->format))
+        throw std::runtime_error("Arrow column does not contain positions.");
+      components[i].resize(array.length);
+      if (array.length > 0)
+        copyConverted(schema.children[i]->format[0], child.buffers[1],
+                      child.offset + array.offset, array.length,
+                      components[i].data());
+    }
+    return PositionColumn(std::move(components[0]), std::move(components[1]),
+                          std::move(components[2]));
+  }
+};
+
+// Coord::Mask as boolean array. This is the memory layout of MaskColumn, so the
+// data is shared. Numeric arrays are imported with nonzero elements as set
+// flags.
+template <> struct ArrowColumn<MaskColumn> {
+  static const char *format() { return "b"; }
+  static gsl::index children() { return 0; }
+  static void exportData(const ColumnSpan<const MaskColumn> &data,
+                         ArrowSchema *, ArrowArray *array,
+                         const Variable &owner) {
+    auto &arrayData = initArray(array, data.size(), 2, 0, &owner);
+    array->offset = data.offset();
+    arrayData.buffers[1] = data.column().words().data();
+  }
+  static MaskColumn importData(const ArrowSchema &schema,
+                               const ArrowArray &array) {
+    MaskColumn data(array.length);
+    if (std::strcmp(schema.format, format()) == 0) {
+      const auto bytes = static_cast<const uint8_t *>(array.buffers[1]);
+      for (int64_t i = 0; i < array.length; ++i) {
+        const auto bit = array.offset + i;
+        data[i] = (bytes[bit / 8] >> (bit % 8)) & 1;
+      }
+      return data;
+    }
+    if (!isPrimitive(schema.format))
+      throw std::runtime_error("Arrow column does not contain a mask.");
+    const auto values = PrimitiveColumn<double>::importData(schema, array);
+    for (int64_t i = 0; i < array.length; ++i)
+      data[i] = values[i] != 0.0;
+    return data;
+  }
+};
+
+uint16_t defaultTag(const ArrowSchema &schema) {
+  const auto format =
+      schema.dictionary ? schema.dictionary->format : schema.format;
+  if (std::strcmp(format, "u") == 0 || std::strcmp(format, "U") == 0)
+    return tag_id<Data::String>;
+  if (schema.dictionary)
+    throw std::runtime_error(
+        "Only dictionary-encoded strings are supported.");
+  if (std::strcmp(format, "g") == 0 || std::strcmp(format, "f") == 0)
+    return tag_id<Data::Value>;
+  if (isPrimitive(format))
+    return tag_id<Data::Int>;
+  throw std::runtime_error("Unsupported Arrow format `" + std::string(format) +
+                           "`.");
+}
+
+/// Calls the release callbacks when going out of scope, in particular also if
+/// an import fails.
+struct ReleaseGuard {
+  ~ReleaseGuard() {
+    if (array->release)
+      array->release(array);
+    if (schema->release)
+      schema->release(schema);
+  }
+  ArrowSchema *schema;
+  ArrowArray *array;
+};
+}
+
+void exportToArrow(const Dataset &dataset, ArrowSchema *schema,
+                   ArrowArray *array) {
+  const auto &dims = dataset.dimensions();
+  if (dims.count() != 1 || dims.isRagged())
+    throw std::runtime_error(
+        "Arrow export requires a Dataset with a single dimension.");
+  for (const auto &var : dataset)
+    if (!(var.dimensions() == dims))
+      throw std::runtime_error("Arrow export requires all variables to depend "
+                               "on the dimension of the Dataset.");
+
+  auto &schemaData = initSchema(
+      schema, "+s", "",
+      encodeMetadata({{"dimension",
+                       std::to_string(static_cast<int>(dims.label(0)))}}),
+      dataset.size());
+  auto &arrayData = initArray(array, dims.size(0), 1, dataset.size());
+  for (gsl::index i = 0; i < dataset.size(); ++i) {
+    const auto &var = dataset[i];
+    auto &childSchema = schemaData.children[i];
+    auto &childArray = arrayData.children[i];
+    callForTag(var.type(), [&](auto tag) {
+      using Tag = decltype(tag);
+      using Column = ArrowColumn<storage_t<Tag>>;
+      initSchema(
+          &childSchema, Column::format(),
+          var.isCoord() ? coordName(var.type()) : var.name(),
+          encodeMetadata(
+              {{"tag", std::to_string(var.type())},
+               {"unit", std::to_string(static_cast<int>(var.unit().id()))}}),
+          Column::children());
+      Column::exportData(var.get<const Tag>(), &childSchema, &childArray, var);
+    });
+  }
+}
+
+Dataset importFromArrow(ArrowSchema *schema, ArrowArray *array) {
+  ReleaseGuard guard{schema, array};
+  if (std::strcmp(schema->format, "+s") != 0)
+    throw std::runtime_error("Arrow import requires a struct array.");
+  checkNoNulls(*array);
+  const auto metadata = decodeMetadata(schema->metadata);
+  const auto dim = metadata.count("dimension")
+                       ? static_cast<Dimension>(
+                             std::stoi(metadata.at("dimension")))
+                       : Dimension::Row;
+
+  Dataset dataset;
+  for (int64_t i = 0; i < schema->n_children; ++i) {
+    const auto &columnSchema = *schema->children[i];
+    const auto &columnArray = *array->children[i];
+    checkNoNulls(columnArray);
+    if (columnArray.length != array->length)
+      throw std::runtime_error("Arrow struct array has children of "
+                               "inconsistent length.");
+    const auto columnMetadata = decodeMetadata(columnSchema.metadata);
+    const uint16_t id = columnMetadata.count("tag")
+                            ? std::stoi(columnMetadata.at("tag"))
+                            : defaultTag(columnSchema);
+    callForTag(id, [&](auto tag) {
+      using Tag = decltype(tag);
+      auto var = makeVariable<Tag>(
+          Dimensions(dim, array->length),
+          ArrowColumn<storage_t<Tag>>::importData(columnSchema, columnArray));
+      if (columnMetadata.count("unit"))
+        var.setUnit(
+            static_cast<Unit::Id>(std::stoi(columnMetadata.at("unit"))));
+      if (!var.isCoord())
+        var.setName(columnSchema.name ? columnSchema.name : "");
+      dataset.insert(std::move(var));
+    });
+  }
+  return dataset;
+}
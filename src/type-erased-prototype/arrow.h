@@ -0,0 +1,69 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef ARROW_H
+#define ARROW_H
+
+#include <cstdint>
+
+#include "dataset.h"
+
+// Structs of the Arrow C data interface, see
+// https://arrow.apache.org/docs/format/CDataInterface.html. This is a stable
+// ABI, so we do not need to depend on Arrow. The guard is the one defined by
+// the specification, such that this can be combined with Arrow's own headers.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema *);
+  void *private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray *);
+  void *private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/// Exports a table-like Dataset, i.e., a Dataset with a single dimension such
+/// as Dimension::Row, as an Arrow struct array with one child per variable.
+///
+/// Buffers of variables are handed out without copying, this includes strings
+/// (StringColumn) and dictionary-encoded strings (DictionaryColumn). The
+/// release callback of `array` holds a copy of each exported Variable, i.e., it
+/// keeps the underlying data alive and unmodified (modifications of `dataset`
+/// trigger copy-on-write). Tag, unit, and dimension are stored as field
+/// metadata, such that importFromArrow can restore the Dataset.
+void exportToArrow(const Dataset &dataset, ArrowSchema *schema,
+                   ArrowArray *array);
+
+/// Imports an Arrow struct array into a Dataset and releases `schema` and
+/// `array`. Columns without tag metadata (i.e., not created by exportToArrow)
+/// are imported as Data::Value, Data::Int, or Data::String, depending on their
+/// type. Data is copied since a Variable owns its memory.
+Dataset importFromArrow(ArrowSchema *schema, ArrowArray *array);
+
+#endif // ARROW_H
@@ -0,0 +1,50 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include "convert_units.h"
+
+Dataset makeInstrument(const gsl::index nSpec) {
+  Dataset d;
+  d.insert<Coord::L1>({}, {10.0});
+  Vector<double> l2(nSpec);
+  Vector<double> twoTheta(nSpec);
+  Vector<std::vector<gsl::index>> grouping(nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i) {
+    l2[i] = 2.0 + 0.1 * (i % 10);
+    twoTheta[i] = 0.5 + 2.0 * i / nSpec;
+    grouping[i] = {i};
+  }
+  d.insert<Coord::L2>({Dimension::Detector, nSpec}, l2);
+  d.insert<Coord::TwoTheta>({Dimension::Detector, nSpec}, twoTheta);
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, nSpec}, grouping);
+  return d;
+}
+
+// Conversion of the bin edges of 10^4 spectra with 1000 bins. The argument
+// selects the target, 0 d-spacing and 1 energy transfer, and whether the
+// time-of-flight axis is shared (0) or given for each spectrum (1).
+static void BM_ConvertUnits(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = 1000;
+  auto d = makeInstrument(nSpec);
+  Dimensions dims(Dimension::Tof, nBin + 1);
+  if (state.range(1))
+    dims.add(Dimension::Spectrum, nSpec);
+  Vector<double> tof(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    tof[i] = 5000.0 + 10.0 * (i % (nBin + 1));
+  d.insert<Coord::Tof>(dims, tof);
+  const auto target = state.range(0) ? Dimension::DeltaE : Dimension::DSpacing;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(convertUnits(d, target, 25.0));
+  state.SetItemsProcessed(state.iterations() * nSpec * (nBin + 1));
+}
+BENCHMARK(BM_ConvertUnits)
+    ->ArgsProduct({{0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
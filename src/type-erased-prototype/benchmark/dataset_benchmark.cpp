@@ -6,6 +6,7 @@
 #include <benchmark/benchmark.h>
 
 #include "dataset.h"
+#include "dataset_index.h"
 
 // Dataset::get requires a search based on a tag defined by the type and is thus
 // potentially expensive.
@@ -70,6 +71,86 @@ static void BM_Dataset_as_Histogram_with_slice(benchmark::State &state) {
 }
 BENCHMARK(BM_Dataset_as_Histogram_with_slice);
 
+// Copying a table with string columns, e.g., when modifying a shared table.
+// With columnar string storage this is independent of the string length.
+static void BM_Dataset_copy_string_table(benchmark::State &state) {
+  const gsl::index nRow = state.range(0);
+  Vector<std::string> labels(nRow);
+  for (gsl::index i = 0; i < nRow; ++i)
+    labels[i] = "a row label that is too long for small-string optimization " +
+                std::to_string(i);
+  Dataset table;
+  table.insert<Coord::RowLabel>({Dimension::Row, nRow}, labels);
+  table.insert<Data::String>("comment", {Dimension::Row, nRow}, labels);
+  table.insert<Data::Value>("value", {Dimension::Row, nRow}, nRow);
+
+  for (auto _ : state) {
+    auto copy(table);
+    // Break sharing
+    copy.get<Coord::RowLabel>();
+    copy.get<Data::String>("comment");
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * nRow);
+}
+BENCHMARK(BM_Dataset_copy_string_table)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
+// Copying the spectrum-detector mapping, e.g., when modifying a shared
+// instrument. With CSR storage this is two memcpy.
+static void BM_Dataset_copy_grouping(benchmark::State &state) {
+  const gsl::index nSpec = state.range(0);
+  IndexListColumn grouping;
+  grouping.reserve(nSpec, 2 * nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i) {
+    const std::vector<gsl::index> detectors{2 * i, 2 * i + 1};
+    grouping.push_back(detectors);
+  }
+  Dataset d;
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, nSpec}, grouping);
+
+  for (auto _ : state) {
+    auto copy(d);
+    // Break sharing
+    copy.get<Coord::DetectorGrouping>();
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * nSpec);
+}
+BENCHMARK(BM_Dataset_copy_grouping)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 20)
+    ->Unit(benchmark::kMicrosecond);
+
+// Building the detector-to-spectrum index, done once after each change of the
+// grouping.
+static void BM_Dataset_detectorSpectra(benchmark::State &state) {
+  const gsl::index nSpec = state.range(0);
+  IndexListColumn grouping;
+  grouping.reserve(nSpec, 2 * nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i) {
+    const std::vector<gsl::index> detectors{i, (i + 1) % nSpec};
+    grouping.push_back(detectors);
+  }
+  Dataset d;
+  d.insert<Coord::DetectorPosition>({Dimension::Detector, nSpec}, nSpec);
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, nSpec}, grouping);
+
+  for (auto _ : state) {
+    // Invalidate the cache.
+    d.get<Coord::DetectorGrouping>();
+    benchmark::DoNotOptimize(d.detectorSpectra());
+  }
+  state.SetItemsProcessed(state.iterations() * nSpec);
+}
+BENCHMARK(BM_Dataset_detectorSpectra)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 20)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
 Dataset makeSingleDataDataset(const gsl::index nSpec, const gsl::index nPoint) {
   Dataset d;
 
@@ -215,4 +296,26 @@ BENCHMARK(BM_Dataset_cache_blocking_no_slicing)
     ->RangeMultiplier(2)
     ->Range(2 << 9, 2 << 14);
 
+// Building a DatasetIndex of 10^6 shuffled detector IDs and looking them all
+// up. The first argument is the stride between IDs: 1 gives dense IDs using
+// the direct-offset array, larger strides use the hash table.
+static void BM_DatasetIndex_build_and_lookup(benchmark::State &state) {
+  const gsl::index size = 1000000;
+  const int32_t stride = state.range(0);
+  Vector<int32_t> ids(size);
+  for (gsl::index i = 0; i < size; ++i)
+    ids[i] = (i * 7919 % size) * stride;
+  Dataset d;
+  d.insert<Coord::DetectorId>({Dimension::Detector, size}, ids);
+  for (auto _ : state) {
+    DatasetIndex<Coord::DetectorId> index(d);
+    benchmark::DoNotOptimize(index.indices(ids));
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_DatasetIndex_build_and_lookup)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
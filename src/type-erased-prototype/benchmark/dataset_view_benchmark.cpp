@@ -223,4 +223,25 @@ BENCHMARK(BM_DatasetView_multi_column_mixed_dimension_nested_transpose)
     ->Range(8, 8 << 13);
 ;
 
+// Reading derived standard deviations, computed on access or from the cache
+// (second argument 1).
+static void BM_DatasetView_derived_stddev(benchmark::State &state) {
+  const gsl::index size = state.range(0);
+  Dataset d;
+  d.insert<Data::Variance>("data", {Dimension::X, size}, size, 4.0);
+  if (state.range(1))
+    d.enableCache<Data::StdDev>();
+
+  for (auto _ : state) {
+    double sum = 0.0;
+    for (const auto &item : DatasetView<Data::StdDev>(d))
+      sum += item.get<Data::StdDev>();
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_DatasetView_derived_stddev)
+    ->RangeMultiplier(8)
+    ->Ranges({{1 << 12, 1 << 21}, {0, 1}});
+
 BENCHMARK_MAIN();
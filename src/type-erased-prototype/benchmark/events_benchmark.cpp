@@ -0,0 +1,192 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <random>
+#include <tuple>
+
+#include "events.h"
+
+Dataset makeEvents(const gsl::index nSpec, const gsl::index nEvent) {
+  Vector<gsl::index> counts(nSpec, nEvent / nSpec);
+  const auto dims = eventDimensions(
+      makeVariable<Data::DimensionSize>({Dimension::Spectrum, nSpec}, counts));
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> tof(0.0, 100000.0);
+  Vector<double> tofs(dims.volume());
+  for (auto &t : tofs)
+    t = tof(rng);
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, nSpec}, nSpec);
+  d.insert<Data::Tof>("events", dims, std::move(tofs));
+  d.insert<Data::PulseTime>("events", dims, dims.volume());
+  return d;
+}
+
+Variable makeEdges(const gsl::index nBin, const bool log) {
+  Vector<double> edges(nBin + 1);
+  for (gsl::index i = 0; i <= nBin; ++i)
+    edges[i] = log ? 10.0 * std::pow(10000.0, static_cast<double>(i) / nBin)
+                   : 100000.0 * i / nBin;
+  return makeVariable<Coord::Tof>({Dimension::Tof, nBin + 1}, edges);
+}
+
+// Histogramming of 10^7 events. Arguments are the number of spectra and the
+// bin type: 0 linear, 1 logarithmic, 2 irregular, falling back to binary
+// search.
+static void BM_Events_histogram(benchmark::State &state) {
+  const gsl::index nEvent = 10000000;
+  const auto events = makeEvents(state.range(0), nEvent);
+  auto edges = makeEdges(1000, state.range(1) == 1);
+  if (state.range(1) == 2)
+    edges.get<Coord::Tof>()[1] += 1.0;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(histogram(events, "events", edges));
+  state.SetItemsProcessed(state.iterations() * nEvent);
+}
+BENCHMARK(BM_Events_histogram)
+    ->ArgsProduct({{1, 1000, 10000}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Histogramming of 10^7 compressed events with 1000 linear bins. Arguments
+// are the number of spectra and whether time-of-flight is stored as float.
+// Events are in 1000 pulses.
+static void BM_Events_histogram_compact(benchmark::State &state) {
+  const gsl::index nEvent = 10000000;
+  auto events = makeEvents(state.range(0), nEvent);
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  for (gsl::index i = 0; i < nEvent; ++i)
+    pulseTimes[i] = (i * 7919) % 1000;
+  const auto compact = compress(events, "events", state.range(1));
+  const auto edges = makeEdges(1000, false);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(histogram(compact, "events", edges));
+  state.SetItemsProcessed(state.iterations() * nEvent);
+  state.counters["bytes/event"] =
+      static_cast<double>(compact.pulses().size() * 4 +
+                          compact.tof().size() * 8 +
+                          compact.floatTof().size() * 4) /
+      nEvent;
+}
+BENCHMARK(BM_Events_histogram_compact)
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+Variable makeIntervals(const gsl::index count) {
+  Vector<std::pair<int64_t, int64_t>> intervals;
+  const int64_t step = 1000 / count;
+  for (int64_t start = 0; start < 1000; start += step)
+    intervals.emplace_back(start, start + step / 2);
+  const auto size = static_cast<gsl::index>(intervals.size());
+  return makeVariable<Coord::TimeInterval>({Dimension::Time, size},
+                                           std::move(intervals));
+}
+
+Dataset makePulsedEvents(const gsl::index nSpec, const gsl::index nEvent) {
+  auto events = makeEvents(nSpec, nEvent);
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  for (gsl::index i = 0; i < nEvent; ++i)
+    pulseTimes[i] = (i * 7919) % 1000;
+  sortEvents<Data::PulseTime>(events, "events");
+  return events;
+}
+
+// Filtering 10^7 events sorted by pulse time in 1000 pulses. Arguments are the
+// number of spectra and the number of intervals.
+static void BM_Events_filter(benchmark::State &state) {
+  const gsl::index nEvent = 10000000;
+  const auto events = makePulsedEvents(state.range(0), nEvent);
+  const auto intervals = makeIntervals(state.range(1));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(filterEvents(events, "events", intervals));
+  state.SetItemsProcessed(state.iterations() * nEvent);
+}
+BENCHMARK(BM_Events_filter)
+    ->ArgsProduct({{1000, 100000}, {1, 100}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// As BM_Events_filter, for compressed events with float time-of-flight.
+static void BM_Events_filter_compact(benchmark::State &state) {
+  const gsl::index nEvent = 10000000;
+  const auto events =
+      compress(makePulsedEvents(state.range(0), nEvent), "events", true);
+  const auto intervals = makeIntervals(state.range(1));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(filterEvents(events, intervals));
+  state.SetItemsProcessed(state.iterations() * nEvent);
+}
+BENCHMARK(BM_Events_filter_compact)
+    ->ArgsProduct({{1000, 100000}, {1, 100}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Sorting 10^7 events by time-of-flight, for given number of spectra.
+static void BM_Events_sort(benchmark::State &state) {
+  const gsl::index nEvent = 10000000;
+  const auto events = makeEvents(state.range(0), nEvent);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto sorted(events);
+    // Write access to make a copy, we do not want to measure that.
+    sorted.get<Data::Tof>("events");
+    sorted.get<Data::PulseTime>("events");
+    state.ResumeTiming();
+    sortEvents<Data::Tof>(sorted, "events");
+  }
+  state.SetItemsProcessed(state.iterations() * nEvent);
+}
+BENCHMARK(BM_Events_sort)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Baseline for BM_Events_sort: std::sort of each spectrum, with the event
+// variables zipped into tuples.
+static void BM_Events_sort_baseline(benchmark::State &state) {
+  const gsl::index nSpec = state.range(0);
+  const gsl::index nEvent = 10000000;
+  const auto events = makeEvents(nSpec, nEvent);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto sorted(events);
+    auto tofs = sorted.get<Data::Tof>("events");
+    auto pulseTimes = sorted.get<Data::PulseTime>("events");
+    state.ResumeTiming();
+#pragma omp parallel
+    {
+      std::vector<std::tuple<double, int64_t>> zipped;
+#pragma omp for
+      for (gsl::index spectrum = 0; spectrum < nSpec; ++spectrum) {
+        const auto begin = spectrum * (nEvent / nSpec);
+        const auto end = begin + nEvent / nSpec;
+        zipped.clear();
+        for (auto i = begin; i < end; ++i)
+          zipped.emplace_back(tofs[i], pulseTimes[i]);
+        std::sort(zipped.begin(), zipped.end(),
+                  [](const auto &a, const auto &b) {
+                    return std::get<0>(a) < std::get<0>(b);
+                  });
+        for (auto i = begin; i < end; ++i)
+          std::tie(tofs[i], pulseTimes[i]) = zipped[i - begin];
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * nEvent);
+}
+BENCHMARK(BM_Events_sort_baseline)
+    ->Arg(1)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
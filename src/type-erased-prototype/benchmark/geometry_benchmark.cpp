@@ -0,0 +1,70 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "geometry.h"
+
+const Position source{{0.0, 0.0, -10.0}};
+const Position sample{{0.0, 0.0, 0.0}};
+
+std::vector<Position> makePositions(const gsl::index size) {
+  std::vector<Position> positions(size);
+  for (gsl::index i = 0; i < size; ++i) {
+    const double phi = 0.01 * i;
+    positions[i] = {{2.0 * std::cos(phi), 2.0 * std::sin(phi),
+                     -1.0 + 2.0 * i / size}};
+  }
+  return positions;
+}
+
+// L2 of 10^6 detectors, with positions stored as structure of arrays.
+static void BM_Geometry_l2(benchmark::State &state) {
+  const PositionColumn positions(makePositions(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geometry::l2(positions, sample));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Geometry_l2)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Baseline: the same computation on an array of 3-vectors, as with the
+// previous storage of Coord::DetectorPosition.
+static void BM_Geometry_l2_array_of_structs(benchmark::State &state) {
+  const auto positions = makePositions(state.range(0));
+  for (auto _ : state) {
+    Vector<double> l2(positions.size());
+    for (gsl::index i = 0; i < positions.size(); ++i) {
+      const auto &p = positions[i];
+      l2[i] = std::sqrt((p[0] - sample[0]) * (p[0] - sample[0]) +
+                        (p[1] - sample[1]) * (p[1] - sample[1]) +
+                        (p[2] - sample[2]) * (p[2] - sample[2]));
+    }
+    benchmark::DoNotOptimize(l2.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Geometry_l2_array_of_structs)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000);
+
+static void BM_Geometry_twoTheta(benchmark::State &state) {
+  const PositionColumn positions(makePositions(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geometry::twoTheta(positions, source, sample));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Geometry_twoTheta)->RangeMultiplier(10)->Range(1000, 1000000);
+
+static void BM_Geometry_solidAngle(benchmark::State &state) {
+  const PositionColumn positions(makePositions(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geometry::solidAngle(positions, sample, 1e-4));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Geometry_solidAngle)->RangeMultiplier(10)->Range(1000, 1000000);
+
+BENCHMARK_MAIN();
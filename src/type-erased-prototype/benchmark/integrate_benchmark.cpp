@@ -0,0 +1,50 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include "integrate.h"
+
+Dataset makeHistograms(const gsl::index nSpec, const gsl::index nBin) {
+  Dataset d;
+  Vector<double> edges(nBin + 1);
+  for (gsl::index i = 0; i <= nBin; ++i)
+    edges[i] = i;
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, nBin + 1}, edges));
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  d.insert<Data::Value>("sample", dims, dims.volume(), 1.0);
+  return d;
+}
+
+// Integrating 10^4 spectra with 1000 bins over windows of 100 bins, with the
+// number of windows per spectrum given by the first argument. The second
+// argument selects computing the cumulative sums in each call (0) or caching
+// them (1), in which case each window is two binary searches.
+static void BM_Integrate(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = 1000;
+  const gsl::index windows = state.range(0);
+  auto d = makeHistograms(nSpec, nBin);
+  if (state.range(1))
+    d.enableCumulativeSum(Dimension::Tof, "sample");
+  Vector<double> begin(windows);
+  Vector<double> end(windows);
+  for (gsl::index i = 0; i < windows; ++i) {
+    begin[i] = (i * 7.3) - static_cast<gsl::index>(i * 7.3 / 900.0) * 900.0;
+    end[i] = begin[i] + 100.0;
+  }
+  const auto beginVar =
+      makeVariable<Coord::Tof>({Dimension::Tof, windows}, begin);
+  const auto endVar = makeVariable<Coord::Tof>({Dimension::Tof, windows}, end);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(integrate(d, beginVar, endVar));
+  state.SetItemsProcessed(state.iterations() * nSpec * windows);
+}
+BENCHMARK(BM_Integrate)
+    ->ArgsProduct({{1, 10, 100}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,61 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include "mask.h"
+
+Variable makeMask(const Dimensions &dims, const gsl::index period) {
+  Vector<char> flags(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    flags[i] = i % period == 0;
+  return makeVariable<Coord::Mask>(dims, flags);
+}
+
+Variable makeValues(const Dimensions &dims) {
+  Vector<double> values(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    values[i] = i % 17;
+  return makeVariable<Data::Value>(dims, values);
+}
+
+// Masking every state.range(0)-th element. Words of 64 flags with some flags
+// set are blended element-wise.
+static void BM_Mask_apply_elements(benchmark::State &state) {
+  const Dimensions dims(Dimension::X, 10000000);
+  const auto var = makeValues(dims);
+  const auto mask = makeMask(dims, state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(applyMask(var, mask));
+  state.SetItemsProcessed(state.iterations() * dims.volume());
+  state.SetBytesProcessed(state.iterations() * dims.volume() * 2 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Mask_apply_elements)
+    ->RangeMultiplier(8)
+    ->Range(1, 512)
+    ->Unit(benchmark::kMillisecond);
+
+// Masking the spectra of histograms with state.range(0) bins. Fully masked
+// words skip 64 spectra without reading their data.
+static void BM_Mask_plus_equals_spectra(benchmark::State &state) {
+  const gsl::index nSpec = 100000;
+  const gsl::index nBin = state.range(0);
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  auto a = makeValues(dims);
+  const auto b = makeValues(dims);
+  const auto mask = makeMask({Dimension::Spectrum, nSpec}, 2);
+  for (auto _ : state)
+    maskedPlusEquals(a, b, mask);
+  state.SetItemsProcessed(state.iterations() * nSpec);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * 3 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Mask_plus_equals_spectra)
+    ->RangeMultiplier(10)
+    ->Range(1, 100)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
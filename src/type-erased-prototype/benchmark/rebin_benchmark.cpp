@@ -0,0 +1,47 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include "rebin.h"
+
+Variable makeEdges(const Dimensions &dims, const double width) {
+  Vector<double> edges(dims.volume());
+  const auto bins = dims.size(Dimension::Tof);
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    edges[i] = width * (i % bins);
+  return makeVariable<Coord::Tof>(dims, edges);
+}
+
+Dataset makeHistograms(const gsl::index nSpec, const gsl::index nBin,
+                       const bool spectrumEdges) {
+  Dataset d;
+  Dimensions edgeDims(Dimension::Tof, nBin + 1);
+  if (spectrumEdges)
+    edgeDims.add(Dimension::Spectrum, nSpec);
+  d.insertAsEdge(Dimension::Tof, makeEdges(edgeDims, 1.0));
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  d.insert<Data::Value>("sample", dims, dims.volume(), 1.0);
+  d.insert<Data::Variance>("sample", dims, dims.volume(), 1.0);
+  return d;
+}
+
+// Rebinning 10^4 spectra with 1000 bins to 330 bins. The argument selects
+// edges shared by all spectra (0), using a precomputed plan, or edges for each
+// spectrum (1), computing overlaps for each spectrum.
+static void BM_Rebin(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = 1000;
+  const auto d = makeHistograms(nSpec, nBin, state.range(0));
+  const auto newEdges = makeEdges({Dimension::Tof, 331}, 3.03);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(rebin(d, Dimension::Tof, newEdges));
+  state.SetItemsProcessed(state.iterations() * nSpec * nBin);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * 2 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Rebin)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,110 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include "reduce.h"
+
+Dataset makeHistograms(const gsl::index nSpec, const gsl::index nBin) {
+  Dataset d;
+  d.insert<Coord::Tof>({Dimension::Tof, nBin}, nBin);
+  Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  Vector<double> values(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    values[i] = i % 17;
+  d.insert<Data::Value>("sample", dims, values);
+  d.insert<Data::Variance>("sample", dims, values);
+  return d;
+}
+
+// Sum over spectra, the outer dimension, as BM_Dataset_as_Histogram_with_slice
+// in dataset_benchmark.cpp but without creating a Dataset per spectrum.
+static void BM_Reduce_sum_spectra(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = state.range(0);
+  const auto d = makeHistograms(nSpec, nBin);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(d, Dimension::Spectrum));
+  state.SetItemsProcessed(state.iterations() * nSpec);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * 2 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Reduce_sum_spectra)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Sum over time-of-flight, the inner dimension.
+static void BM_Reduce_sum_tof(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = state.range(0);
+  const auto d = makeHistograms(nSpec, nBin);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(d, Dimension::Tof));
+  state.SetItemsProcessed(state.iterations() * nSpec);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * 2 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Reduce_sum_tof)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_Reduce_max_tof(benchmark::State &state) {
+  const gsl::index nSpec = 10000;
+  const gsl::index nBin = state.range(0);
+  auto d = makeHistograms(nSpec, nBin);
+  d.erase<Data::Variance>();
+  for (auto _ : state)
+    benchmark::DoNotOptimize(max(d, Dimension::Tof));
+  state.SetItemsProcessed(state.iterations() * nSpec);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * sizeof(double));
+}
+BENCHMARK(BM_Reduce_max_tof)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Sums where threads split the reduced dimension, with the argument selecting
+// the ReductionMode. The first argument selects reducing 10^7 bins of a single
+// spectrum (0) or 10^6 spectra with 10 bins (1).
+static void BM_Reduce_sum_mode(benchmark::State &state) {
+  const bool spectra = state.range(0);
+  const auto d = spectra ? makeHistograms(1000000, 10)
+                         : makeHistograms(1, 10000000);
+  const auto mode = static_cast<ReductionMode>(state.range(1));
+  const auto dim = spectra ? Dimension::Spectrum : Dimension::Tof;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sum(d, dim, mode));
+  state.SetBytesProcessed(state.iterations() * 10000000 * 2 * sizeof(double));
+}
+BENCHMARK(BM_Reduce_sum_mode)
+    ->ArgsProduct({{0, 1}, {0, 1, 2}})
+    ->Unit(benchmark::kMillisecond);
+
+// Focussing 10^5 spectra with 1000 bins into the number of groups given by the
+// argument, e.g., a few banks.
+static void BM_Reduce_groupSum(benchmark::State &state) {
+  const gsl::index nSpec = 100000;
+  const gsl::index nBin = 1000;
+  const gsl::index groups = state.range(0);
+  const auto d = makeHistograms(nSpec, nBin);
+  Vector<std::vector<gsl::index>> grouping(groups);
+  for (gsl::index spectrum = 0; spectrum < nSpec; ++spectrum)
+    grouping[spectrum * groups / nSpec].push_back(spectrum);
+  const auto groupingVar = makeVariable<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, groups}, grouping);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(groupSum(d, groupingVar));
+  state.SetItemsProcessed(state.iterations() * nSpec);
+  state.SetBytesProcessed(state.iterations() * nSpec * nBin * 2 *
+                          sizeof(double));
+}
+BENCHMARK(BM_Reduce_groupSum)
+    ->RangeMultiplier(100)
+    ->Range(1, 10000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
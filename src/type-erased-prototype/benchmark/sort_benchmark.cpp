@@ -0,0 +1,129 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+
+#include "sort.h"
+
+// Sorting a table with the number of rows given by the first argument and four
+// columns by a shuffled Coord::Temperature.
+static void BM_Sort_table(benchmark::State &state) {
+  const gsl::index rows = state.range(0);
+  Vector<double> keys(rows);
+  for (gsl::index i = 0; i < rows; ++i)
+    keys[i] = (i * 7919) % rows;
+  Dataset d;
+  d.insert<Coord::Temperature>({Dimension::Row, rows}, keys);
+  d.insert<Data::Value>("a", {Dimension::Row, rows}, rows, 1.0);
+  d.insert<Data::Variance>("a", {Dimension::Row, rows}, rows, 1.0);
+  d.insert<Data::Int>("b", {Dimension::Row, rows}, rows, 1l);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(sort<Coord::Temperature>(d, Dimension::Row));
+  state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_Sort_table)
+    ->RangeMultiplier(100)
+    ->Range(100, 10000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Sorting 10^5 spectra with the number of bins given by the first argument by
+// Coord::SpectrumNumber, i.e., gathering contiguous histograms.
+static void BM_Sort_spectra(benchmark::State &state) {
+  const gsl::index nSpec = 100000;
+  const gsl::index nBin = state.range(0);
+  Vector<int32_t> numbers(nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i)
+    numbers[i] = (i * 7919) % nSpec;
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, nSpec}, numbers);
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  d.insert<Data::Value>("sample", dims, dims.volume(), 1.0);
+  d.insert<Data::Variance>("sample", dims, dims.volume(), 1.0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        sort<Coord::SpectrumNumber>(d, Dimension::Spectrum));
+  state.SetItemsProcessed(state.iterations() * nSpec * nBin);
+}
+BENCHMARK(BM_Sort_spectra)
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Filtering 10^5 spectra with the number of bins given by the first argument,
+// masking every other spectrum.
+static void BM_Filter_spectra(benchmark::State &state) {
+  const gsl::index nSpec = 100000;
+  const gsl::index nBin = state.range(0);
+  Vector<char> mask(nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i)
+    mask[i] = i % 2;
+  Dataset d;
+  d.insert<Coord::Mask>({Dimension::Spectrum, nSpec}, mask);
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  d.insert<Data::Value>("sample", dims, dims.volume(), 1.0);
+  d.insert<Data::Variance>("sample", dims, dims.volume(), 1.0);
+  const auto &maskVar = d[d.find(tag_id<Coord::Mask>, "")];
+  for (auto _ : state)
+    benchmark::DoNotOptimize(filter(d, Dimension::Spectrum, maskVar));
+  state.SetItemsProcessed(state.iterations() * nSpec * nBin);
+}
+BENCHMARK(BM_Filter_spectra)
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Joining a calibration table onto a table of detectors, both with the number
+// of rows given by the first argument and keyed by shuffled detector IDs.
+static void BM_Join_detectors(benchmark::State &state) {
+  const gsl::index rows = state.range(0);
+  Vector<int32_t> ids(rows);
+  for (gsl::index i = 0; i < rows; ++i)
+    ids[i] = (i * 7919) % rows;
+  Dataset data;
+  data.insert<Coord::DetectorId>({Dimension::Row, rows}, ids);
+  data.insert<Data::Value>("counts", {Dimension::Row, rows}, rows, 1.0);
+  data.insert<Data::Variance>("counts", {Dimension::Row, rows}, rows, 1.0);
+  std::reverse(ids.begin(), ids.end());
+  Dataset calibration;
+  calibration.insert<Coord::DetectorId>({Dimension::Row, rows}, ids);
+  calibration.insert<Data::Value>("efficiency", {Dimension::Row, rows}, rows,
+                                  1.0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        join<Coord::DetectorId>(data, calibration, Dimension::Row));
+  state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_Join_detectors)
+    ->RangeMultiplier(100)
+    ->Range(100, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Selecting the spectra with spectrum numbers in the middle half of 10^5
+// spectra with the number of bins given by the first argument. The bounds are
+// found by binary search, the selected spectra are copied as one block.
+static void BM_Select_spectra(benchmark::State &state) {
+  const gsl::index nSpec = 100000;
+  const gsl::index nBin = state.range(0);
+  Vector<int32_t> numbers(nSpec);
+  for (gsl::index i = 0; i < nSpec; ++i)
+    numbers[i] = i;
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, nSpec}, numbers);
+  const Dimensions dims({{Dimension::Tof, nBin}, {Dimension::Spectrum, nSpec}});
+  d.insert<Data::Value>("sample", dims, dims.volume(), 1.0);
+  d.insert<Data::Variance>("sample", dims, dims.volume(), 1.0);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(select<Coord::SpectrumNumber>(
+        d, Dimension::Spectrum, 0.25 * nSpec, 0.75 * nSpec));
+  state.SetItemsProcessed(state.iterations() * nSpec / 2 * nBin);
+}
+BENCHMARK(BM_Select_spectra)
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef COLUMN_SPAN_H
+#define COLUMN_SPAN_H
+
+#include <type_traits>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <gsl/gsl_util>
+
+// A "column" is storage of a Variable that is not a contiguous array of its
+// element type, e.g., StringColumn keeps all characters in a single buffer.
+// Elements of a column are accessed via `const_reference`, a lightweight view
+// returned by value, and `reference`, a proxy supporting assignment. A column
+// must provide
+// - `operator[]`, `size()`, `resize()`, and `assign(index, const_reference)`,
+// - construction from a size and from an iterator range,
+// - `operator==`.
+// The classes in this file provide the parts of gsl::span required by Variable
+// and DatasetView on top of this.
+
+/// Proxy reference to an element of a column. Assignment writes through to the
+/// column.
+template <class Column> class ColumnReference {
+public:
+  using const_reference = typename Column::const_reference;
+
+  ColumnReference(Column &column, const gsl::index index)
+      : m_column(&column), m_index(index) {}
+
+  operator const_reference() const {
+    return static_cast<const Column &>(*m_column)[m_index];
+  }
+  /// Conversion to the owning type, for columns whose elements are read via a
+  /// view, e.g., to std::string for StringColumn.
+  template <class Value = typename Column::value_type,
+            class = std::enable_if_t<
+                std::is_same<Value, typename Column::value_type>::value &&
+                !std::is_same<Value, const_reference>::value>>
+  explicit operator Value() const {
+    const auto value = static_cast<const_reference>(*this);
+    return Value(value.begin(), value.end());
+  }
+
+  ColumnReference &operator=(const const_reference &value) {
+    m_column->assign(m_index, value);
+    return *this;
+  }
+  ColumnReference &operator=(const ColumnReference &other) {
+    return *this = static_cast<const_reference>(other);
+  }
+
+  bool operator==(const const_reference &other) const {
+    return static_cast<const_reference>(*this) == other;
+  }
+  bool operator!=(const const_reference &other) const {
+    return !(*this == other);
+  }
+
+private:
+  Column *m_column;
+  gsl::index m_index;
+};
+
+/// Random-access iterator over a (const) column, dereferencing to
+/// Column::const_reference or Column::reference. The value type is
+/// const_reference, such that standard algorithms and containers accept this as
+/// an input iterator.
+template <class Column>
+class ColumnIterator
+    : public boost::iterator_facade<
+          ColumnIterator<Column>, typename Column::const_reference,
+          boost::random_access_traversal_tag,
+          std::conditional_t<std::is_const<Column>::value,
+                             typename Column::const_reference,
+                             typename Column::reference>> {
+public:
+  ColumnIterator(Column &column, const gsl::index index)
+      : m_column(&column), m_index(index) {}
+
+private:
+  friend class boost::iterator_core_access;
+
+  bool equal(const ColumnIterator &other) const {
+    return m_index == other.m_index;
+  }
+  void increment() { ++m_index; }
+  void decrement() { --m_index; }
+  void advance(int64_t delta) { m_index += delta; }
+  int64_t distance_to(const ColumnIterator &other) const {
+    return other.m_index - m_index;
+  }
+  auto dereference() const { return (*m_column)[m_index]; }
+
+  Column *m_column;
+  gsl::index m_index;
+};
+
+/// Non-owning view of a contiguous range of elements of a column, the
+/// equivalent of gsl::span.
+template <class Column> class ColumnSpan {
+public:
+  using iterator = ColumnIterator<Column>;
+
+  ColumnSpan(Column &column)
+      : ColumnSpan(column, 0, static_cast<gsl::index>(column.size())) {}
+  ColumnSpan(Column &column, const gsl::index offset, const gsl::index size)
+      : m_column(&column), m_offset(offset), m_size(size) {}
+
+  gsl::index size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  auto operator[](const gsl::index i) const {
+    return (*m_column)[m_offset + i];
+  }
+  iterator begin() const { return {*m_column, m_offset}; }
+  iterator end() const { return {*m_column, m_offset + m_size}; }
+
+  ColumnSpan subspan(const gsl::index offset) const {
+    return {*m_column, m_offset + offset, m_size - offset};
+  }
+  ColumnSpan subspan(const gsl::index offset, const gsl::index count) const {
+    return {*m_column, m_offset + offset, count};
+  }
+
+  /// The column this span refers to and the offset of the first element, for
+  /// code that works with the underlying buffers, e.g., for export.
+  Column &column() const { return *m_column; }
+  gsl::index offset() const { return m_offset; }
+
+private:
+  Column *m_column;
+  gsl::index m_offset;
+  gsl::index m_size;
+};
+
+#endif // COLUMN_SPAN_H
@@ -0,0 +1,240 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "convert_units.h"
+#include "geometry.h"
+#include "parallel.h"
+
+namespace {
+// CODATA 2018, in SI units.
+constexpr double neutronMass = 1.67492749804e-27;
+constexpr double planckConstant = 6.62607015e-34;
+constexpr double meV = 1.602176634e-22;
+
+/// Wavelength in Angstrom of a neutron with a time of flight of 1 microsecond
+/// over 1 m.
+constexpr double wavelengthPerTof = 1e4 * planckConstant / neutronMass;
+/// Kinetic energy in meV of a neutron with a velocity of 1 m per microsecond.
+constexpr double energyPerVelocitySquared = 0.5 * neutronMass * 1e12 / meV;
+
+/// Returns the mean of the values of the detectors of each spectrum. Spectra
+/// without detectors get NaN.
+Vector<double> spectrumMean(const IndexListColumn &grouping,
+                            gsl::span<const double> values) {
+  const auto &offsets = grouping.offsets();
+  const auto &detectors = grouping.values();
+  Vector<double> mean(grouping.size());
+  std::atomic<bool> outOfRange{false};
+  parallel::forEachChunk(
+      grouping.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto spectrum = begin; spectrum < end; ++spectrum) {
+          double sum = 0.0;
+          for (auto i = offsets[spectrum]; i < offsets[spectrum + 1]; ++i) {
+            if (detectors[i] < 0 || detectors[i] >= values.size()) {
+              outOfRange = true;
+              return;
+            }
+            sum += values[detectors[i]];
+          }
+          const auto count = offsets[spectrum + 1] - offsets[spectrum];
+          mean[spectrum] = count == 0 ? std::numeric_limits<double>::quiet_NaN()
+                                      : sum / count;
+        }
+      });
+  if (outOfRange)
+    throw std::runtime_error("Detector index in grouping out of range.");
+  return mean;
+}
+
+template <class Tag> bool hasCoord(const Dataset &d) {
+  return std::any_of(d.begin(), d.end(), [](const Variable &var) {
+    return var.type() == tag_id<Tag>;
+  });
+}
+
+/// Returns the value of a coordinate without dimensions, such as Coord::L1.
+template <class Tag> typename Tag::type scalar(const Dataset &d) {
+  const auto values = d.get<const Tag>();
+  if (values.size() != 1 || d.dimensions<Tag>().count() != 0)
+    throw std::runtime_error("Coord::L1, Coord::SourcePosition, and "
+                             "Coord::SamplePosition must not have "
+                             "dimensions.");
+  return values[0];
+}
+
+double l1(const Dataset &d) {
+  if (hasCoord<Coord::L1>(d))
+    return scalar<Coord::L1>(d);
+  const auto source = scalar<Coord::SourcePosition>(d);
+  const auto sample = scalar<Coord::SamplePosition>(d);
+  double l1 = 0.0;
+  for (gsl::index i = 0; i < 3; ++i)
+    l1 += (sample[i] - source[i]) * (sample[i] - source[i]);
+  return std::sqrt(l1);
+}
+
+/// Returns Coord::L2 of each detector, computed from Coord::DetectorPosition if
+/// not present.
+Vector<double> detectorL2(const Dataset &d) {
+  if (hasCoord<Coord::L2>(d)) {
+    const auto l2 = d.get<const Coord::L2>();
+    return Vector<double>(l2.begin(), l2.end());
+  }
+  return geometry::l2(d.get<const Coord::DetectorPosition>().column(),
+                      scalar<Coord::SamplePosition>(d));
+}
+
+/// Returns Coord::TwoTheta of each detector, computed from
+/// Coord::DetectorPosition if not present.
+Vector<double> detectorTwoTheta(const Dataset &d) {
+  if (hasCoord<Coord::TwoTheta>(d)) {
+    const auto twoTheta = d.get<const Coord::TwoTheta>();
+    return Vector<double>(twoTheta.begin(), twoTheta.end());
+  }
+  return geometry::twoTheta(d.get<const Coord::DetectorPosition>().column(),
+                            scalar<Coord::SourcePosition>(d),
+                            scalar<Coord::SamplePosition>(d));
+}
+
+struct Scale {
+  double operator()(const double tof, const double scale) const {
+    return tof * scale;
+  }
+};
+
+struct EnergyTransfer {
+  double operator()(const double tof, const double scale) const {
+    const auto t = tof - sampleTof;
+    return t > 0.0 ? incidentEnergy - scale / (t * t)
+                   : std::numeric_limits<double>::quiet_NaN();
+  }
+  double incidentEnergy;
+  /// Time of flight from source to sample.
+  double sampleTof;
+};
+
+/// Applies `op(tof, constant)` to the time-of-flight axis of each spectrum,
+/// with the constant of that spectrum. If `sharedTof` is true all spectra use
+/// the same axis, which is not expanded for each spectrum. The inner loop is
+/// over the axis with a constant per spectrum, which the compiler vectorizes.
+template <class Op>
+Vector<double> convert(const double *tof, const bool sharedTof,
+                       const gsl::index size, const Vector<double> &constants,
+                       const Op op) {
+  Vector<double> out(size * constants.size());
+  parallel::forEachChunk(
+      constants.size(),
+      [&](const gsl::index begin, const gsl::index end) {
+        for (auto spectrum = begin; spectrum < end; ++spectrum) {
+          const auto in = sharedTof ? tof : tof + spectrum * size;
+          const auto result = out.data() + spectrum * size;
+          const auto constant = constants[spectrum];
+          for (gsl::index i = 0; i < size; ++i)
+            result[i] = op(in[i], constant);
+        }
+      },
+      parallel::grainSize / (size + 1));
+  return out;
+}
+}
+
+Dataset convertUnits(const Dataset &d, const Dimension target,
+                     const double incidentEnergy) {
+  if (target != Dimension::DSpacing && target != Dimension::Wavelength &&
+      target != Dimension::DeltaE)
+    throw std::runtime_error("Unsupported target dimension for unit "
+                             "conversion.");
+  if (target == Dimension::DeltaE && !(incidentEnergy > 0.0))
+    throw std::runtime_error("Conversion to energy transfer requires a "
+                             "positive incident energy.");
+
+  const auto &grouping = d[d.find(tag_id<Coord::DetectorGrouping>, "")];
+  const auto &spectrumDims = grouping.dimensions();
+  const auto &tof = d[d.find(tag_id<Coord::Tof>, "")];
+  const auto &tofDims = tof.dimensions();
+  auto otherDims = tofDims;
+  otherDims.erase(Dimension::Tof);
+  const bool sharedTof = otherDims.count() == 0;
+  if (tofDims.label(0) != Dimension::Tof ||
+      !(sharedTof || otherDims == spectrumDims))
+    throw std::runtime_error("Time-of-flight coordinate must have "
+                             "Dimension::Tof as inner dimension and otherwise "
+                             "depend only on the dimensions of the spectra.");
+
+  const double flightPathL1 = l1(d);
+  const auto &column = grouping.get<const Coord::DetectorGrouping>().column();
+  const auto l2Detector = detectorL2(d);
+  const auto l2 = spectrumMean(column, l2Detector);
+
+  // Per-spectrum constants.
+  Vector<double> constants(l2.size());
+  if (target == Dimension::DeltaE) {
+    parallel::transform(l2.size(), l2.begin(), l2.begin(), constants.begin(),
+                        [](const double l2, double) {
+                          return energyPerVelocitySquared * l2 * l2;
+                        });
+  } else if (target == Dimension::Wavelength) {
+    parallel::transform(l2.size(), l2.begin(), l2.begin(), constants.begin(),
+                        [l1 = flightPathL1](const double l2, double) {
+                          return wavelengthPerTof / (l1 + l2);
+                        });
+  } else {
+    const auto twoThetaDetector = detectorTwoTheta(d);
+    const auto twoTheta = spectrumMean(column, twoThetaDetector);
+    parallel::transform(l2.size(), l2.begin(), twoTheta.begin(),
+                        constants.begin(),
+                        [l1 = flightPathL1](const double l2,
+                                            const double twoTheta) {
+                          return wavelengthPerTof /
+                                 ((l1 + l2) * 2.0 * std::sin(0.5 * twoTheta));
+                        });
+  }
+
+  auto dims = tofDims;
+  if (sharedTof)
+    for (const auto &dim : spectrumDims)
+      dims.add(dim.first, dim.second);
+  dims.relabel(Dimension::Tof, target);
+  const auto size = tofDims.size(Dimension::Tof);
+  const auto values = tof.get<const Coord::Tof>().data();
+  Variable converted = [&]() {
+    if (target == Dimension::DSpacing)
+      return makeVariable<Coord::DSpacing>(
+          dims, convert(values, sharedTof, size, constants, Scale{}));
+    if (target == Dimension::Wavelength)
+      return makeVariable<Coord::Wavelength>(
+          dims, convert(values, sharedTof, size, constants, Scale{}));
+    const auto sampleTof =
+        flightPathL1 * std::sqrt(energyPerVelocitySquared / incidentEnergy);
+    return makeVariable<Coord::DeltaE>(
+        dims, convert(values, sharedTof, size, constants,
+                      EnergyTransfer{incidentEnergy, sampleTof}));
+  }();
+
+  Dataset result;
+  for (const auto &var : d) {
+    if (&var == &tof) {
+      if (size == d.dimensions().size(Dimension::Tof) + 1)
+        result.insertAsEdge(target, std::move(converted));
+      else
+        result.insert(std::move(converted));
+    } else if (var.dimensions().contains(Dimension::Tof)) {
+      auto relabeled = var;
+      auto varDims = var.dimensions();
+      varDims.relabel(Dimension::Tof, target);
+      relabeled.data().setDimensions(varDims);
+      result.insert(std::move(relabeled));
+    } else {
+      result.insert(var);
+    }
+  }
+  return result;
+}
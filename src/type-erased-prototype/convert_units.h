@@ -0,0 +1,31 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef CONVERT_UNITS_H
+#define CONVERT_UNITS_H
+
+#include "dataset.h"
+
+/// Returns `d` with the time-of-flight coordinate Coord::Tof, in microseconds,
+/// converted to `target`, which is one of
+/// - Dimension::DSpacing, giving Coord::DSpacing,
+/// - Dimension::Wavelength, giving Coord::Wavelength,
+/// - Dimension::DeltaE, giving Coord::DeltaE for direct geometry, i.e., with
+///   the given `incidentEnergy` in meV. Times of flight shorter than the
+///   flight time from source to sample are converted to NaN.
+///
+/// The conversion depends on the flight path of each spectrum, given by
+/// Coord::L1 (without dimensions) and the mean over the detectors of the
+/// spectrum, see Coord::DetectorGrouping, of Coord::L2 and Coord::TwoTheta.
+/// Any of these that is not present is computed from Coord::SourcePosition,
+/// Coord::SamplePosition, and Coord::DetectorPosition, see geometry.h. The
+/// converted coordinate thus depends on Dimension::Spectrum even if the
+/// time-of-flight coordinate does not. Dimension::Tof is replaced by `target`
+/// in all variables. Data is not modified, since bins are converted along with
+/// their edges.
+Dataset convertUnits(const Dataset &d, const Dimension target,
+                     const double incidentEnergy = 0.0);
+
+#endif // CONVERT_UNITS_H
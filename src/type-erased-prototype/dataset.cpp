@@ -3,9 +3,84 @@
 /// @author Simon Heybrock
 /// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
 /// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <cmath>
 #include <set>
 
 #include "dataset.h"
+#include "detector_grouping.h"
+#include "integrate.h"
+#include "parallel.h"
+
+// The cache holds a copy of the grouping variable it was built from, which
+// shares the data with the variable in the dataset. Modifying the latter
+// therefore triggers a copy-on-write, i.e., the cache is valid exactly as long
+// as both refer to the same data.
+struct Dataset::InverseGrouping {
+  Variable grouping;
+  gsl::index detectors;
+  IndexListColumn spectra;
+};
+
+// As for InverseGrouping, the cache holds copies of its source variables.
+struct Dataset::DerivedValues {
+  std::vector<Variable> sources;
+  Variable values;
+};
+
+namespace {
+Variable computeSpectrumPosition(const Variable &positions,
+                                 const Variable &grouping) {
+  const auto &position =
+      positions.get<const Coord::DetectorPosition>().column();
+  const auto &column = grouping.get<const Coord::DetectorGrouping>().column();
+  const auto &offsets = column.offsets();
+  const auto &detectors = column.values();
+  const auto &x = position.x();
+  const auto &y = position.y();
+  const auto &z = position.z();
+  PositionColumn values(column.size());
+  auto meanX = values.x();
+  auto meanY = values.y();
+  auto meanZ = values.z();
+  // Spectra without detectors are set to 0, DatasetView checks the grouping
+  // before reading the value.
+  parallel::forEachChunk(
+      column.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto spectrum = begin; spectrum < end; ++spectrum) {
+          double sumX = 0.0;
+          double sumY = 0.0;
+          double sumZ = 0.0;
+          for (auto i = offsets[spectrum]; i < offsets[spectrum + 1]; ++i) {
+            sumX += x[detectors[i]];
+            sumY += y[detectors[i]];
+            sumZ += z[detectors[i]];
+          }
+          const auto count = offsets[spectrum + 1] - offsets[spectrum];
+          const double scale = count == 0 ? 0.0 : 1.0 / count;
+          meanX[spectrum] = sumX * scale;
+          meanY[spectrum] = sumY * scale;
+          meanZ[spectrum] = sumZ * scale;
+        }
+      });
+  return Variable(tag_id<Coord::SpectrumPosition>, positions.unit().id(),
+                  grouping.dimensions(), std::move(values));
+}
+
+Variable computeStdDev(const Variable &variances) {
+  const auto variance = variances.get<const Data::Variance>();
+  Vector<double> values(variance.size());
+  parallel::forEachChunk(
+      variance.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto i = begin; i < end; ++i)
+          values[i] = std::sqrt(variance[i]);
+      });
+  Variable result(tag_id<Data::StdDev>, variances.unit().id(),
+                  variances.dimensions(), std::move(values));
+  result.setName(variances.name());
+  return result;
+}
+}
 
 void Dataset::insert(Variable variable) {
   if (variable.isCoord() && count(variable.type()))
@@ -55,6 +130,121 @@ gsl::index Dataset::find(const uint16_t id, const std::string &name) const {
   throw std::runtime_error("Dataset does not contain such a variable.");
 }
 
+const IndexListColumn &Dataset::detectorSpectra() const {
+  const auto &grouping =
+      m_variables[findUnique(tag_id<Coord::DetectorGrouping>)];
+  const auto &column = grouping.get<const Coord::DetectorGrouping>().column();
+  gsl::index detectors = 0;
+  if (m_dimensions.contains(Dimension::Detector))
+    detectors = m_dimensions.size(Dimension::Detector);
+  else if (!column.values().empty())
+    detectors = *std::max_element(column.values().begin(),
+                                  column.values().end()) +
+                1;
+
+  auto cache = std::atomic_load(&m_inverseGrouping);
+  if (cache && &cache->grouping.data() == &grouping.data() &&
+      cache->detectors == detectors)
+    return cache->spectra;
+  std::shared_ptr<const InverseGrouping> update(new InverseGrouping{
+      grouping, detectors, invertGrouping(column, detectors)});
+  // If another thread has built the index concurrently we use that one, such
+  // that references returned to other callers stay valid.
+  if (std::atomic_compare_exchange_strong(&m_inverseGrouping, &cache, update))
+    return update->spectra;
+  return cache->spectra;
+}
+
+void Dataset::enableCache(const uint16_t id, std::string name) {
+  if (id == tag_id<Data::StdDev> && name.empty())
+    name = m_variables[findUnique(tag_id<Data::Variance>)].name();
+  if (id == tag_id<Data::CumulativeValue>)
+    throw std::runtime_error("Cumulative sums require a dimension, see "
+                             "enableCumulativeSum.");
+  // Check that the sources exist and that the tag is supported.
+  cacheSources(id, name);
+  for (const auto &cache : m_caches)
+    if (cache.id == id && cache.name == name)
+      return;
+  m_caches.push_back({id, name, nullptr});
+}
+
+const Variable *Dataset::cached(const uint16_t id, std::string name) const {
+  if (id == tag_id<Data::StdDev> && name.empty())
+    name = m_variables[findUnique(tag_id<Data::Variance>)].name();
+  const auto cache =
+      std::find_if(m_caches.begin(), m_caches.end(), [&](const Cache &item) {
+        return item.id == id && item.name == name;
+      });
+  return cache == m_caches.end() ? nullptr : cached(*cache);
+}
+
+void Dataset::enableCumulativeSum(const Dimension dim,
+                                  const std::string &name) {
+  const auto &values = m_variables[find(tag_id<Data::Value>, name)];
+  if (!values.dimensions().contains(dim))
+    throw std::runtime_error("Variable does not depend on the dimension of "
+                             "the cumulative sum.");
+  if (values.dimensions().isRagged())
+    throw std::runtime_error("Cannot compute cumulative sum of ragged "
+                             "variables.");
+  for (const auto &cache : m_caches)
+    if (cache.id == tag_id<Data::CumulativeValue> && cache.name == name &&
+        cache.dim == dim)
+      return;
+  m_caches.push_back({tag_id<Data::CumulativeValue>, name, nullptr, dim});
+}
+
+const Variable *Dataset::cumulativeSum(const Dimension dim,
+                                       const std::string &name) const {
+  const auto cache =
+      std::find_if(m_caches.begin(), m_caches.end(), [&](const Cache &item) {
+        return item.id == tag_id<Data::CumulativeValue> && item.name == name &&
+               item.dim == dim;
+      });
+  return cache == m_caches.end() ? nullptr : cached(*cache);
+}
+
+const Variable *Dataset::cached(const Cache &cache) const {
+  const auto sources = cacheSources(cache.id, cache.name);
+  auto values = std::atomic_load(&cache.values);
+  if (values && std::equal(sources.begin(), sources.end(),
+                           values->sources.begin(),
+                           [](const Variable *a, const Variable &b) {
+                             return &a->data() == &b.data();
+                           }))
+    return &values->values;
+
+  std::vector<Variable> copies;
+  for (const auto source : sources)
+    copies.push_back(*source);
+  auto computed = [&]() {
+    if (cache.id == tag_id<Data::StdDev>)
+      return computeStdDev(*sources[0]);
+    if (cache.id == tag_id<Data::CumulativeValue>)
+      return ::cumulativeSum(*sources[0], cache.dim);
+    return computeSpectrumPosition(*sources[0], *sources[1]);
+  }();
+  std::shared_ptr<const DerivedValues> update(
+      new DerivedValues{std::move(copies), std::move(computed)});
+  // See detectorSpectra().
+  if (std::atomic_compare_exchange_strong(&cache.values, &values, update))
+    return &update->values;
+  return &values->values;
+}
+
+std::vector<const Variable *>
+Dataset::cacheSources(const uint16_t id, const std::string &name) const {
+  if (id == tag_id<Coord::SpectrumPosition>)
+    return {&m_variables[findUnique(tag_id<Coord::DetectorPosition>)],
+            &m_variables[findUnique(tag_id<Coord::DetectorGrouping>)]};
+  if (id == tag_id<Data::StdDev>)
+    return {&m_variables[find(tag_id<Data::Variance>, name)]};
+  if (id == tag_id<Data::CumulativeValue>)
+    return {&m_variables[find(tag_id<Data::Value>, name)]};
+  throw std::runtime_error("Only derived variables can be cached.");
+}
+
 gsl::index Dataset::count(const uint16_t id) const {
   gsl::index n = 0;
   for (auto &item : m_variables)
@@ -91,20 +281,21 @@ void Dataset::mergeDimensions(const auto &dims) {
   gsl::index found = 0;
   for (gsl::index i = 0; i < dims.count(); ++i) {
     const auto dim = dims.label(i);
-    const auto size = dims.size(i);
+    const bool ragged = dims.isRagged(i);
     bool found = false;
     for (; j < m_dimensions.count(); ++j) {
       if (m_dimensions.label(j) == dim) {
-        if (m_dimensions.size(j) != size) // TODO compare ragged
+        if (ragged != m_dimensions.isRagged(j) ||
+            (ragged ? m_dimensions.raggedSize(j) != dims.raggedSize(i)
+                    : m_dimensions.size(j) != dims.size(i)))
           throw std::runtime_error(
               "Cannot insert variable into Dataset: Dimensions do not match");
         found = true;
         break;
       }
     }
-    if (!found) {
-      m_dimensions.add(dim, size);
-    }
+    if (!found)
+      m_dimensions.add(dim, dims);
   }
 }
 
@@ -256,8 +447,12 @@ Dataset &Dataset::operator*=(const Dataset &other) {
             auto v2 = var2.get<const Data::Value>();
             auto e1 = error1.get<Data::Value>();
             auto e2 = error2.get<const Data::Value>();
-            aligned::multiply(v1.size(), v1.data(), e1.data(), v2.data(),
-                              e2.data());
+            parallel::forEachChunk(v1.size(), [&](const gsl::index begin,
+                                                  const gsl::index end) {
+              aligned::multiply(end - begin, v1.data() + begin,
+                                e1.data() + begin, v2.data() + begin,
+                                e2.data() + begin);
+            });
           } else {
             error1 = error1 * (var2 * var2) + var1 * var1 * error2;
             // TODO: Catch errors from unit propagation here and give a better
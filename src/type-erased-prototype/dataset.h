@@ -6,6 +6,7 @@
 #ifndef DATASET_H
 #define DATASET_H
 
+#include <memory>
 #include <vector>
 
 #include <gsl/gsl_util>
@@ -117,6 +118,46 @@ public:
 
   gsl::index find(const uint16_t id, const std::string &name) const;
 
+  /// Enables caching for the derived variable `Tag`, i.e., for
+  /// Coord::SpectrumPosition or Data::StdDev. Its values are then computed once
+  /// into a hidden variable, which DatasetView reads instead of computing every
+  /// element on access. The hidden variable is recomputed on the next access
+  /// after any of its source variables has been modified. Copies of the
+  /// dataset share the cache.
+  template <class Tag> void enableCache() { enableCache(tag_id<Tag>, ""); }
+  template <class Tag> void enableCache(const std::string &name) {
+    static_assert(!is_coord<Tag>, "Coordinate variable cannot have a name.");
+    enableCache(tag_id<Tag>, name);
+  }
+
+  /// Returns the hidden variable with the cached values of the derived
+  /// variable `Tag`, computing it if it is out of date, or nullptr if caching
+  /// is not enabled for `Tag`.
+  template <class Tag> const Variable *cached() const {
+    return cached(tag_id<Tag>, "");
+  }
+  template <class Tag> const Variable *cached(const std::string &name) const {
+    static_assert(!is_coord<Tag>, "Coordinate variable cannot have a name.");
+    return cached(tag_id<Tag>, name);
+  }
+
+  /// Enables caching of the cumulative sum of Data::Value `name` along `dim`,
+  /// a hidden Data::CumulativeValue variable, see cumulativeSum in
+  /// integrate.h. As for enableCache, it is recomputed on the next access after
+  /// the values have been modified. Caches along several dimensions can be
+  /// enabled at the same time.
+  void enableCumulativeSum(const Dimension dim, const std::string &name = "");
+  /// Returns the cached cumulative sum of Data::Value `name` along `dim`,
+  /// computing it if it is out of date, or nullptr if caching is not enabled.
+  const Variable *cumulativeSum(const Dimension dim,
+                                const std::string &name = "") const;
+
+  /// Returns the inverse of Coord::DetectorGrouping, i.e., the spectra each
+  /// detector is part of, see invertGrouping. The index is built on the first
+  /// call and cached. Any modification of the grouping invalidates the cache,
+  /// as does a change of the number of detectors.
+  const IndexListColumn &detectorSpectra() const;
+
   Dataset &operator+=(const Dataset &other);
   Dataset &operator-=(const Dataset &other);
   Dataset &operator*=(const Dataset &other);
@@ -124,13 +165,30 @@ public:
                 const gsl::index index);
 
 private:
+  void enableCache(const uint16_t id, std::string name);
+  const Variable *cached(const uint16_t id, std::string name) const;
+  std::vector<const Variable *> cacheSources(const uint16_t id,
+                                             const std::string &name) const;
   gsl::index count(const uint16_t id) const;
   gsl::index count(const uint16_t id, const std::string &name) const;
   gsl::index findUnique(const uint16_t id) const;
   void mergeDimensions(const auto &dims);
 
+  struct InverseGrouping;
+  struct DerivedValues;
+  struct Cache {
+    uint16_t id;
+    std::string name;
+    mutable std::shared_ptr<const DerivedValues> values;
+    // Only for Data::CumulativeValue.
+    Dimension dim{};
+  };
+  const Variable *cached(const Cache &cache) const;
+
   Dimensions m_dimensions;
   boost::container::small_vector<Variable, 4> m_variables;
+  mutable std::shared_ptr<const InverseGrouping> m_inverseGrouping;
+  std::vector<Cache> m_caches;
 };
 
 Dataset operator+(Dataset a, const Dataset &b);
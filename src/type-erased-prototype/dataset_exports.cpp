@@ -0,0 +1,407 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <pybind11/numpy.h>
+#include <pybind11/operators.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "dataset.h"
+#include "integrate.h"
+#include "mask.h"
+#include "reduce.h"
+#include "sort.h"
+
+namespace py = pybind11;
+
+// Bulk operations do not touch Python objects, so we release the GIL for their
+// whole duration. Python threads can thus run operations concurrently, each of
+// which may additionally use the library's OpenMP threads. As for NumPy, it is
+// the caller's responsibility not to modify an object that is being used by
+// another thread.
+using release_gil = py::call_guard<py::gil_scoped_release>;
+
+namespace {
+// Only arithmetic element types can be exposed via the buffer protocol. All
+// other types (strings, pairs, vectors) are converted to Python lists, i.e.,
+// they are *copied*. Strings are stored in columns (see StringColumn), so they
+// are not contiguous in the NumPy sense either.
+template <class T>
+using is_buffer_type = std::integral_constant<
+    bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+// Element type on the Python side. Masks are bit-packed (see MaskColumn) and
+// are converted from and to lists of bool.
+template <class Tag> struct python_type { using type = typename Tag::type; };
+template <> struct python_type<Coord::Mask> { using type = bool; };
+template <class Tag> using python_type_t = typename python_type<Tag>::type;
+
+// Axis i of the exported array corresponds to Dimensions::label(i), i.e., the
+// first dimension is the fastest one. This matches the memory layout of
+// Variable with Fortran-order strides, so no transpose or copy is required.
+template <class T>
+std::pair<std::vector<gsl::index>, std::vector<gsl::index>>
+shapeAndStrides(const Dimensions &dims, const gsl::index size) {
+  std::vector<gsl::index> shape;
+  std::vector<gsl::index> strides;
+  // Ragged data has no regular shape, export it as flat array.
+  if (dims.isRagged()) {
+    shape.push_back(size);
+    strides.push_back(sizeof(T));
+    return {shape, strides};
+  }
+  gsl::index stride = sizeof(T);
+  for (gsl::index i = 0; i < dims.count(); ++i) {
+    shape.push_back(dims.size(i));
+    strides.push_back(stride);
+    stride *= dims.size(i);
+  }
+  return {shape, strides};
+}
+
+template <class Value, class T>
+py::object makeArray(const Dimensions &dims, gsl::span<T> data,
+                     py::handle base, std::true_type) {
+  const auto layout = shapeAndStrides<Value>(dims, data.size());
+  py::array_t<Value> array(layout.first, layout.second,
+                           const_cast<Value *>(data.data()), base);
+  if (std::is_const<T>::value)
+    array.attr("setflags")(py::arg("write") = false);
+  return std::move(array);
+}
+
+// Direct initialization, e.g., of std::string from boost::string_view.
+template <class Value, class Item> Value makeValue(const Item &item) {
+  return Value(item);
+}
+
+// Elements of list columns such as Coord::DetectorGrouping.
+template <class Value, class T> Value makeValue(const gsl::span<T> &item) {
+  return Value(item.begin(), item.end());
+}
+
+template <class Value, class Span>
+py::object makeArray(const Dimensions &, const Span &data, py::handle,
+                     std::false_type) {
+  std::vector<Value> values;
+  values.reserve(data.size());
+  for (const auto &item : data)
+    values.push_back(makeValue<Value>(item));
+  return py::cast(values);
+}
+
+/// Returns a read-only array referencing the data of `var`. The array holds a
+/// copy of the Variable, i.e., it keeps the underlying cow_ptr alive and any
+/// subsequent modification of the original Variable (from C++ or Python) will
+/// trigger a copy instead of modifying the data seen by the array.
+py::object readonlyArray(const Variable &var) {
+  py::object result;
+  callForTag(var.type(), [&](auto tag) {
+    using Tag = decltype(tag);
+    auto owner = new Variable(var);
+    py::capsule base(owner,
+                     [](void *ptr) { delete static_cast<Variable *>(ptr); });
+    const auto data = static_cast<const Variable *>(owner)->get<const Tag>();
+    result = makeArray<python_type_t<Tag>>(
+        owner->dimensions(), data, base, is_buffer_type<python_type_t<Tag>>{});
+  });
+  return result;
+}
+
+/// Returns a writable array referencing the data of a variable in the Dataset
+/// `self`. Obtaining the array breaks sharing of the underlying data (like the
+/// non-const `Dataset::get`), so writes from NumPy never affect other Datasets
+/// or previously exported read-only arrays. As for spans obtained from
+/// `Dataset::get`, the array is invalidated by any later copy-on-write of the
+/// variable, e.g., after copying the Dataset. The array keeps `self` alive.
+py::object writableArray(py::object self, const uint16_t id,
+                         const std::string &name) {
+  auto &dataset = self.cast<Dataset &>();
+  const auto index = dataset.find(id, name);
+  py::object result;
+  callForTag(id, [&](auto tag) {
+    using Tag = decltype(tag);
+    const auto data =
+        is_coord<Tag> ? dataset.get<Tag>() : dataset.get<Tag>(name);
+    result = makeArray<python_type_t<Tag>>(
+        dataset[index].dimensions(), data, self,
+        is_buffer_type<python_type_t<Tag>>{});
+  });
+  return result;
+}
+
+template <class Tag>
+storage_t<Tag> toStorage(const py::object &values, std::true_type) {
+  // Force Fortran order to match memory layout of Variable, see
+  // shapeAndStrides. This is the only place where we copy.
+  using Array = py::array_t<typename Tag::type,
+                            py::array::f_style | py::array::forcecast>;
+  const auto array = Array::ensure(values);
+  if (!array)
+    throw std::runtime_error(
+        "Cannot convert values to array of required type.");
+  return Vector<typename Tag::type>(array.data(), array.data() + array.size());
+}
+
+template <class Tag>
+storage_t<Tag> toStorage(const py::object &values, std::false_type) {
+  const auto list = values.cast<std::vector<python_type_t<Tag>>>();
+  return storage_t<Tag>(list.begin(), list.end());
+}
+
+Variable makeVariableFromPython(const uint16_t id, const std::string &name,
+                                const Dimensions &dims,
+                                const py::object &values) {
+  std::unique_ptr<Variable> var;
+  callForTag(id, [&](auto tag) {
+    using Tag = decltype(tag);
+    var = std::make_unique<Variable>(makeVariable<Tag>(
+        dims, toStorage<Tag>(values, is_buffer_type<python_type_t<Tag>>{})));
+  });
+  if (!var->isCoord())
+    var->setName(name);
+  return *var;
+}
+}
+
+PYBIND11_MODULE(dataset_exports, m) {
+  m.doc() = "Python exports of the type-erased Dataset prototype. Data of "
+            "variables is exposed to NumPy without copying.";
+
+  py::enum_<Dimension>(m, "Dimension")
+      .value("Tof", Dimension::Tof)
+      .value("MonitorTof", Dimension::MonitorTof)
+      .value("Spectrum", Dimension::Spectrum)
+      .value("Monitor", Dimension::Monitor)
+      .value("Run", Dimension::Run)
+      .value("Detector", Dimension::Detector)
+      .value("Q", Dimension::Q)
+      .value("X", Dimension::X)
+      .value("Y", Dimension::Y)
+      .value("Z", Dimension::Z)
+      .value("Polarization", Dimension::Polarization)
+      .value("Temperature", Dimension::Temperature)
+      .value("DetectorScan", Dimension::DetectorScan)
+      .value("Row", Dimension::Row)
+      .value("Event", Dimension::Event)
+      .value("Time", Dimension::Time)
+      .value("DSpacing", Dimension::DSpacing)
+      .value("Wavelength", Dimension::Wavelength)
+      .value("DeltaE", Dimension::DeltaE);
+
+  // Tags are types in C++, in Python they are represented by their id.
+  auto coord = m.def_submodule("Coord");
+  coord.attr("X") = tag_id<Coord::X>;
+  coord.attr("Y") = tag_id<Coord::Y>;
+  coord.attr("Z") = tag_id<Coord::Z>;
+  coord.attr("Tof") = tag_id<Coord::Tof>;
+  coord.attr("MonitorTof") = tag_id<Coord::MonitorTof>;
+  coord.attr("DetectorId") = tag_id<Coord::DetectorId>;
+  coord.attr("SpectrumNumber") = tag_id<Coord::SpectrumNumber>;
+  coord.attr("DetectorPosition") = tag_id<Coord::DetectorPosition>;
+  coord.attr("DetectorGrouping") = tag_id<Coord::DetectorGrouping>;
+  coord.attr("RowLabel") = tag_id<Coord::RowLabel>;
+  coord.attr("Polarization") = tag_id<Coord::Polarization>;
+  coord.attr("Temperature") = tag_id<Coord::Temperature>;
+  coord.attr("TimeInterval") = tag_id<Coord::TimeInterval>;
+  coord.attr("Mask") = tag_id<Coord::Mask>;
+  coord.attr("Time") = tag_id<Coord::Time>;
+  coord.attr("L1") = tag_id<Coord::L1>;
+  coord.attr("L2") = tag_id<Coord::L2>;
+  coord.attr("TwoTheta") = tag_id<Coord::TwoTheta>;
+  coord.attr("DSpacing") = tag_id<Coord::DSpacing>;
+  coord.attr("Wavelength") = tag_id<Coord::Wavelength>;
+  coord.attr("DeltaE") = tag_id<Coord::DeltaE>;
+  coord.attr("SourcePosition") = tag_id<Coord::SourcePosition>;
+  coord.attr("SamplePosition") = tag_id<Coord::SamplePosition>;
+  auto data = m.def_submodule("Data");
+  data.attr("Tof") = tag_id<Data::Tof>;
+  data.attr("Value") = tag_id<Data::Value>;
+  data.attr("Variance") = tag_id<Data::Variance>;
+  data.attr("Int") = tag_id<Data::Int>;
+  data.attr("DimensionSize") = tag_id<Data::DimensionSize>;
+  data.attr("String") = tag_id<Data::String>;
+  data.attr("PulseTime") = tag_id<Data::PulseTime>;
+  data.attr("Weight") = tag_id<Data::Weight>;
+  data.attr("WeightVariance") = tag_id<Data::WeightVariance>;
+
+  py::class_<Dimensions>(m, "Dimensions")
+      .def(py::init<>())
+      .def(py::init<const Dimension, const gsl::index>())
+      .def(py::init<const std::vector<std::pair<Dimension, gsl::index>> &>())
+      .def("__len__", &Dimensions::count)
+      .def(py::self == py::self)
+      .def_property_readonly("volume", &Dimensions::volume)
+      .def_property_readonly("labels",
+                             [](const Dimensions &self) {
+                               std::vector<Dimension> labels;
+                               for (const auto &item : self)
+                                 labels.push_back(item.first);
+                               return labels;
+                             })
+      .def_property_readonly("shape",
+                             [](const Dimensions &self) {
+                               std::vector<gsl::index> shape;
+                               for (gsl::index i = 0; i < self.count(); ++i)
+                                 shape.push_back(self.size(i));
+                               return shape;
+                             })
+      .def("contains", py::overload_cast<const Dimension>(
+                           &Dimensions::contains, py::const_))
+      .def("size", py::overload_cast<const Dimension>(&Dimensions::size,
+                                                       py::const_));
+
+  py::class_<Variable>(m, "Variable")
+      .def(py::init(&makeVariableFromPython), py::arg("tag"), py::arg("name"),
+           py::arg("dimensions"), py::arg("values"))
+      .def(py::init([](const uint16_t id, const Dimensions &dims,
+                       const py::object &values) {
+             return makeVariableFromPython(id, "", dims, values);
+           }),
+           py::arg("tag"), py::arg("dimensions"), py::arg("values"))
+      .def(py::init<const Variable &>())
+      .def_property("name", &Variable::name, &Variable::setName)
+      .def_property_readonly("tag", &Variable::type)
+      .def_property_readonly("is_coord", &Variable::isCoord)
+      .def_property_readonly("dimensions", &Variable::dimensions)
+      .def_property_readonly("numpy", &readonlyArray)
+      .def("__len__", &Variable::size)
+      .def(py::self == py::self)
+      .def(py::self != py::self)
+      .def(py::self += py::self, release_gil())
+      .def(py::self -= py::self, release_gil())
+      .def(py::self *= py::self, release_gil())
+      .def(py::self + py::self, release_gil())
+      .def(py::self - py::self, release_gil())
+      .def(py::self * py::self, release_gil());
+
+  py::class_<Dataset>(m, "Dataset")
+      .def(py::init<>())
+      .def(py::init<const Dataset &>())
+      .def("__copy__", [](const Dataset &self) { return Dataset(self); })
+      .def("__len__", &Dataset::size)
+      .def("__getitem__",
+           [](const Dataset &self, const gsl::index i) {
+             if (i < 0 || i >= self.size())
+               throw py::index_error();
+             return self[i];
+           })
+      .def("__iter__",
+           [](const Dataset &self) {
+             return py::make_iterator(self.begin(), self.end());
+           },
+           py::keep_alive<0, 1>())
+      .def("insert",
+           [](Dataset &self, const Variable &var) { self.insert(var); })
+      .def_property_readonly(
+          "dimensions",
+          [](const Dataset &self) -> const Dimensions & {
+            return self.dimensions();
+          })
+      .def("get", &writableArray, py::arg("tag"), py::arg("name") = "")
+      .def("get_const",
+           [](const Dataset &self, const uint16_t id, const std::string &name) {
+             return readonlyArray(self[self.find(id, name)]);
+           },
+           py::arg("tag"), py::arg("name") = "")
+      .def(py::self += py::self, release_gil())
+      .def(py::self -= py::self, release_gil())
+      .def(py::self *= py::self, release_gil())
+      .def(py::self + py::self, release_gil())
+      .def(py::self - py::self, release_gil())
+      .def(py::self * py::self, release_gil());
+
+  m.def("slice",
+        py::overload_cast<const Dataset &, const Dimension, const gsl::index>(
+            &slice),
+        release_gil());
+  m.def("slice",
+        py::overload_cast<const Variable &, const Dimension, const gsl::index>(
+            &slice),
+        release_gil());
+  m.def("concatenate",
+        py::overload_cast<const Dimension, const Dataset &, const Dataset &>(
+            &concatenate),
+        release_gil());
+  m.def("concatenate",
+        py::overload_cast<const Dimension, const Variable &, const Variable &>(
+            &concatenate),
+        release_gil());
+  py::enum_<ReductionMode>(m, "ReductionMode")
+      .value("Fast", ReductionMode::Fast)
+      .value("Reproducible", ReductionMode::Reproducible)
+      .value("Compensated", ReductionMode::Compensated);
+  m.def("sum",
+        py::overload_cast<const Dataset &, const Dimension,
+                          const ReductionMode>(&sum),
+        py::arg("dataset"), py::arg("dim"),
+        py::arg("mode") = ReductionMode::Fast, release_gil());
+  m.def("sum",
+        py::overload_cast<const Dataset &, const Dimension, const Variable &>(
+            &sum),
+        py::arg("dataset"), py::arg("dim"), py::arg("mask"), release_gil());
+  m.def("mean",
+        py::overload_cast<const Dataset &, const Dimension,
+                          const ReductionMode>(&mean),
+        py::arg("dataset"), py::arg("dim"),
+        py::arg("mode") = ReductionMode::Fast, release_gil());
+  m.def("mean",
+        py::overload_cast<const Dataset &, const Dimension, const Variable &>(
+            &mean),
+        py::arg("dataset"), py::arg("dim"), py::arg("mask"), release_gil());
+  m.def("min", py::overload_cast<const Dataset &, const Dimension>(&min),
+        release_gil());
+  m.def("min",
+        py::overload_cast<const Dataset &, const Dimension, const Variable &>(
+            &min),
+        py::arg("dataset"), py::arg("dim"), py::arg("mask"), release_gil());
+  m.def("max", py::overload_cast<const Dataset &, const Dimension>(&max),
+        release_gil());
+  m.def("max",
+        py::overload_cast<const Dataset &, const Dimension, const Variable &>(
+            &max),
+        py::arg("dataset"), py::arg("dim"), py::arg("mask"), release_gil());
+  m.def("group_sum", &groupSum, py::arg("dataset"), py::arg("grouping"),
+        release_gil());
+  m.def("integrate", &integrate, py::arg("dataset"), py::arg("begin"),
+        py::arg("end"), release_gil());
+  m.def("sort",
+        py::overload_cast<const Dataset &, const Dimension, const uint16_t>(
+            &sort),
+        py::arg("dataset"), py::arg("dim"), py::arg("key"), release_gil());
+  m.def("filter", &filter, py::arg("dataset"), py::arg("dim"),
+        py::arg("mask"), release_gil());
+  py::enum_<JoinMode>(m, "JoinMode")
+      .value("Inner", JoinMode::Inner)
+      .value("Left", JoinMode::Left)
+      .value("Outer", JoinMode::Outer);
+  m.def("join",
+        py::overload_cast<const Dataset &, const Dataset &, const Dimension,
+                          const uint16_t, const JoinMode>(&join),
+        py::arg("left"), py::arg("right"), py::arg("dim"), py::arg("key"),
+        py::arg("mode") = JoinMode::Inner, release_gil());
+  m.def("select_range",
+        py::overload_cast<const Dataset &, const Dimension, const uint16_t,
+                          const double, const double>(&selectRange),
+        py::arg("dataset"), py::arg("dim"), py::arg("key"), py::arg("lo"),
+        py::arg("hi"));
+  m.def("select",
+        py::overload_cast<const Dataset &, const Dimension, const uint16_t,
+                          const double, const double>(&select),
+        py::arg("dataset"), py::arg("dim"), py::arg("key"), py::arg("lo"),
+        py::arg("hi"), release_gil());
+  m.def("nearest",
+        py::overload_cast<const Dataset &, const Dimension, const uint16_t,
+                          const double>(&nearest),
+        py::arg("dataset"), py::arg("dim"), py::arg("key"), py::arg("value"));
+  m.def("apply_mask", &applyMask, py::arg("var"), py::arg("mask"),
+        release_gil());
+  m.def("masked_plus_equals", &maskedPlusEquals, py::arg("a"), py::arg("b"),
+        py::arg("mask"), py::return_value_policy::reference, release_gil());
+  m.def("masked_minus_equals", &maskedMinusEquals, py::arg("a"), py::arg("b"),
+        py::arg("mask"), py::return_value_policy::reference, release_gil());
+  m.def("masked_times_equals", &maskedTimesEquals, py::arg("a"), py::arg("b"),
+        py::arg("mask"), py::return_value_policy::reference, release_gil());
+}
@@ -6,28 +6,267 @@
 #ifndef DATASET_INDEX_H
 #define DATASET_INDEX_H
 
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/utility/string_view.hpp>
 
 #include "dataset.h"
+#include "parallel.h"
 
+/// Maps the labels of the coordinate `Tag` of a dataset to their index.
+///
+/// Dense integer labels, e.g., Coord::SpectrumNumber, whose range is at most
+/// four times their number, are looked up in an array indexed by the offset
+/// from the smallest label. Other labels are stored in a flat hash table with
+/// open addressing and linear probing, i.e., a lookup reads consecutive slots
+/// holding label and index, without allocations per label. Large axes are
+/// split into partitions by the high bits of the hash, such that each thread
+/// builds the table of one partition. Lookups are thread-safe, and lookups of
+/// many labels run in parallel.
 template <class Tag> class DatasetIndex {
 public:
+  using key_type = typename Tag::type;
+
   DatasetIndex(const Dataset &dataset) {
     const auto &axis = dataset.get<const Tag>();
-    gsl::index current = 0;
-    for (auto item : axis)
-      m_index[item] = current++;
-    if (axis.size() != m_index.size())
-      throw std::runtime_error("Axis contains duplicate labels. Cannot use it "
-                               "to index into the data.");
+    if (!buildOffsets(axis, std::is_integral<key_type>{}))
+      buildTables(axis);
+  }
+
+  /// Returns the index of `key`, throws if the axis does not contain `key`.
+  gsl::index operator[](const key_type &key) const {
+    const auto index = lookup(key);
+    if (index < 0)
+      throw std::runtime_error("Axis does not contain the label.");
+    return index;
   }
 
-  gsl::index operator[](const typename Tag::type &key) const {
-    return m_index.at(key);
+  /// Returns the index of `key`, or -1 if the axis does not contain `key`.
+  gsl::index find(const key_type &key) const { return lookup(key); }
+
+  /// Returns the indices of `keys`, e.g., the coordinate `Tag` of another
+  /// dataset, and `missing` for keys the axis does not contain.
+  template <class Keys>
+  Vector<gsl::index> indices(const Keys &keys,
+                             const gsl::index missing) const {
+    const gsl::index size = keys.size();
+    Vector<gsl::index> result(size);
+    parallel::forEachChunk(size, [&](const gsl::index begin,
+                                     const gsl::index end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto index = lookup(keys[i]);
+        result[i] = index < 0 ? missing : index;
+      }
+    });
+    return result;
+  }
+
+  /// Returns the indices of `keys`, throws if the axis does not contain one of
+  /// them.
+  template <class Keys> Vector<gsl::index> indices(const Keys &keys) const {
+    auto result = indices(keys, -1);
+    if (std::find(result.begin(), result.end(), -1) != result.end())
+      throw std::runtime_error("Axis does not contain the label.");
+    return result;
   }
 
 private:
-  std::unordered_map<typename Tag::type, gsl::index> m_index;
+  struct Slot {
+    key_type key;
+    gsl::index index;
+  };
+  struct Table {
+    std::vector<Slot> slots;
+    uint64_t mask;
+  };
+
+  /// Mixes the bits of `h` such that the low and high bits of the result
+  /// depend on all bits of `h`, as the finalizer of MurmurHash3. std::hash of
+  /// integers is the identity.
+  static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+  template <class T> static uint64_t hash(const T &key) {
+    return mix(std::hash<T>()(key));
+  }
+  /// Strings are hashed from views (FNV-1a), such that labels read from a
+  /// StringColumn are looked up without copying them.
+  static uint64_t hash(const boost::string_view key) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const auto c : key)
+      h = (h ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+    return mix(h);
+  }
+  static uint64_t hash(const std::string &key) {
+    return hash(boost::string_view(key));
+  }
+  template <class T> static bool equal(const key_type &a, const T &b) {
+    return a == b;
+  }
+  static bool equal(const std::string &a, const boost::string_view b) {
+    return boost::string_view(a) == b;
+  }
+
+  gsl::index partition(const uint64_t h) const {
+    return m_partitionBits == 0 ? 0 : h >> (64 - m_partitionBits);
+  }
+
+  template <class K> gsl::index lookup(const K &key) const {
+    if (!m_offsets.empty())
+      return lookupOffset(key, std::is_integral<key_type>{});
+    const auto h = hash(key);
+    const auto &table = m_tables[partition(h)];
+    for (auto pos = h & table.mask;; pos = (pos + 1) & table.mask) {
+      const auto &slot = table.slots[pos];
+      if (slot.index < 0)
+        return -1;
+      if (equal(slot.key, key))
+        return slot.index;
+    }
+  }
+
+  gsl::index lookupOffset(const key_type key, std::true_type) const {
+    const auto offset =
+        static_cast<uint64_t>(key) - static_cast<uint64_t>(m_min);
+    return offset < m_offsets.size() ? m_offsets[offset] - 1 : -1;
+  }
+  template <class K>
+  gsl::index lookupOffset(const K &, std::false_type) const {
+    return -1;
+  }
+
+  /// Builds the array of offsets if the labels are dense integers. Each slot
+  /// holds index + 1, or 0 if the axis does not contain the label. Slots are
+  /// written atomically, such that duplicate labels are detected.
+  template <class Axis> bool buildOffsets(const Axis &axis, std::true_type) {
+    const gsl::index size = axis.size();
+    using Range = std::pair<key_type, key_type>;
+    const auto range = parallel::reduce(
+        size,
+        Range{std::numeric_limits<key_type>::max(),
+              std::numeric_limits<key_type>::lowest()},
+        [&](const gsl::index begin, const gsl::index end) {
+          Range range{axis[begin], axis[begin]};
+          for (auto i = begin; i < end; ++i) {
+            range.first = std::min<key_type>(range.first, axis[i]);
+            range.second = std::max<key_type>(range.second, axis[i]);
+          }
+          return range;
+        },
+        [](const Range &a, const Range &b) {
+          return Range{std::min(a.first, b.first),
+                       std::max(a.second, b.second)};
+        });
+    // 0 if the labels span the full range of 64-bit integers.
+    const auto extent = static_cast<uint64_t>(range.second) -
+                        static_cast<uint64_t>(range.first) + 1;
+    if (extent == 0 || extent > 4 * static_cast<uint64_t>(size))
+      return false;
+    m_min = range.first;
+    m_offsets.resize(extent);
+    gsl::index duplicates = 0;
+    parallel::forEachChunk(size, [&](const gsl::index begin,
+                                     const gsl::index end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto offset =
+            static_cast<uint64_t>(axis[i]) - static_cast<uint64_t>(m_min);
+        if (parallel::fetchAdd(m_offsets[offset], i + 1) != 0)
+          parallel::fetchAdd(duplicates, gsl::index{1});
+      }
+    });
+    if (duplicates != 0)
+      throwDuplicates();
+    return true;
+  }
+  template <class Axis> bool buildOffsets(const Axis &, std::false_type) {
+    return false;
+  }
+
+  /// Builds the hash tables. The indices of the labels are sorted by
+  /// partition, by counting the labels of each partition in blocks of the
+  /// axis, an exclusive scan of the counts, and writing the indices of each
+  /// block at the resulting offsets. Each partition then has a contiguous
+  /// range of indices, in order, which one thread inserts into its table,
+  /// sized to be at most half full.
+  template <class Axis> void buildTables(const Axis &axis) {
+    const gsl::index size = axis.size();
+    m_partitionBits = 0;
+    if (size >= 2 * parallel::grainSize)
+      while ((gsl::index{1} << m_partitionBits) < omp_get_max_threads())
+        ++m_partitionBits;
+    const gsl::index partitions = gsl::index{1} << m_partitionBits;
+    std::vector<uint64_t> hashes(size);
+    parallel::forEachChunk(size, [&](const gsl::index begin,
+                                     const gsl::index end) {
+      for (auto i = begin; i < end; ++i)
+        hashes[i] = hash(axis[i]);
+    });
+
+    const auto block = parallel::grainSize;
+    const auto blocks = (size + block - 1) / block;
+    std::vector<gsl::index> offsets(partitions * blocks + 1, 0);
+    parallel::forEach(blocks, [&](const gsl::index b) {
+      const auto end = std::min(size, (b + 1) * block);
+      for (auto i = b * block; i < end; ++i)
+        ++offsets[partition(hashes[i]) * blocks + b];
+    });
+    parallel::exclusiveScan(offsets.size(), offsets.data());
+    std::vector<gsl::index> order(size);
+    parallel::forEach(blocks, [&](const gsl::index b) {
+      std::vector<gsl::index> next(partitions);
+      for (gsl::index p = 0; p < partitions; ++p)
+        next[p] = offsets[p * blocks + b];
+      const auto end = std::min(size, (b + 1) * block);
+      for (auto i = b * block; i < end; ++i)
+        order[next[partition(hashes[i])]++] = i;
+    });
+
+    m_tables.resize(partitions);
+    std::vector<char> unique(partitions, 1);
+    parallel::forEach(partitions, [&](const gsl::index p) {
+      const auto begin = offsets[p * blocks];
+      const auto end = offsets[(p + 1) * blocks];
+      uint64_t capacity = 1;
+      while (capacity < 2 * static_cast<uint64_t>(end - begin))
+        capacity *= 2;
+      auto &table = m_tables[p];
+      table.slots.assign(capacity, Slot{key_type{}, -1});
+      table.mask = capacity - 1;
+      for (auto k = begin; k < end; ++k) {
+        const auto i = order[k];
+        const key_type key(axis[i]);
+        auto pos = hashes[i] & table.mask;
+        for (; table.slots[pos].index >= 0; pos = (pos + 1) & table.mask)
+          if (table.slots[pos].key == key)
+            unique[p] = 0;
+        table.slots[pos] = Slot{key, i};
+      }
+    });
+    if (std::find(unique.begin(), unique.end(), 0) != unique.end())
+      throwDuplicates();
+  }
+
+  [[noreturn]] static void throwDuplicates() {
+    throw std::runtime_error("Axis contains duplicate labels. Cannot use it "
+                             "to index into the data.");
+  }
+
+  key_type m_min{};
+  Vector<gsl::index> m_offsets;
+  int m_partitionBits{0};
+  std::vector<Table> m_tables;
 };
 
 #endif // DATASET_INDEX_H
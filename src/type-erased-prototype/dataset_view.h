@@ -68,9 +68,7 @@ template <class Base, class T> struct GetterMixin<Base, Bin<T>> {
 };
 
 template <class Tag> struct ref_type {
-  using type = gsl::span<std::conditional_t<
-      std::is_const<Tag>::value, const typename detail::value_type_t<Tag>::type,
-      typename detail::value_type_t<Tag>::type>>;
+  using type = span_t<detail::value_type_t<Tag>>;
 };
 template <class Tag> struct ref_type<Bin<Tag>> {
   // First is the offset to the next edge.
@@ -78,13 +76,29 @@ template <class Tag> struct ref_type<Bin<Tag>> {
       std::pair<gsl::index,
                 gsl::span<const typename detail::value_type_t<Bin<Tag>>::type>>;
 };
+namespace detail {
+// Data of derived variables: the sources, or the cached values if caching is
+// enabled, see Dataset::enableCache.
+struct SpectrumPositionData {
+  // nullptr if not cached.
+  const PositionColumn *cached;
+  span_t<const Coord::DetectorPosition> positions;
+  span_t<const Coord::DetectorGrouping> grouping;
+};
+struct StdDevData {
+  // Standard deviations if isCached, else variances.
+  gsl::span<const double> values;
+  bool isCached;
+  StdDevData subspan(const gsl::index offset) const {
+    return {values.subspan(offset), isCached};
+  }
+};
+}
 template <> struct ref_type<Coord::SpectrumPosition> {
-  using type =
-      std::pair<gsl::span<const typename Coord::DetectorPosition::type>,
-                gsl::span<const typename Coord::DetectorGrouping::type>>;
+  using type = detail::SpectrumPositionData;
 };
 template <> struct ref_type<Data::StdDev> {
-  using type = typename ref_type<const Data::Variance>::type;
+  using type = detail::StdDevData;
 };
 template <class... Tags> struct ref_type<DatasetView<Tags...>> {
   using type = std::tuple<const MultiIndex, const DatasetView<Tags...>,
@@ -267,16 +281,23 @@ template <class Tag> struct DataHelper<Bin<Tag>> {
 template <> struct DataHelper<Coord::SpectrumPosition> {
   static auto get(const Dataset &dataset,
                   const Dimensions &iterationDimensions) {
-    return ref_type_t<Coord::SpectrumPosition>(
-        dataset.get<detail::value_type_t<const Coord::DetectorPosition>>(),
-        dataset.get<detail::value_type_t<const Coord::DetectorGrouping>>());
+    const auto cache = dataset.cached<Coord::SpectrumPosition>();
+    return ref_type_t<Coord::SpectrumPosition>{
+        cache ? &cache->get<const Coord::SpectrumPosition>().column()
+              : nullptr,
+        dataset.get<const Coord::DetectorPosition>(),
+        dataset.get<const Coord::DetectorGrouping>()};
   }
 };
 
 template <> struct DataHelper<Data::StdDev> {
   static auto get(const Dataset &dataset,
                   const Dimensions &iterationDimensions) {
-    return DataHelper<const Data::Variance>::get(dataset, iterationDimensions);
+    if (const auto cache = dataset.cached<Data::StdDev>())
+      return ref_type_t<Data::StdDev>{cache->get<const Data::StdDev>(), true};
+    return ref_type_t<Data::StdDev>{
+        DataHelper<const Data::Variance>::get(dataset, iterationDimensions),
+        false};
   }
 };
 
@@ -336,20 +357,28 @@ template <class Tag> struct ItemHelper {
 template <> struct ItemHelper<Coord::SpectrumPosition> {
   static element_return_type_t<Coord::SpectrumPosition>
   get(const ref_type_t<Coord::SpectrumPosition> &data, gsl::index index) {
-    if (data.second[index].empty())
+    const auto detectors = data.grouping[index];
+    if (detectors.empty())
       throw std::runtime_error(
           "Spectrum has no detectors, cannot get position.");
-    double position = 0.0;
-    for (const auto det : data.second[index])
-      position += data.first[det];
-    return position /= data.second[index].size();
+    if (data.cached)
+      return (*data.cached)[index];
+    Position position{{0.0, 0.0, 0.0}};
+    for (const auto det : detectors) {
+      const Position detector = data.positions[det];
+      for (gsl::index i = 0; i < 3; ++i)
+        position[i] += detector[i];
+    }
+    for (auto &component : position)
+      component /= detectors.size();
+    return position;
   }
 };
 
 template <> struct ItemHelper<Data::StdDev> {
   static element_return_type_t<Data::StdDev>
   get(const ref_type_t<Data::StdDev> &data, gsl::index index) {
-    return sqrt(ItemHelper<const Data::Variance>::get(data, index));
+    return data.isCached ? data.values[index] : sqrt(data.values[index]);
   }
 };
 
@@ -0,0 +1,59 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+#include "detector_grouping.h"
+#include "parallel.h"
+
+// Counting sort of the (spectrum, detector) pairs by detector: count the
+// spectra of each detector, the prefix sum of the counts gives the offsets of
+// the result, then scatter each spectrum to its detectors. Threads work on
+// chunks of the grouping and use atomic counters, so the spectra of a detector
+// are scattered in arbitrary order. Most detectors are part of a single
+// spectrum, so sorting each list afterwards is cheaper than per-thread
+// counts, which would be of size `detectors` for each thread.
+IndexListColumn invertGrouping(const IndexListColumn &grouping,
+                               const gsl::index detectors) {
+  const auto &offsets = grouping.offsets();
+  const auto &indices = grouping.values();
+  Vector<int64_t> inverseOffsets(detectors + 1, 0);
+
+  std::atomic<bool> outOfRange{false};
+  parallel::forEachChunk(
+      indices.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto i = begin; i < end; ++i) {
+          const auto detector = indices[i];
+          if (detector < 0 || detector >= detectors) {
+            outOfRange = true;
+            return;
+          }
+          parallel::fetchAdd(inverseOffsets[detector], int64_t{1});
+        }
+      });
+  if (outOfRange)
+    throw std::runtime_error("Detector index in grouping out of range.");
+  parallel::exclusiveScan(inverseOffsets.size(), inverseOffsets.data());
+
+  Vector<int64_t> cursor(inverseOffsets.begin(), inverseOffsets.end() - 1);
+  Vector<gsl::index> spectra(indices.size());
+  parallel::forEachChunk(
+      grouping.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto spectrum = begin; spectrum < end; ++spectrum)
+          for (auto i = offsets[spectrum]; i < offsets[spectrum + 1]; ++i)
+            spectra[parallel::fetchAdd(cursor[indices[i]], int64_t{1})] =
+                spectrum;
+      });
+
+  parallel::forEachChunk(
+      detectors, [&](const gsl::index begin, const gsl::index end) {
+        for (auto detector = begin; detector < end; ++detector)
+          std::sort(spectra.begin() + inverseOffsets[detector],
+                    spectra.begin() + inverseOffsets[detector + 1]);
+      });
+  return IndexListColumn(std::move(inverseOffsets), std::move(spectra));
+}
@@ -0,0 +1,20 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef DETECTOR_GROUPING_H
+#define DETECTOR_GROUPING_H
+
+#include <gsl/gsl_util>
+
+#include "list_column.h"
+
+/// Returns the inverse of a spectrum-to-detector mapping as given by
+/// Coord::DetectorGrouping, i.e., for each of the `detectors` detectors the
+/// spectra it is part of, in ascending order. Throws if `grouping` contains
+/// an index outside [0, detectors).
+IndexListColumn invertGrouping(const IndexListColumn &grouping,
+                               const gsl::index detectors);
+
+#endif // DETECTOR_GROUPING_H
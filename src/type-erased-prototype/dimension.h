@@ -20,7 +20,12 @@ enum class Dimension : char {
   Polarization,
   Temperature,
   DetectorScan,
-  Row
+  Row,
+  Event,
+  Time,
+  DSpacing,
+  Wavelength,
+  DeltaE
 };
 
 #endif // DIMENSION_H
@@ -4,11 +4,33 @@
 /// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
 /// National Laboratory, and European Spallation Source ERIC.
 #include <algorithm>
-#include <numeric>
 
 #include "dimensions.h"
+#include "parallel.h"
 #include "variable.h"
 
+struct Dimensions::Ragged {
+  Ragged(const Variable &sizes_) : sizes(sizes_) {
+    const auto size = sizes.get<const Data::DimensionSize>();
+    if (std::any_of(size.begin(), size.end(),
+                    [](const gsl::index n) { return n < 0; }))
+      throw std::runtime_error(
+          "Size of ragged dimension must not be negative.");
+    offsets.resize(size.size() + 1);
+    std::copy(size.begin(), size.end(), offsets.begin());
+    offsets.back() = 0;
+    parallel::exclusiveScan(offsets.size(), offsets.data());
+  }
+  bool operator==(const Ragged &other) const {
+    return this == &other || sizes == other.sizes;
+  }
+
+  Variable sizes;
+  /// Offset of each row of the ragged dimension, with the total size as last
+  /// element.
+  Vector<gsl::index> offsets;
+};
+
 Dimensions::Dimensions() = default;
 Dimensions::Dimensions(const Dimension label, const gsl::index size) {
   add(label, size);
@@ -18,26 +40,21 @@ Dimensions::Dimensions(
   for (const auto &item : sizes)
     add(item.first, item.second);
 }
-Dimensions::Dimensions(const Dimensions &other) : m_dims(other.m_dims) {
-  if (other.m_raggedDim)
-    m_raggedDim = std::make_unique<Variable>(*other.m_raggedDim);
-}
+Dimensions::Dimensions(const Dimensions &other) = default;
 Dimensions::Dimensions(Dimensions &&other) = default;
 Dimensions::~Dimensions() = default;
-Dimensions &Dimensions::operator=(const Dimensions &other) {
-  auto copy(other);
-  std::swap(*this, copy);
-}
+Dimensions &Dimensions::operator=(const Dimensions &other) = default;
 Dimensions &Dimensions::operator=(Dimensions &&other) = default;
 
 bool Dimensions::operator==(const Dimensions &other) const {
-  // Ragged comparison too complex for now.
-  if (m_raggedDim || other.m_raggedDim)
+  if (m_dims != other.m_dims)
     return false;
-  return m_dims == other.m_dims;
+  if (m_ragged && other.m_ragged)
+    return *m_ragged == *other.m_ragged;
+  return m_ragged == other.m_ragged;
 }
 
-bool Dimensions::isRagged() const { return m_raggedDim != nullptr; }
+bool Dimensions::isRagged() const { return m_ragged != nullptr; }
 
 gsl::index Dimensions::count() const { return m_dims.size(); }
 
@@ -60,8 +77,7 @@ gsl::index Dimensions::volume() const {
       if (found != dependentDimensions.count())
         throw std::runtime_error(
             "Ragged size information contains extra dimensions.");
-      const auto &sizes = raggedInfo.get<const Data::DimensionSize>();
-      volume *= std::accumulate(sizes.begin(), sizes.end(), 0);
+      volume *= m_ragged->offsets.back();
       raggedCorrection = dependentDimensions.volume();
     } else {
       volume *= size(dim);
@@ -83,13 +99,11 @@ bool Dimensions::contains(const Dimension label) const {
 bool Dimensions::contains(const Dimensions &other) const {
   if (*this == other)
     return true;
-  // Ragged comparison too complex for now.
-  if (m_raggedDim || other.m_raggedDim)
-    return false;
   for (const auto &item : other.m_dims)
     if (std::find(m_dims.begin(), m_dims.end(), item) == m_dims.end())
       return false;
-  return true;
+  // A ragged dimension in other has been found as ragged in *this.
+  return !other.m_ragged || *m_ragged == *other.m_ragged;
 }
 
 bool Dimensions::isRagged(const gsl::index i) const {
@@ -154,24 +168,47 @@ void Dimensions::resize(const Dimension label, const gsl::index size) {
 }
 
 void Dimensions::erase(const Dimension label) {
-  if (m_raggedDim)
+  if (m_ragged)
     throw std::runtime_error(
         "Dimensions::erase not implemented if any dimension is ragged.");
 
   m_dims.erase(m_dims.begin() + index(label));
 }
 
+/// Renames dimension `from` to `to`, keeping its size and position.
+void Dimensions::relabel(const Dimension from, const Dimension to) {
+  if (from != to && contains(to))
+    throw std::runtime_error("Dimension already exists.");
+  m_dims[index(from)].first = to;
+}
+
 const Variable &Dimensions::raggedSize(const gsl::index i) const {
   if (m_dims.at(i).second != -1)
     throw std::runtime_error(
         "Dimension is not ragged, use size() instead of raggedSize().");
-  return *m_raggedDim;
+  return m_ragged->sizes;
 }
 
 const Variable &Dimensions::raggedSize(const Dimension label) const {
   return raggedSize(index(label));
 }
 
+/// Returns the offsets of the rows of ragged dimension i, i.e., the prefix sum
+/// of raggedSize(i), with one extra element holding the total size. For a
+/// variable with the ragged dimension as innermost dimension this is the
+/// offset of each row in the data.
+gsl::span<const gsl::index>
+Dimensions::raggedOffsets(const gsl::index i) const {
+  if (m_dims.at(i).second != -1)
+    throw std::runtime_error("Dimension is not ragged, no offsets available.");
+  return m_ragged->offsets;
+}
+
+gsl::span<const gsl::index>
+Dimensions::raggedOffsets(const Dimension label) const {
+  return raggedOffsets(index(label));
+}
+
 void Dimensions::add(const Dimension label, const gsl::index size) {
   // TODO check duplicate dimensions
   m_dims.emplace_back(label, size);
@@ -182,10 +219,21 @@ void Dimensions::add(const Dimension label, const Variable &raggedSize) {
   if (!raggedSize.valueTypeIs<Data::DimensionSize>())
     throw std::runtime_error("Variable with sizes information for ragged "
                              "dimension is of wrong type.");
+  if (m_ragged)
+    throw std::runtime_error("Only one dimension can be ragged.");
+  m_ragged = std::make_shared<const Ragged>(raggedSize);
   m_dims.emplace_back(label, -1);
-  if (m_raggedDim)
+}
+
+/// Adds dimension `label` of `other`. If it is ragged the offsets are shared
+/// with `other`.
+void Dimensions::add(const Dimension label, const Dimensions &other) {
+  if (!other.isRagged(label))
+    return add(label, other.size(label));
+  if (m_ragged)
     throw std::runtime_error("Only one dimension can be ragged.");
-  m_raggedDim = std::make_unique<Variable>(raggedSize);
+  m_ragged = other.m_ragged;
+  m_dims.emplace_back(label, -1);
 }
 
 gsl::index Dimensions::index(const Dimension label) const {
@@ -203,10 +251,7 @@ Dimensions merge(const Dimensions &a, const Dimensions &b) {
     const auto dim = item.first;
     const auto size = item.second;
     if (!a.contains(dim)) {
-      if (size == -1)
-        merged.add(dim, b.raggedSize(dim));
-      else
-        merged.add(dim, size);
+      merged.add(dim, b);
     } else {
       if (a.isRagged(dim)) {
         if (size == -1) {
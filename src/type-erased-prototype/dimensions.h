@@ -12,6 +12,7 @@
 
 #include <boost/container/small_vector.hpp>
 #include <gsl/gsl_util>
+#include <gsl/span>
 
 #include "dimension.h"
 
@@ -44,11 +45,15 @@ public:
   gsl::index offset(const Dimension label) const;
   void resize(const Dimension label, const gsl::index size);
   void erase(const Dimension label);
+  void relabel(const Dimension from, const Dimension to);
 
   const Variable &raggedSize(const gsl::index i) const;
   const Variable &raggedSize(const Dimension label) const;
+  gsl::span<const gsl::index> raggedOffsets(const gsl::index i) const;
+  gsl::span<const gsl::index> raggedOffsets(const Dimension label) const;
   void add(const Dimension label, const gsl::index size);
   void add(const Dimension label, const Variable &raggedSize);
+  void add(const Dimension label, const Dimensions &other);
 
   auto begin() const { return m_dims.begin(); }
   auto end() const { return m_dims.end(); }
@@ -56,10 +61,13 @@ public:
   gsl::index index(const Dimension label) const;
 
 private:
+  struct Ragged;
+
   boost::container::small_vector<std::pair<Dimension, gsl::index>, 2> m_dims;
-  // In a Dataset, multiple Variables will reference the same ragged size
-  // Variable. How can we support shape operations without breaking sharing?
-  std::unique_ptr<Variable> m_raggedDim;
+  // Sizes of the ragged dimension, if any, and their prefix sum. This is
+  // immutable and shared between copies, i.e., all Variables in a Dataset
+  // refer to the same offsets.
+  std::shared_ptr<const Ragged> m_ragged;
 };
 
 Dimensions merge(const Dimensions &a, const Dimensions &b);
@@ -0,0 +1,995 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "events.h"
+#include "parallel.h"
+
+namespace {
+// Events are processed in blocks: the bin index of all events in a block is
+// computed first, in a loop the compiler can vectorize for linear and
+// logarithmic bins, then the events are added to their bins.
+constexpr gsl::index blockSize = 256;
+
+/// Computes the bin index of time-of-flight values. Linear and logarithmic
+/// bins are detected on construction and the index is computed directly
+/// instead of by binary search.
+class BinIndex {
+public:
+  explicit BinIndex(const gsl::span<const double> edges)
+      : m_edges(edges), m_bins(edges.size() - 1) {
+    const double first = edges[0];
+    const double last = edges[m_bins];
+    // Accept if the computed position of every edge is within a small fraction
+    // of a bin, the remaining rounding errors are corrected in operator().
+    const auto spacedBy = [&](auto position) {
+      for (gsl::index i = 0; i <= m_bins; ++i)
+        if (std::abs(position(edges[i]) - static_cast<double>(i)) > 1e-6)
+          return false;
+      return true;
+    };
+    m_offset = first;
+    m_scale = static_cast<double>(m_bins) / (last - first);
+    if (spacedBy([&](const double t) { return (t - m_offset) * m_scale; })) {
+      m_spacing = Spacing::Linear;
+      return;
+    }
+    if (first > 0.0) {
+      m_offset = 1.0 / first;
+      m_scale = static_cast<double>(m_bins) / std::log(last / first);
+      if (spacedBy([&](const double t) {
+            return std::log(t * m_offset) * m_scale;
+          })) {
+        m_spacing = Spacing::Log;
+        return;
+      }
+    }
+  }
+
+  gsl::index bins() const { return m_bins; }
+
+  /// Sets `bin[i]` to the index of the bin containing `tof[i]`, or -1 if it is
+  /// outside the edges, for i < count <= blockSize.
+  void operator()(const double *tof, const gsl::index count,
+                  gsl::index *bin) const {
+    if (m_spacing == Spacing::Irregular) {
+      for (gsl::index i = 0; i < count; ++i) {
+        const auto it =
+            std::upper_bound(m_edges.begin(), m_edges.end(), tof[i]);
+        bin[i] = it == m_edges.begin() || it == m_edges.end()
+                     ? -1
+                     : it - m_edges.begin() - 1;
+      }
+      return;
+    }
+    double estimate[blockSize];
+    if (m_spacing == Spacing::Linear)
+      for (gsl::index i = 0; i < count; ++i)
+        estimate[i] = (tof[i] - m_offset) * m_scale;
+    else
+      for (gsl::index i = 0; i < count; ++i)
+        estimate[i] = std::log(tof[i] * m_offset) * m_scale;
+    const double lastBin = static_cast<double>(m_bins - 1);
+    for (gsl::index i = 0; i < count; ++i) {
+      // Clamp before conversion, this also maps NaN to 0.
+      auto b = static_cast<gsl::index>(
+          estimate[i] > 0.0 ? std::min(estimate[i], lastBin) : 0.0);
+      // Due to rounding the estimate may be off by one for events close to
+      // a bin edge.
+      if (b > 0 && tof[i] < m_edges[b])
+        --b;
+      else if (b < m_bins - 1 && tof[i] >= m_edges[b + 1])
+        ++b;
+      bin[i] = m_edges[b] <= tof[i] && tof[i] < m_edges[b + 1] ? b : -1;
+    }
+  }
+
+private:
+  enum class Spacing { Linear, Log, Irregular };
+  gsl::span<const double> m_edges;
+  gsl::index m_bins;
+  Spacing m_spacing{Spacing::Irregular};
+  double m_offset;
+  double m_scale;
+};
+
+template <class T> struct EventColumns {
+  const T *tof;
+  const double *weight;
+  const double *weightVariance;
+};
+
+const double *asDouble(const double *tof, const gsl::index, double *) {
+  return tof;
+}
+const double *asDouble(const float *tof, const gsl::index count,
+                       double *buffer) {
+  for (gsl::index i = 0; i < count; ++i)
+    buffer[i] = tof[i];
+  return buffer;
+}
+
+/// Adds the events [begin, end) to the histogram given by `value` and
+/// `variance`.
+template <bool Weighted, class T>
+void addEvents(const EventColumns<T> &events, const gsl::index begin,
+               const gsl::index end, const BinIndex &binIndex, double *value,
+               double *variance) {
+  gsl::index bin[blockSize];
+  double converted[blockSize];
+  for (auto block = begin; block < end; block += blockSize) {
+    const auto count = std::min(blockSize, end - block);
+    binIndex(asDouble(events.tof + block, count, converted), count, bin);
+    for (gsl::index i = 0; i < count; ++i) {
+      if (bin[i] < 0)
+        continue;
+      value[bin[i]] += Weighted ? events.weight[block + i] : 1.0;
+      variance[bin[i]] += Weighted ? events.weightVariance[block + i] : 1.0;
+    }
+  }
+}
+
+// Threads process equal numbers of events rather than equal numbers of spectra,
+// since event counts vary by orders of magnitude between spectra. A spectrum
+// that lies entirely in the chunk of a thread is histogrammed directly into
+// the output. The at most two spectra at the ends of the chunk may be shared
+// with other threads, their events are histogrammed into a thread-private
+// accumulator, which is added to the output under a lock. This also means that
+// a single spectrum with many events is processed by all threads.
+template <bool Weighted, class T>
+void histogramEvents(const EventColumns<T> &events,
+                     const gsl::span<const gsl::index> offsets,
+                     const BinIndex &binIndex, double *value,
+                     double *variance) {
+  const auto bins = binIndex.bins();
+  const auto spectra = offsets.size() - 1;
+  std::mutex mutex;
+  parallel::forEachChunk(
+      offsets[spectra], [&](const gsl::index begin, const gsl::index end) {
+        std::vector<double> accumulator;
+        auto spectrum =
+            std::upper_bound(offsets.begin(), offsets.end(), begin) -
+            offsets.begin() - 1;
+        for (; spectrum < spectra && offsets[spectrum] < end; ++spectrum) {
+          const auto first = std::max(begin, offsets[spectrum]);
+          const auto last = std::min(end, offsets[spectrum + 1]);
+          auto *spectrumValue = value + spectrum * bins;
+          auto *spectrumVariance = variance + spectrum * bins;
+          if (first == offsets[spectrum] && last == offsets[spectrum + 1]) {
+            addEvents<Weighted>(events, first, last, binIndex, spectrumValue,
+                                spectrumVariance);
+            continue;
+          }
+          accumulator.assign(2 * bins, 0.0);
+          addEvents<Weighted>(events, first, last, binIndex,
+                              accumulator.data(), accumulator.data() + bins);
+          std::lock_guard<std::mutex> lock(mutex);
+          for (gsl::index bin = 0; bin < bins; ++bin) {
+            spectrumValue[bin] += accumulator[bin];
+            spectrumVariance[bin] += accumulator[bins + bin];
+          }
+        }
+      });
+}
+
+/// Returns the values of the bin edges `edges` for histogramming.
+gsl::span<const double> edgeValues(const Variable &edges) {
+  if (!edges.valueTypeIs<Coord::Tof>() || edges.dimensions().count() != 1 ||
+      edges.dimensions().label(0) != Dimension::Tof)
+    throw std::runtime_error(
+        "Bin edges must be a one-dimensional Coord::Tof variable.");
+  const auto values = edges.get<const Coord::Tof>();
+  if (values.size() < 2)
+    throw std::runtime_error("Bin edges must define at least one bin.");
+  if (std::adjacent_find(values.begin(), values.end(),
+                         std::greater_equal<double>()) != values.end())
+    throw std::runtime_error("Bin edges must be strictly increasing.");
+  return values;
+}
+
+/// Returns the offsets of the events of each spectrum, given the dimensions of
+/// the event variables.
+gsl::span<const gsl::index> eventOffsets(const Dimensions &dims) {
+  if (dims.count() == 0 || dims.label(0) != Dimension::Event ||
+      !dims.isRagged(0))
+    throw std::runtime_error(
+        "Events must have the ragged Dimension::Event as inner dimension.");
+  const auto offsets = dims.raggedOffsets(0);
+  gsl::index spectra = 1;
+  for (gsl::index i = 1; i < dims.count(); ++i)
+    spectra *= dims.size(i);
+  if (spectra != offsets.size() - 1)
+    throw std::runtime_error("Events with dimensions other than those of the "
+                             "event counts are not supported.");
+  return offsets;
+}
+
+/// Returns the dimensions of a histogram with `bins` bins of events with
+/// dimensions `dims`.
+Dimensions histogramDimensions(const Dimensions &dims, const gsl::index bins) {
+  Dimensions histogramDims(Dimension::Tof, bins);
+  for (gsl::index i = 1; i < dims.count(); ++i)
+    histogramDims.add(dims.label(i), dims.size(i));
+  return histogramDims;
+}
+
+/// Calls `f(first, last)` in parallel for ranges of spectra [first, last),
+/// given the event offsets of the spectra. Each thread processes the spectra
+/// beginning in its chunk of events, such that threads get similar numbers of
+/// events, but a single large spectrum is processed by a single thread.
+template <class F>
+void forEachSpectrumChunk(const gsl::span<const gsl::index> offsets, F &&f) {
+  const auto spectra = offsets.size() - 1;
+  parallel::forEachChunk(
+      offsets[spectra], [&](const gsl::index begin, const gsl::index end) {
+        const auto spectrum = [&](const gsl::index event) {
+          return std::lower_bound(offsets.begin(), offsets.begin() + spectra,
+                                  event) -
+                 offsets.begin();
+        };
+        f(spectrum(begin), spectrum(end));
+      });
+}
+
+// Spectra are sorted with an LSD radix sort of the keys, carrying along the
+// index of each event in the spectrum. The resulting permutation is then
+// applied to all event variables, such that each pass of the sort moves only
+// keys and indices, no matter how many variables there are.
+constexpr uint64_t signBit = uint64_t{1} << 63;
+
+/// Maps keys to unsigned integers with the same order, such that the radix
+/// sort can work on their bytes.
+uint64_t radixKey(const double key) {
+  uint64_t bits;
+  std::memcpy(&bits, &key, sizeof(bits));
+  return bits & signBit ? ~bits : bits | signBit;
+}
+uint64_t radixKey(const int64_t key) {
+  return static_cast<uint64_t>(key) ^ signBit;
+}
+
+/// Below this number of events the cost of clearing the counts of the radix
+/// sort outweighs its advantage over comparison-based sorting.
+constexpr gsl::index radixSortThreshold = 128;
+
+/// Scratch space of a thread, reused for all of its spectra.
+struct SortBuffers {
+  std::vector<uint64_t> keys[2];
+  std::vector<uint32_t> indices[2];
+  std::vector<std::pair<uint64_t, uint32_t>> pairs;
+  std::vector<double> doubles;
+  std::vector<int64_t> ints;
+};
+
+/// Returns the permutation that stably sorts `keys[0, size)`. The result
+/// points into `buffers`.
+template <class T>
+const uint32_t *sortPermutation(const T *keys, const gsl::index size,
+                                SortBuffers &buffers) {
+  for (gsl::index i = 0; i < 2; ++i) {
+    buffers.keys[i].resize(size);
+    buffers.indices[i].resize(size);
+  }
+  auto *key = buffers.keys[0].data();
+  auto *index = buffers.indices[0].data();
+  if (size < radixSortThreshold) {
+    // Sorting by (key, index) gives the same order as a stable sort by key.
+    auto &pairs = buffers.pairs;
+    pairs.resize(size);
+    for (gsl::index i = 0; i < size; ++i)
+      pairs[i] = {radixKey(keys[i]), static_cast<uint32_t>(i)};
+    std::sort(pairs.begin(), pairs.end());
+    for (gsl::index i = 0; i < size; ++i)
+      index[i] = pairs[i].second;
+    return index;
+  }
+  for (gsl::index i = 0; i < size; ++i) {
+    key[i] = radixKey(keys[i]);
+    index[i] = static_cast<uint32_t>(i);
+  }
+
+  uint32_t counts[8][256] = {};
+  for (gsl::index i = 0; i < size; ++i)
+    for (int byte = 0; byte < 8; ++byte)
+      ++counts[byte][(key[i] >> (8 * byte)) & 0xff];
+  auto *keyOut = buffers.keys[1].data();
+  auto *indexOut = buffers.indices[1].data();
+  for (int byte = 0; byte < 8; ++byte) {
+    const auto shift = 8 * byte;
+    auto &count = counts[byte];
+    // Skip the pass if all keys have the same digit, e.g., the high bytes of
+    // pulse times.
+    if (count[(key[0] >> shift) & 0xff] == size)
+      continue;
+    uint32_t offset = 0;
+    for (auto &c : count) {
+      const auto n = c;
+      c = offset;
+      offset += n;
+    }
+    for (gsl::index i = 0; i < size; ++i) {
+      const auto target = count[(key[i] >> shift) & 0xff]++;
+      keyOut[target] = key[i];
+      indexOut[target] = index[i];
+    }
+    std::swap(key, keyOut);
+    std::swap(index, indexOut);
+  }
+  return index;
+}
+
+template <class T>
+void permute(T *data, const uint32_t *permutation, const gsl::index size,
+             std::vector<T> &buffer) {
+  buffer.resize(size);
+  for (gsl::index i = 0; i < size; ++i)
+    buffer[i] = data[permutation[i]];
+  std::copy(buffer.begin(), buffer.end(), data);
+}
+
+/// Throws unless the event variables with name `name` have dimensions `dims`
+/// and are of a type supported by the operation `operation`.
+void checkEventVariables(const Dataset &events, const std::string &name,
+                         const Dimensions &dims, const std::string &operation) {
+  for (const auto &var : events) {
+    if (var.name() != name || !var.dimensions().contains(Dimension::Event))
+      continue;
+    if (!var.valueTypeIs<Data::Tof>() && !var.valueTypeIs<Data::PulseTime>() &&
+        !var.valueTypeIs<Data::Weight>() &&
+        !var.valueTypeIs<Data::WeightVariance>())
+      throw std::runtime_error("Cannot " + operation +
+                               " events with variables other than "
+                               "Data::Tof, Data::PulseTime, Data::Weight, and "
+                               "Data::WeightVariance.");
+    if (!(var.dimensions() == dims))
+      throw std::runtime_error(
+          "Event variables must have the same dimensions as Data::Tof.");
+  }
+}
+
+/// Returns `events` if its events with name `name` are sorted by pulse time.
+/// Otherwise the event variables are copied into `buffer`, sorted, and
+/// `buffer` is returned.
+const Dataset &sortedByPulseTime(const Dataset &events, const std::string &name,
+                                 Dataset &buffer) {
+  if (events[events.find(tag_id<Data::PulseTime>, name)]
+          .isSortedBy<Data::PulseTime>())
+    return events;
+  for (const auto &var : events)
+    if (var.name() == name && var.dimensions().contains(Dimension::Event))
+      buffer.insert(var);
+  sortEvents<Data::PulseTime>(buffer, name);
+  return buffer;
+}
+
+constexpr gsl::index maxPulseDelta = std::numeric_limits<uint16_t>::max();
+constexpr gsl::index maxPulseEvents = std::numeric_limits<uint16_t>::max();
+
+/// Calls `emit(entry)` for each entry of the pulse index required for a pulse
+/// with `events` events that is `delta` pulses after the previous entry.
+template <class Emit>
+void encodePulse(gsl::index delta, gsl::index events, Emit &&emit) {
+  for (; delta > maxPulseDelta; delta -= maxPulseDelta)
+    emit(CompactEvents::Pulse{static_cast<uint16_t>(maxPulseDelta), 0});
+  for (; events > maxPulseEvents; events -= maxPulseEvents) {
+    emit(CompactEvents::Pulse{static_cast<uint16_t>(delta),
+                              static_cast<uint16_t>(maxPulseEvents)});
+    delta = 0;
+  }
+  emit(CompactEvents::Pulse{static_cast<uint16_t>(delta),
+                            static_cast<uint16_t>(events)});
+}
+
+/// Calls `f(pulseTime, begin, end)` for each range [begin, end) of events with
+/// the same pulse time in the sorted range of pulse times [first, last).
+template <class F>
+void forEachPulseTime(const int64_t *pulseTimes, gsl::index first,
+                      const gsl::index last, F &&f) {
+  while (first < last) {
+    auto end = first + 1;
+    while (end < last && pulseTimes[end] == pulseTimes[first])
+      ++end;
+    f(pulseTimes[first], first, end);
+    first = end;
+  }
+}
+
+/// Returns the distinct pulse times of events sorted by pulse time within each
+/// spectrum, in ascending order.
+Vector<int64_t> distinctPulseTimes(const int64_t *pulseTimes,
+                                   const gsl::span<const gsl::index> offsets) {
+  std::vector<int64_t> result;
+  std::mutex mutex;
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    // Spectra typically see the same pulses, so the number of distinct pulse
+    // times of a thread is small compared to its number of events.
+    std::vector<int64_t> local;
+    std::size_t distinct = 0;
+    const auto makeDistinct = [&]() {
+      std::sort(local.begin(), local.end());
+      local.erase(std::unique(local.begin(), local.end()), local.end());
+      distinct = local.size();
+    };
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum) {
+      forEachPulseTime(pulseTimes, offsets[spectrum], offsets[spectrum + 1],
+                       [&](const int64_t pulseTime, const gsl::index,
+                           const gsl::index) { local.push_back(pulseTime); });
+      if (local.size() > 2 * distinct + 1024)
+        makeDistinct();
+    }
+    makeDistinct();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<int64_t> merged;
+    merged.reserve(result.size() + local.size());
+    std::set_union(result.begin(), result.end(), local.begin(), local.end(),
+                   std::back_inserter(merged));
+    result.swap(merged);
+  });
+  return Vector<int64_t>(result.begin(), result.end());
+}
+
+using Interval = std::pair<int64_t, int64_t>;
+
+/// Returns the intervals in `intervals`, a Coord::TimeInterval variable.
+gsl::span<const Interval> intervalValues(const Variable &intervals) {
+  if (!intervals.valueTypeIs<Coord::TimeInterval>() ||
+      intervals.dimensions().count() != 1)
+    throw std::runtime_error(
+        "Time intervals must be a one-dimensional Coord::TimeInterval "
+        "variable.");
+  const auto values = intervals.get<const Coord::TimeInterval>();
+  for (gsl::index i = 0; i < values.size(); ++i)
+    if (values[i].first >= values[i].second ||
+        (i > 0 && values[i - 1].second > values[i].first))
+      throw std::runtime_error(
+          "Time intervals must be non-empty, sorted, and disjoint.");
+  return values;
+}
+
+/// Returns the first element in [first, last) for which `less(element, value)`
+/// is false, as std::lower_bound. The search range grows exponentially from
+/// `first`, such that the cost is logarithmic in the distance of the result
+/// from `first` rather than in the size of the range.
+template <class T, class Value, class Less>
+const T *gallop(const T *first, const T *last, const Value &value,
+                Less &&less) {
+  if (first == last || !less(*first, value))
+    return first;
+  gsl::index step = 1;
+  while (step < last - first && less(first[step], value)) {
+    first += step;
+    step *= 2;
+  }
+  const auto *end = step < last - first ? first + step + 1 : last;
+  return std::lower_bound(first + 1, end, value, less);
+}
+
+/// Calls `f(interval, begin, end)` for each interval with events in the
+/// range [first, last) of events sorted by pulse time, with [begin, end) the
+/// events in the interval. This is a merge of the sorted events and the sorted
+/// intervals, each side skips ahead by galloping search, such that a few
+/// intervals applied to many events and many intervals applied to a few
+/// events are both cheap.
+template <class F>
+void forEachInterval(const int64_t *pulseTimes, const gsl::index first,
+                     const gsl::index last,
+                     const gsl::span<const Interval> intervals, F &&f) {
+  const auto endsBefore = [](const Interval &interval, const int64_t time) {
+    return interval.second <= time;
+  };
+  const auto less = std::less<int64_t>();
+  const auto *event = pulseTimes + first;
+  const auto *eventEnd = pulseTimes + last;
+  const auto *interval = intervals.data();
+  const auto *intervalEnd = interval + intervals.size();
+  while (event != eventEnd) {
+    interval = gallop(interval, intervalEnd, *event, endsBefore);
+    if (interval == intervalEnd)
+      return;
+    const auto *begin = gallop(event, eventEnd, interval->first, less);
+    event = gallop(begin, eventEnd, interval->second, less);
+    if (event != begin)
+      f(interval - intervals.data(), begin - pulseTimes, event - pulseTimes);
+    ++interval;
+  }
+}
+
+/// Returns the events with name `name` in the ranges given by
+/// `ranges(spectrum, f)`, which calls `f(begin, end)` for each range of events
+/// of `spectrum`. `source` contains the event variables, `events` the other
+/// variables, which are copied.
+template <class Ranges>
+Dataset selectEvents(const Dataset &events, const Dataset &source,
+                     const std::string &name, const Ranges &ranges) {
+  const auto &dims = source.dimensions<Data::Tof>(name);
+  const auto offsets = eventOffsets(dims);
+  Vector<gsl::index> counts(offsets.size() - 1, 0);
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum)
+      ranges(spectrum, [&](const gsl::index begin, const gsl::index end) {
+        counts[spectrum] += end - begin;
+      });
+  });
+  const auto selectedDims = eventDimensions(makeVariable<Data::DimensionSize>(
+      dims.raggedSize(0).dimensions(), std::move(counts)));
+  const auto selectedOffsets = selectedDims.raggedOffsets(0);
+
+  std::vector<Variable> selected;
+  std::vector<std::pair<const double *, double *>> doubleColumns;
+  std::vector<std::pair<const int64_t *, int64_t *>> intColumns;
+  const auto add = [&](const Variable &var, auto tag, auto &columns) {
+    using Tag = decltype(tag);
+    if (!var.valueTypeIs<Tag>())
+      return;
+    selected.push_back(makeVariable<Tag>(selectedDims, selectedDims.volume()));
+    auto &out = selected.back();
+    out.setName(name);
+    out.setUnit(var.unit());
+    columns.emplace_back(var.get<const Tag>().data(),
+                         out.get<Tag>().data());
+    out.setSortedBy(var.sortedBy());
+  };
+  for (const auto &var : source) {
+    if (var.name() != name || !var.dimensions().contains(Dimension::Event))
+      continue;
+    add(var, Data::Tof{}, doubleColumns);
+    add(var, Data::PulseTime{}, intColumns);
+    add(var, Data::Weight{}, doubleColumns);
+    add(var, Data::WeightVariance{}, doubleColumns);
+  }
+
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum) {
+      auto target = selectedOffsets[spectrum];
+      ranges(spectrum, [&](const gsl::index begin, const gsl::index end) {
+        for (const auto &column : doubleColumns)
+          std::copy(column.first + begin, column.first + end,
+                    column.second + target);
+        for (const auto &column : intColumns)
+          std::copy(column.first + begin, column.first + end,
+                    column.second + target);
+        target += end - begin;
+      });
+    }
+  });
+
+  Dataset result;
+  for (const auto &var : events)
+    if (!var.dimensions().contains(Dimension::Event))
+      result.insert(var);
+  for (auto &var : selected)
+    result.insert(std::move(var));
+  return result;
+}
+}
+
+Dimensions eventDimensions(const Variable &eventCounts) {
+  Dimensions dims;
+  dims.add(Dimension::Event, eventCounts);
+  for (const auto &item : eventCounts.dimensions())
+    dims.add(item.first, item.second);
+  return dims;
+}
+
+Dataset histogram(const Dataset &events, const std::string &name,
+                  const Variable &edges) {
+  const BinIndex binIndex(edgeValues(edges));
+  const auto &dims = events.dimensions<Data::Tof>(name);
+  const auto offsets = eventOffsets(dims);
+  const auto histogramDims = histogramDimensions(dims, binIndex.bins());
+
+  EventColumns<double> columns{events.get<const Data::Tof>(name).data(),
+                               nullptr, nullptr};
+  for (const auto &var : events) {
+    if (var.name() != name)
+      continue;
+    if (!var.valueTypeIs<Data::Weight>() &&
+        !var.valueTypeIs<Data::WeightVariance>())
+      continue;
+    if (!(var.dimensions() == dims))
+      throw std::runtime_error(
+          "Event weights must have the same dimensions as Data::Tof.");
+    if (var.valueTypeIs<Data::Weight>())
+      columns.weight = var.get<const Data::Weight>().data();
+    else
+      columns.weightVariance = var.get<const Data::WeightVariance>().data();
+  }
+  if (!columns.weight != !columns.weightVariance)
+    throw std::runtime_error("Event weights require both Data::Weight and "
+                             "Data::WeightVariance.");
+
+  Vector<double> value(histogramDims.volume(), 0.0);
+  Vector<double> variance(histogramDims.volume(), 0.0);
+  if (columns.weight)
+    histogramEvents<true>(columns, offsets, binIndex, value.data(),
+                          variance.data());
+  else
+    histogramEvents<false>(columns, offsets, binIndex, value.data(),
+                           variance.data());
+
+  Dataset result;
+  for (const auto &var : events)
+    if (!var.dimensions().contains(Dimension::Event))
+      result.insert(var);
+  result.insertAsEdge(Dimension::Tof, edges);
+  result.insert<Data::Value>(name, histogramDims, std::move(value));
+  result.insert<Data::Variance>(name, histogramDims, std::move(variance));
+  return result;
+}
+
+void detail::sortEvents(Dataset &events, const std::string &name,
+                        const uint16_t key) {
+  const auto &dims = events.dimensions<Data::Tof>(name);
+  const auto offsets = eventOffsets(dims);
+  if (events[events.find(key, name)].sortedBy() == key)
+    return;
+  checkEventVariables(events, name, dims, "sort");
+  for (gsl::index spectrum = 0; spectrum < offsets.size() - 1; ++spectrum)
+    if (offsets[spectrum + 1] - offsets[spectrum] >
+        std::numeric_limits<uint32_t>::max())
+      throw std::runtime_error(
+          "Cannot sort spectra with more than 2^32 events.");
+
+  // Take the variables out of the dataset such that they are not shared and
+  // the write access below does not copy.
+  std::vector<Variable> variables;
+  {
+    const auto subset = events.extract(name);
+    variables.assign(subset.begin(), subset.end());
+  }
+  const double *tofKeys = nullptr;
+  const int64_t *pulseTimeKeys = nullptr;
+  std::vector<double *> doubleColumns;
+  std::vector<int64_t *> intColumns;
+  for (auto &var : variables) {
+    if (!var.dimensions().contains(Dimension::Event))
+      continue;
+    if (var.valueTypeIs<Data::PulseTime>()) {
+      intColumns.push_back(var.get<Data::PulseTime>().data());
+      if (key == tag_id<Data::PulseTime>)
+        pulseTimeKeys = intColumns.back();
+    } else {
+      // All other supported event variables are of type double.
+      doubleColumns.push_back(var.valueTypeIs<Data::Tof>()
+                                  ? var.get<Data::Tof>().data()
+                              : var.valueTypeIs<Data::Weight>()
+                                  ? var.get<Data::Weight>().data()
+                                  : var.get<Data::WeightVariance>().data());
+      if (key == tag_id<Data::Tof> && var.valueTypeIs<Data::Tof>())
+        tofKeys = doubleColumns.back();
+    }
+    var.setSortedBy(key);
+  }
+
+  forEachSpectrumChunk(
+      offsets, [&](const gsl::index firstSpectrum,
+                   const gsl::index lastSpectrum) {
+        SortBuffers buffers;
+        for (auto spectrum = firstSpectrum; spectrum < lastSpectrum;
+             ++spectrum) {
+          const auto first = offsets[spectrum];
+          const auto size = offsets[spectrum + 1] - first;
+          if (size < 2)
+            continue;
+          const auto *permutation =
+              tofKeys ? sortPermutation(tofKeys + first, size, buffers)
+                      : sortPermutation(pulseTimeKeys + first, size, buffers);
+          for (auto *column : doubleColumns)
+            permute(column + first, permutation, size, buffers.doubles);
+          for (auto *column : intColumns)
+            permute(column + first, permutation, size, buffers.ints);
+        }
+      });
+
+  for (auto &var : variables)
+    events.insert(std::move(var));
+}
+
+CompactEvents::CompactEvents(Dimensions dimensions, Vector<int64_t> pulseTimes,
+                             Vector<gsl::index> pulseOffsets,
+                             Vector<Pulse> pulses, Vector<double> tof,
+                             Vector<float> floatTof)
+    : m_dimensions(std::move(dimensions)), m_pulseTimes(std::move(pulseTimes)),
+      m_pulseOffsets(std::move(pulseOffsets)), m_pulses(std::move(pulses)),
+      m_tof(std::move(tof)), m_floatTof(std::move(floatTof)) {
+  const auto offsets = ::eventOffsets(m_dimensions);
+  if (m_pulseOffsets.size() != offsets.size() ||
+      m_pulseOffsets.back() != static_cast<gsl::index>(m_pulses.size()) ||
+      m_tof.size() + m_floatTof.size() != m_dimensions.volume())
+    throw std::runtime_error("Inconsistent sizes of compressed events.");
+}
+
+CompactEvents compress(const Dataset &events, const std::string &name,
+                       const bool floatTof) {
+  for (const auto &var : events)
+    if (var.name() == name && (var.valueTypeIs<Data::Weight>() ||
+                               var.valueTypeIs<Data::WeightVariance>()))
+      throw std::runtime_error("Cannot compress weighted events.");
+  const auto &dims = events.dimensions<Data::Tof>(name);
+  const auto offsets = eventOffsets(dims);
+  if (!(events.dimensions<Data::PulseTime>(name) == dims))
+    throw std::runtime_error(
+        "Event variables must have the same dimensions as Data::Tof.");
+
+  Dataset sorted;
+  const auto &source = sortedByPulseTime(events, name, sorted);
+  const auto *pulseTimes = source.get<const Data::PulseTime>(name).data();
+  const auto *tof = source.get<const Data::Tof>(name).data();
+
+  auto pulseTable = distinctPulseTimes(pulseTimes, offsets);
+  const auto encodeSpectrum = [&](const gsl::index spectrum, auto &&emit) {
+    gsl::index previous = 0;
+    forEachPulseTime(
+        pulseTimes, offsets[spectrum], offsets[spectrum + 1],
+        [&](const int64_t pulseTime, const gsl::index begin,
+            const gsl::index end) {
+          const auto pulse = std::lower_bound(pulseTable.begin(),
+                                              pulseTable.end(), pulseTime) -
+                             pulseTable.begin();
+          encodePulse(pulse - previous, end - begin, emit);
+          previous = pulse;
+        });
+  };
+  // Count the entries of each spectrum, then encode into the final location.
+  const auto spectra = offsets.size() - 1;
+  Vector<gsl::index> pulseOffsets(spectra + 1, 0);
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum)
+      encodeSpectrum(spectrum, [&](const CompactEvents::Pulse &) {
+        ++pulseOffsets[spectrum];
+      });
+  });
+  const auto entries =
+      parallel::exclusiveScan(pulseOffsets.size(), pulseOffsets.data());
+  Vector<CompactEvents::Pulse> pulses(entries);
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum) {
+      auto *entry = pulses.data() + pulseOffsets[spectrum];
+      encodeSpectrum(spectrum, [&](const CompactEvents::Pulse &pulse) {
+        *entry++ = pulse;
+      });
+    }
+  });
+
+  Vector<double> doubleTof;
+  Vector<float> singleTof;
+  if (floatTof) {
+    singleTof.resize(dims.volume());
+    parallel::forEachChunk(
+        dims.volume(), [&](const gsl::index begin, const gsl::index end) {
+          for (auto i = begin; i < end; ++i)
+            singleTof[i] = static_cast<float>(tof[i]);
+        });
+  } else {
+    doubleTof.resize(dims.volume());
+    parallel::copy(dims.volume(), tof, doubleTof.data());
+  }
+  return CompactEvents(dims, std::move(pulseTable), std::move(pulseOffsets),
+                       std::move(pulses), std::move(doubleTof),
+                       std::move(singleTof));
+}
+
+Dataset decompress(const CompactEvents &events, const std::string &name) {
+  const auto &dims = events.dimensions();
+  Vector<double> tof(dims.volume());
+  if (events.hasFloatTof())
+    parallel::forEachChunk(
+        dims.volume(), [&](const gsl::index begin, const gsl::index end) {
+          std::copy(events.floatTof().begin() + begin,
+                    events.floatTof().begin() + end, tof.begin() + begin);
+        });
+  else
+    parallel::copy(dims.volume(), events.tof().begin(), tof.begin());
+  Vector<int64_t> pulseTimes(dims.volume());
+  forEachSpectrumChunk(
+      events.eventOffsets(),
+      [&](const gsl::index firstSpectrum, const gsl::index lastSpectrum) {
+        for (auto spectrum = firstSpectrum; spectrum < lastSpectrum;
+             ++spectrum)
+          events.forEachPulse(spectrum, [&](const int64_t pulseTime,
+                                            const gsl::index begin,
+                                            const gsl::index end) {
+            std::fill(pulseTimes.begin() + begin, pulseTimes.begin() + end,
+                      pulseTime);
+          });
+      });
+
+  Dataset result;
+  auto tofVariable = makeVariable<Data::Tof>(dims, std::move(tof));
+  auto pulseTimeVariable =
+      makeVariable<Data::PulseTime>(dims, std::move(pulseTimes));
+  for (auto *var : {&tofVariable, &pulseTimeVariable}) {
+    var->setName(name);
+    var->setSortedBy(tag_id<Data::PulseTime>);
+    result.insert(std::move(*var));
+  }
+  return result;
+}
+
+Dataset histogram(const CompactEvents &events, const std::string &name,
+                  const Variable &edges) {
+  const BinIndex binIndex(edgeValues(edges));
+  const auto histogramDims =
+      histogramDimensions(events.dimensions(), binIndex.bins());
+  Vector<double> value(histogramDims.volume(), 0.0);
+  Vector<double> variance(histogramDims.volume(), 0.0);
+  if (events.hasFloatTof())
+    histogramEvents<false>(
+        EventColumns<float>{events.floatTof().data(), nullptr, nullptr},
+        events.eventOffsets(), binIndex, value.data(), variance.data());
+  else
+    histogramEvents<false>(
+        EventColumns<double>{events.tof().data(), nullptr, nullptr},
+        events.eventOffsets(), binIndex, value.data(), variance.data());
+
+  Dataset result;
+  result.insertAsEdge(Dimension::Tof, edges);
+  result.insert<Data::Value>(name, histogramDims, std::move(value));
+  result.insert<Data::Variance>(name, histogramDims, std::move(variance));
+  return result;
+}
+
+Variable timeIntervals(const Dataset &log, const std::string &name,
+                       const double min, const double max) {
+  const auto times = log.get<const Coord::Time>();
+  const auto values = log.get<const Data::Value>(name);
+  if (log.dimensions<Coord::Time>().count() != 1 ||
+      !(log.dimensions<Data::Value>(name) == log.dimensions<Coord::Time>()))
+    throw std::runtime_error(
+        "Log must be a one-dimensional time series of values.");
+  if (!std::is_sorted(times.begin(), times.end()))
+    throw std::runtime_error("Times of log must be ascending.");
+
+  Vector<Interval> intervals;
+  for (gsl::index i = 0; i < times.size(); ++i) {
+    if (!(values[i] >= min && values[i] <= max))
+      continue;
+    const auto end = i + 1 < times.size()
+                         ? times[i + 1]
+                         : std::numeric_limits<int64_t>::max();
+    if (!intervals.empty() && intervals.back().second == times[i])
+      intervals.back().second = end;
+    else if (times[i] < end)
+      intervals.emplace_back(times[i], end);
+  }
+  const auto size = static_cast<gsl::index>(intervals.size());
+  return makeVariable<Coord::TimeInterval>({Dimension::Time, size},
+                                           std::move(intervals));
+}
+
+Dataset filterEvents(const Dataset &events, const std::string &name,
+                     const Variable &intervals) {
+  const auto values = intervalValues(intervals);
+  checkEventVariables(events, name, events.dimensions<Data::Tof>(name),
+                      "filter");
+  Dataset sorted;
+  const auto &source = sortedByPulseTime(events, name, sorted);
+  const auto offsets = eventOffsets(source.dimensions<Data::Tof>(name));
+  const auto *pulseTimes = source.get<const Data::PulseTime>(name).data();
+  return selectEvents(
+      events, source, name, [&](const gsl::index spectrum, auto &&f) {
+        forEachInterval(pulseTimes, offsets[spectrum], offsets[spectrum + 1],
+                        values,
+                        [&](const gsl::index, const gsl::index begin,
+                            const gsl::index end) { f(begin, end); });
+      });
+}
+
+std::vector<Dataset> splitEvents(const Dataset &events,
+                                 const std::string &name,
+                                 const Variable &intervals) {
+  const auto values = intervalValues(intervals);
+  checkEventVariables(events, name, events.dimensions<Data::Tof>(name),
+                      "split");
+  Dataset sorted;
+  const auto &source = sortedByPulseTime(events, name, sorted);
+  const auto offsets = eventOffsets(source.dimensions<Data::Tof>(name));
+  const auto *pulseTimes = source.get<const Data::PulseTime>(name).data();
+  std::vector<Dataset> result;
+  for (gsl::index i = 0; i < values.size(); ++i)
+    result.push_back(selectEvents(
+        events, source, name, [&](const gsl::index spectrum, auto &&f) {
+          const auto *time = pulseTimes + offsets[spectrum];
+          const auto *end = pulseTimes + offsets[spectrum + 1];
+          const auto less = std::less<int64_t>();
+          const auto *begin = std::lower_bound(time, end, values[i].first);
+          end = gallop(begin, end, values[i].second, less);
+          if (begin != end)
+            f(begin - pulseTimes, end - pulseTimes);
+        }));
+  return result;
+}
+
+CompactEvents filterEvents(const CompactEvents &events,
+                           const Variable &intervals) {
+  // Pulses are either kept with all their events or dropped.
+  const auto &pulseTimes = events.pulseTimes();
+  Vector<char> keep(pulseTimes.size(), 0);
+  forEachInterval(pulseTimes.data(), 0, pulseTimes.size(),
+                  intervalValues(intervals),
+                  [&](const gsl::index, const gsl::index begin,
+                      const gsl::index end) {
+                    std::fill(keep.begin() + begin, keep.begin() + end, 1);
+                  });
+
+  // Calls `emit(entry, event)` for each entry of the pulse index of `spectrum`
+  // after filtering, with `event` the first of its events before filtering.
+  const auto offsets = events.eventOffsets();
+  const auto encodeSpectrum = [&](const gsl::index spectrum, auto &&emit) {
+    gsl::index pulse = 0;
+    gsl::index previous = 0;
+    auto event = offsets[spectrum];
+    for (const auto &entry : events.pulses(spectrum)) {
+      pulse += entry.delta;
+      if (keep[pulse] && entry.events != 0) {
+        auto first = event;
+        encodePulse(pulse - previous, entry.events,
+                    [&](const CompactEvents::Pulse &encoded) {
+                      emit(encoded, first);
+                      first += encoded.events;
+                    });
+        previous = pulse;
+      }
+      event += entry.events;
+    }
+  };
+
+  const auto spectra = events.spectra();
+  Vector<gsl::index> pulseOffsets(spectra + 1, 0);
+  Vector<gsl::index> counts(spectra, 0);
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum)
+      encodeSpectrum(spectrum, [&](const CompactEvents::Pulse &entry,
+                                   const gsl::index) {
+        ++pulseOffsets[spectrum];
+        counts[spectrum] += entry.events;
+      });
+  });
+  const auto entries =
+      parallel::exclusiveScan(pulseOffsets.size(), pulseOffsets.data());
+  const auto dims = eventDimensions(makeVariable<Data::DimensionSize>(
+      events.dimensions().raggedSize(0).dimensions(), std::move(counts)));
+  const auto selectedOffsets = dims.raggedOffsets(0);
+
+  Vector<CompactEvents::Pulse> pulses(entries);
+  Vector<double> tof(events.hasFloatTof() ? 0 : dims.volume());
+  Vector<float> floatTof(events.hasFloatTof() ? dims.volume() : 0);
+  forEachSpectrumChunk(offsets, [&](const gsl::index firstSpectrum,
+                                    const gsl::index lastSpectrum) {
+    for (auto spectrum = firstSpectrum; spectrum < lastSpectrum; ++spectrum) {
+      auto *entry = pulses.data() + pulseOffsets[spectrum];
+      auto target = selectedOffsets[spectrum];
+      encodeSpectrum(spectrum, [&](const CompactEvents::Pulse &pulse,
+                                   const gsl::index first) {
+        *entry++ = pulse;
+        if (events.hasFloatTof())
+          std::copy_n(events.floatTof().begin() + first, pulse.events,
+                      floatTof.begin() + target);
+        else
+          std::copy_n(events.tof().begin() + first, pulse.events,
+                      tof.begin() + target);
+        target += pulse.events;
+      });
+    }
+  });
+  return CompactEvents(dims, pulseTimes, std::move(pulseOffsets),
+                       std::move(pulses), std::move(tof), std::move(floatTof));
+}
@@ -0,0 +1,151 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "dataset.h"
+
+// Events are stored in a Dataset as separate variables sharing the same name,
+// one for each event property (structure of arrays). Their dimensions are
+// given by eventDimensions(), with Dimension::Event as the innermost ragged
+// dimension, i.e., the events of all spectra are in a single contiguous array:
+// - Data::Tof, time-of-flight of each event (required),
+// - Data::PulseTime, time of the neutron pulse of each event (optional),
+// - Data::Weight and Data::WeightVariance (optional, but both or neither).
+// Events without weights count as 1 with variance 1.
+
+/// Returns the dimensions of event data given the number of events for each
+/// spectrum, a Data::DimensionSize variable, typically with dimension
+/// Dimension::Spectrum.
+Dimensions eventDimensions(const Variable &eventCounts);
+
+/// Returns a histogram of the events with name `name` against the bin edges
+/// `edges`, a one-dimensional Coord::Tof variable with dimension
+/// Dimension::Tof. The result contains the edges and Data::Value and
+/// Data::Variance with given name. Variables in `events` that do not depend on
+/// Dimension::Event, e.g., Coord::SpectrumNumber, are copied into the result.
+/// Events outside the range of the edges are ignored.
+Dataset histogram(const Dataset &events, const std::string &name,
+                  const Variable &edges);
+
+namespace detail {
+void sortEvents(Dataset &events, const std::string &name, const uint16_t key);
+}
+
+/// Sorts the events with name `name` within each spectrum by `Tag`, which is
+/// Data::Tof or Data::PulseTime. All event variables with that name are
+/// permuted accordingly and flagged as sorted, see Variable::isSortedBy. Does
+/// nothing if the events are flagged as sorted already.
+template <class Tag> void sortEvents(Dataset &events, const std::string &name) {
+  static_assert(std::is_same<Tag, Data::Tof>::value ||
+                    std::is_same<Tag, Data::PulseTime>::value,
+                "Events can be sorted only by Data::Tof or Data::PulseTime.");
+  detail::sortEvents(events, name, tag_id<Tag>);
+}
+
+/// Compressed events, see compress(). Instead of a pulse time for each event,
+/// the pulse times of all pulses are stored once. For each spectrum there is
+/// one entry for each pulse with events, giving the number of pulses since the
+/// previous entry (delta encoding of the pulse index) and the number of
+/// events. Time-of-flight is stored as double or, optionally, as float. This
+/// is not a Dataset, since a Dataset supports only a single ragged dimension.
+class CompactEvents {
+public:
+  /// Entry of the pulse index. Gaps of more than 65535 pulses and pulses with
+  /// more than 65535 events are represented by several entries.
+  struct Pulse {
+    uint16_t delta;
+    uint16_t events;
+  };
+
+  CompactEvents(Dimensions dimensions, Vector<int64_t> pulseTimes,
+                Vector<gsl::index> pulseOffsets, Vector<Pulse> pulses,
+                Vector<double> tof, Vector<float> floatTof);
+
+  /// Dimensions of the events, as for event variables in a Dataset.
+  const Dimensions &dimensions() const { return m_dimensions; }
+  gsl::index spectra() const { return m_pulseOffsets.size() - 1; }
+  gsl::span<const gsl::index> eventOffsets() const {
+    return m_dimensions.raggedOffsets(Dimension::Event);
+  }
+  /// Times of all pulses, ascending.
+  const Vector<int64_t> &pulseTimes() const { return m_pulseTimes; }
+  gsl::span<const Pulse> pulses(const gsl::index spectrum) const {
+    return gsl::make_span(m_pulses.data() + m_pulseOffsets[spectrum],
+                          m_pulseOffsets[spectrum + 1] -
+                              m_pulseOffsets[spectrum]);
+  }
+  const Vector<Pulse> &pulses() const { return m_pulses; }
+  bool hasFloatTof() const { return m_tof.empty() && !m_floatTof.empty(); }
+  const Vector<double> &tof() const { return m_tof; }
+  const Vector<float> &floatTof() const { return m_floatTof; }
+
+  /// Calls `f(pulseTime, begin, end)` for each pulse of `spectrum` with
+  /// events, with [begin, end) the range of its events.
+  template <class F>
+  void forEachPulse(const gsl::index spectrum, F &&f) const {
+    gsl::index pulse = 0;
+    auto event = eventOffsets()[spectrum];
+    for (const auto &entry : pulses(spectrum)) {
+      pulse += entry.delta;
+      if (entry.events != 0)
+        f(m_pulseTimes[pulse], event, event + entry.events);
+      event += entry.events;
+    }
+  }
+
+private:
+  Dimensions m_dimensions;
+  Vector<int64_t> m_pulseTimes;
+  Vector<gsl::index> m_pulseOffsets;
+  Vector<Pulse> m_pulses;
+  Vector<double> m_tof;
+  Vector<float> m_floatTof;
+};
+
+/// Returns the events with name `name` in compressed form. The events must not
+/// be weighted. Time-of-flight is converted to float if `floatTof` is true.
+CompactEvents compress(const Dataset &events, const std::string &name,
+                       const bool floatTof = false);
+/// Returns a Dataset with the events in `events` as variables Data::Tof and
+/// Data::PulseTime with name `name`, sorted by pulse time.
+Dataset decompress(const CompactEvents &events, const std::string &name);
+/// Returns a histogram of compressed events, see histogram(const Dataset &,
+/// const std::string &, const Variable &). Events are not decompressed.
+Dataset histogram(const CompactEvents &events, const std::string &name,
+                  const Variable &edges);
+
+/// Returns the intervals of time in which the value of the log `name` lies in
+/// [min, max]. The log `log` is a time series given by Coord::Time, in
+/// ascending order, and Data::Value with name `name`. Each value is valid from
+/// its time until the time of the next value, the last value is valid
+/// indefinitely. The result is a Coord::TimeInterval variable with dimension
+/// Dimension::Time, containing sorted and disjoint half-open intervals.
+Variable timeIntervals(const Dataset &log, const std::string &name,
+                       const double min, const double max);
+
+/// Returns the events with name `name` with a pulse time in one of the
+/// `intervals`, sorted and disjoint half-open intervals as returned by
+/// timeIntervals. The events in the result are sorted by pulse time. Variables
+/// in `events` that do not depend on Dimension::Event are copied into the
+/// result, event variables with a different name are dropped.
+Dataset filterEvents(const Dataset &events, const std::string &name,
+                     const Variable &intervals);
+/// Returns the events with name `name` in each of the `intervals`, as
+/// filterEvents with each interval separately.
+std::vector<Dataset> splitEvents(const Dataset &events, const std::string &name,
+                                 const Variable &intervals);
+/// Returns the compressed events with a pulse time in one of the `intervals`,
+/// see filterEvents. Works on whole pulses, without decompressing events.
+CompactEvents filterEvents(const CompactEvents &events,
+                           const Variable &intervals);
+
+#endif // EVENTS_H
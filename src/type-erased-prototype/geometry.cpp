@@ -0,0 +1,81 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <cmath>
+
+#include "geometry.h"
+#include "parallel.h"
+
+namespace geometry {
+namespace {
+/// Returns `op(x, y, z)` for each detector, with the components of the
+/// position relative to `origin`. The loop reads the three components as
+/// contiguous arrays, there is no gather of 3-vectors.
+template <class Op>
+Vector<double> transform(const PositionColumn &positions,
+                         const Position &origin, Op op) {
+  Vector<double> out(positions.size());
+  parallel::forEachChunk(
+      positions.size(), [&](const gsl::index begin, const gsl::index end) {
+        // Pointers in locals, otherwise the compiler cannot prove that writing
+        // the result does not modify them, which prevents vectorization.
+        const double *x = positions.x().data();
+        const double *y = positions.y().data();
+        const double *z = positions.z().data();
+        double *result = out.data();
+        const double x0 = origin[0];
+        const double y0 = origin[1];
+        const double z0 = origin[2];
+        for (auto i = begin; i < end; ++i)
+          result[i] = op(x[i] - x0, y[i] - y0, z[i] - z0);
+      });
+  return out;
+}
+}
+
+Vector<double> l2(const PositionColumn &positions, const Position &sample) {
+  return transform(positions, sample,
+                   [](const double x, const double y, const double z) {
+                     return std::sqrt(x * x + y * y + z * z);
+                   });
+}
+
+Vector<double> twoTheta(const PositionColumn &positions,
+                        const Position &source, const Position &sample) {
+  double beam[3];
+  for (gsl::index i = 0; i < 3; ++i)
+    beam[i] = sample[i] - source[i];
+  const double norm =
+      std::sqrt(beam[0] * beam[0] + beam[1] * beam[1] + beam[2] * beam[2]);
+  for (auto &component : beam)
+    component /= norm;
+  return transform(
+      positions, sample,
+      [bx = beam[0], by = beam[1], bz = beam[2]](
+          const double x, const double y, const double z) {
+        const double cosTwoTheta =
+            (x * bx + y * by + z * bz) / std::sqrt(x * x + y * y + z * z);
+        // Clamp rounding errors for detectors close to the beam axis.
+        return std::acos(std::min(1.0, std::max(-1.0, cosTwoTheta)));
+      });
+}
+
+Vector<double> azimuth(const PositionColumn &positions,
+                       const Position &sample) {
+  return transform(positions, sample,
+                   [](const double x, const double y, const double) {
+                     return std::atan2(y, x);
+                   });
+}
+
+Vector<double> solidAngle(const PositionColumn &positions,
+                          const Position &sample, const double area) {
+  return transform(positions, sample,
+                   [area](const double x, const double y, const double z) {
+                     return area / (x * x + y * y + z * z);
+                   });
+}
+}
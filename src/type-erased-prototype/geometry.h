@@ -0,0 +1,40 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include "position_column.h"
+#include "vector.h"
+
+/// Batch computation of instrument geometry from Coord::DetectorPosition,
+/// Coord::SamplePosition, and Coord::SourcePosition, in the conventions of
+/// Mantid: the beam travels along z, y points up.
+///
+/// Each function processes the x, y, and z components of all detectors as
+/// separate contiguous arrays, see PositionColumn, such that the arithmetic is
+/// vectorized by the compiler.
+namespace geometry {
+/// Returns the distance of each detector from the sample.
+Vector<double> l2(const PositionColumn &positions, const Position &sample);
+
+/// Returns the scattering angle 2theta of each detector, i.e., the angle
+/// between the incident beam from `source` to `sample` and the direction from
+/// `sample` to the detector.
+Vector<double> twoTheta(const PositionColumn &positions,
+                        const Position &source, const Position &sample);
+
+/// Returns the azimuthal angle of each detector around the beam, in the range
+/// [-pi, pi], measured from the x axis.
+Vector<double> azimuth(const PositionColumn &positions, const Position &sample);
+
+/// Returns the solid angle in steradian covered by each detector, in the
+/// approximation of a small flat detector of the given `area` facing the
+/// sample.
+Vector<double> solidAngle(const PositionColumn &positions,
+                          const Position &sample, const double area);
+}
+
+#endif // GEOMETRY_H
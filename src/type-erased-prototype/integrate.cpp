@@ -0,0 +1,173 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <stdexcept>
+
+#include "integrate.h"
+#include "parallel.h"
+
+namespace {
+Dimensions withoutTof(Dimensions dims) {
+  dims.erase(Dimension::Tof);
+  return dims;
+}
+
+/// Returns the cumulative sum at `x`, interpolated linearly within the bin
+/// containing `x`, i.e., counts are distributed uniformly within each bin.
+/// Positions outside the bin edges give the sum at the first or last edge.
+double interpolate(const double *edges, const double *sums,
+                   const gsl::index bins, const double x) {
+  const auto k = std::upper_bound(edges, edges + bins + 1, x) - edges - 1;
+  if (k < 0)
+    return sums[0];
+  if (k >= bins)
+    return sums[bins];
+  return sums[k] +
+         (x - edges[k]) / (edges[k + 1] - edges[k]) * (sums[k + 1] - sums[k]);
+}
+}
+
+Variable cumulativeSum(const Variable &var, const Dimension dim) {
+  auto dims = var.dimensions();
+  const auto size = dims.size(dim);
+  const auto inner = dims.offset(dim);
+  const auto outer = size * inner == 0 ? 0 : dims.volume() / (size * inner);
+  dims.resize(dim, size + 1);
+  Vector<double> sums(dims.volume());
+  const auto values = var.get<const Data::Value>().data();
+
+  if (outer == 1 && inner == 1) {
+    parallel::copy(size, values, sums.data());
+    sums[size] = parallel::exclusiveScan(size, sums.data());
+  } else if (inner == 1) {
+    parallel::forEachChunk(
+        outer,
+        [&](const gsl::index begin, const gsl::index end) {
+          const auto in = values;
+          const auto out = sums.data();
+          for (auto line = begin; line < end; ++line) {
+            const auto source = in + line * size;
+            const auto target = out + line * (size + 1);
+            double sum = 0.0;
+            target[0] = sum;
+            for (gsl::index k = 0; k < size; ++k)
+              target[k + 1] = sum += source[k];
+          }
+        },
+        parallel::grainSize / (size + 1));
+  } else {
+    // Each chunk is a range of lines along `dim`. The inner loop is over
+    // neighbouring lines, which are contiguous, such that the compiler
+    // vectorizes it.
+    parallel::forEachChunk(
+        outer * inner,
+        [&](const gsl::index begin, const gsl::index end) {
+          const auto in = values;
+          const auto out = sums.data();
+          for (auto line = begin; line < end;) {
+            const auto first = line % inner;
+            const auto last = std::min(inner, first + (end - line));
+            const auto source = in + line / inner * size * inner;
+            const auto target = out + line / inner * (size + 1) * inner;
+            for (auto i = first; i < last; ++i)
+              target[i] = 0.0;
+            for (gsl::index k = 0; k < size; ++k)
+              for (auto i = first; i < last; ++i)
+                target[(k + 1) * inner + i] =
+                    target[k * inner + i] + source[k * inner + i];
+            line += last - first;
+          }
+        },
+        parallel::grainSize / (size + 1));
+  }
+  auto result = makeVariable<Data::CumulativeValue>(dims, std::move(sums));
+  result.setName(var.name());
+  result.setUnit(var.unit());
+  return result;
+}
+
+Dataset integrate(const Dataset &d, const Variable &begin,
+                  const Variable &end) {
+  const auto &windowDims = begin.dimensions();
+  if (!begin.valueTypeIs<Coord::Tof>() || !end.valueTypeIs<Coord::Tof>() ||
+      !(end.dimensions() == windowDims) || windowDims.count() == 0 ||
+      windowDims.label(0) != Dimension::Tof)
+    throw std::runtime_error("Window bounds must be Coord::Tof variables with "
+                             "equal dimensions and Dimension::Tof as inner "
+                             "dimension.");
+  if (!d.dimensions().contains(Dimension::Tof))
+    throw std::runtime_error("Dataset does not contain the dimension to "
+                             "integrate.");
+  const auto &edges = d[d.find(tag_id<Coord::Tof>, "")];
+  const auto &edgeDims = edges.dimensions();
+  const auto bins = d.dimensions().size(Dimension::Tof);
+  if (edgeDims.size(Dimension::Tof) != bins + 1)
+    throw std::runtime_error("Integration requires bin edges.");
+  const auto windows = windowDims.size(Dimension::Tof);
+  const auto edgeValues = edges.get<const Coord::Tof>().data();
+  const auto beginValues = begin.get<const Coord::Tof>().data();
+  const auto endValues = end.get<const Coord::Tof>().data();
+  const bool sharedEdges = edgeDims.count() == 1;
+  const bool sharedWindows = windowDims.count() == 1;
+
+  Dataset result;
+  for (const auto &var : d) {
+    const auto &dims = var.dimensions();
+    if (var.isCoord() && dims.contains(Dimension::Tof))
+      continue;
+    if (!dims.contains(Dimension::Tof)) {
+      result.insert(var);
+      continue;
+    }
+    if (!var.valueTypeIs<Data::Value>() && !var.valueTypeIs<Data::Variance>())
+      throw std::runtime_error("Cannot integrate variables other than "
+                               "Data::Value and Data::Variance.");
+    if (dims.label(0) != Dimension::Tof)
+      throw std::runtime_error("Data must have Dimension::Tof as inner "
+                               "dimension.");
+    const auto other = withoutTof(dims);
+    if ((!sharedEdges && !(withoutTof(edgeDims) == other)) ||
+        (!sharedWindows && !(withoutTof(windowDims) == other)))
+      throw std::runtime_error("Bin edges and window bounds depending on "
+                               "other dimensions must have the same "
+                               "dimensions as the data.");
+
+    const Variable *cache = nullptr;
+    if (var.valueTypeIs<Data::Value>())
+      cache = d.cumulativeSum(Dimension::Tof, var.name());
+    const auto sums = cache ? *cache : cumulativeSum(var, Dimension::Tof);
+    const auto sumValues = sums.get<const Data::CumulativeValue>().data();
+
+    auto resultDims = dims;
+    resultDims.resize(Dimension::Tof, windows);
+    Vector<double> values(resultDims.volume());
+    parallel::forEachChunk(
+        other.volume(),
+        [&](const gsl::index first, const gsl::index last) {
+          for (auto row = first; row < last; ++row) {
+            const auto rowEdges =
+                edgeValues + (sharedEdges ? 0 : row * (bins + 1));
+            const auto rowSums = sumValues + row * (bins + 1);
+            const auto window = sharedWindows ? 0 : row * windows;
+            for (gsl::index i = 0; i < windows; ++i)
+              values[row * windows + i] =
+                  interpolate(rowEdges, rowSums, bins,
+                              endValues[window + i]) -
+                  interpolate(rowEdges, rowSums, bins,
+                              beginValues[window + i]);
+          }
+        },
+        parallel::grainSize / (windows + 1));
+    auto integrated =
+        var.valueTypeIs<Data::Value>()
+            ? makeVariable<Data::Value>(resultDims, std::move(values))
+            : makeVariable<Data::Variance>(resultDims, std::move(values));
+    integrated.setName(var.name());
+    integrated.setUnit(var.unit());
+    result.insert(std::move(integrated));
+  }
+  return result;
+}
@@ -0,0 +1,35 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+#include "dataset.h"
+
+/// Returns the cumulative sum of `var`, a Data::Value or Data::Variance
+/// variable, along `dim` as a Data::CumulativeValue variable. Its dimensions
+/// are those of `var` with `dim` longer by one, like bin edges: element k along
+/// `dim` is the sum of the elements [0, k) of `var`. The sum over any range
+/// [i, j) is thus the difference of two elements. Lines along `dim` are summed
+/// in parallel, a single line with a parallel prefix sum.
+Variable cumulativeSum(const Variable &var, const Dimension dim);
+
+/// Returns the integrals of the histograms of `d` over windows [begin, end)
+/// along Dimension::Tof, e.g., for peak integration. `begin` and `end` are
+/// Coord::Tof variables with the N windows along Dimension::Tof as inner
+/// dimension and otherwise either no dimensions, i.e., the same windows for all
+/// histograms, or the other dimensions of the data. Data::Value and
+/// Data::Variance are integrated and hold one element per window along
+/// Dimension::Tof. A bin partially covered by a window contributes the covered
+/// fraction of its value and variance, as in rebin. Coordinates depending on
+/// Dimension::Tof are dropped, other variables not depending on it are copied.
+///
+/// The window bounds are located in the bin edges Coord::Tof by binary search,
+/// and each integral is the difference of the cumulative sums at the bounds.
+/// Cumulative sums of Data::Value are taken from the cache if enabled, see
+/// Dataset::enableCumulativeSum, and are otherwise computed for each call.
+Dataset integrate(const Dataset &d, const Variable &begin, const Variable &end);
+
+#endif // INTEGRATE_H
@@ -0,0 +1,164 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef LIST_COLUMN_H
+#define LIST_COLUMN_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include <gsl/gsl_util>
+#include <gsl/span>
+
+#include "column_span.h"
+#include "vector.h"
+
+/// Column of variable-length lists in compressed sparse row (CSR) form: all
+/// items are stored in a single buffer, element i is the range [offsets[i],
+/// offsets[i+1]) of that buffer. Compared to Vector<std::vector<T>> this avoids
+/// an allocation per element, and copying is two memcpy. The layout is that of
+/// Arrow's large list (and large UTF-8) arrays.
+///
+/// `View` is the type used to read an element, constructible from a pointer and
+/// a size, `Value` is the corresponding owning type.
+///
+/// Assigning an element with a different length than the old one moves all
+/// subsequent items, i.e., bulk modification should rather build a new column
+/// via push_back or the iterator-range constructor.
+template <class T, class View, class Value> class ListColumn {
+public:
+  using value_type = Value;
+  using const_reference = View;
+  using reference = ColumnReference<ListColumn>;
+  using const_iterator = ColumnIterator<const ListColumn>;
+  using iterator = ColumnIterator<ListColumn>;
+
+  ListColumn() : m_offsets(1, 0) {}
+  explicit ListColumn(const gsl::index size) : m_offsets(size + 1, 0) {}
+  template <class InputIt> ListColumn(InputIt first, InputIt last);
+  template <class U>
+  ListColumn(std::initializer_list<U> values)
+      : ListColumn(values.begin(), values.end()) {}
+  template <class U, class Allocator>
+  ListColumn(const std::vector<U, Allocator> &values)
+      : ListColumn(values.begin(), values.end()) {}
+  /// Creates a column from existing buffers, e.g., from another library. The
+  /// first offset must be zero, the last must be the size of `values`.
+  ListColumn(Vector<int64_t> offsets, Vector<T> values);
+
+  gsl::index size() const { return m_offsets.size() - 1; }
+  bool empty() const { return size() == 0; }
+  void resize(const gsl::index size);
+  void reserve(const gsl::index size, const gsl::index items) {
+    m_offsets.reserve(size + 1);
+    m_values.reserve(items);
+  }
+
+  const_reference operator[](const gsl::index i) const {
+    return const_reference(m_values.data() + m_offsets[i],
+                           m_offsets[i + 1] - m_offsets[i]);
+  }
+  reference operator[](const gsl::index i) { return {*this, i}; }
+
+  const_iterator begin() const { return {*this, 0}; }
+  const_iterator end() const { return {*this, size()}; }
+  iterator begin() { return {*this, 0}; }
+  iterator end() { return {*this, size()}; }
+
+  void assign(const gsl::index i, const_reference value);
+  void push_back(const_reference value);
+
+  const Vector<int64_t> &offsets() const { return m_offsets; }
+  const Vector<T> &values() const { return m_values; }
+
+  bool operator==(const ListColumn &other) const {
+    return m_offsets == other.m_offsets && m_values == other.m_values;
+  }
+  bool operator!=(const ListColumn &other) const { return !(*this == other); }
+
+private:
+  bool overlaps(const_reference value) const {
+    return value.data() >= m_values.data() &&
+           value.data() < m_values.data() + m_values.size();
+  }
+
+  Vector<int64_t> m_offsets;
+  Vector<T> m_values;
+};
+
+template <class T, class View, class Value>
+template <class InputIt>
+ListColumn<T, View, Value>::ListColumn(InputIt first, InputIt last)
+    : ListColumn() {
+  for (; first != last; ++first)
+    push_back(*first);
+}
+
+template <class T, class View, class Value>
+ListColumn<T, View, Value>::ListColumn(Vector<int64_t> offsets,
+                                       Vector<T> values)
+    : m_offsets(std::move(offsets)), m_values(std::move(values)) {
+  if (m_offsets.empty() || m_offsets.front() != 0 ||
+      m_offsets.back() != static_cast<int64_t>(m_values.size()))
+    throw std::runtime_error("Offsets do not match buffer size.");
+  if (!std::is_sorted(m_offsets.begin(), m_offsets.end()))
+    throw std::runtime_error("Offsets must be non-decreasing.");
+}
+
+template <class T, class View, class Value>
+void ListColumn<T, View, Value>::resize(const gsl::index size) {
+  if (size < this->size()) {
+    m_offsets.resize(size + 1);
+    m_values.resize(m_offsets.back());
+  } else {
+    m_offsets.resize(size + 1, m_offsets.back());
+  }
+}
+
+template <class T, class View, class Value>
+void ListColumn<T, View, Value>::assign(const gsl::index i,
+                                        const_reference value) {
+  // `value` may point into m_values, which is invalidated by insert/erase.
+  if (overlaps(value)) {
+    const Value copy(value.begin(), value.end());
+    assign(i, const_reference(copy.data(), copy.size()));
+    return;
+  }
+  const auto begin = m_offsets[i];
+  const auto delta =
+      static_cast<int64_t>(value.size()) - (m_offsets[i + 1] - begin);
+  if (delta > 0)
+    m_values.insert(m_values.begin() + m_offsets[i + 1], delta, T{});
+  else
+    m_values.erase(m_values.begin() + m_offsets[i + 1] + delta,
+                   m_values.begin() + m_offsets[i + 1]);
+  std::copy(value.begin(), value.end(), m_values.begin() + begin);
+  // Nothing to do in the common case of fixed-width elements.
+  if (delta != 0)
+    for (auto it = m_offsets.begin() + i + 1; it != m_offsets.end(); ++it)
+      *it += delta;
+}
+
+template <class T, class View, class Value>
+void ListColumn<T, View, Value>::push_back(const_reference value) {
+  // `value` may point into m_values, append via a copy if that is the case.
+  if (overlaps(value)) {
+    const Value copy(value.begin(), value.end());
+    push_back(const_reference(copy.data(), copy.size()));
+    return;
+  }
+  m_values.insert(m_values.end(), value.begin(), value.end());
+  m_offsets.push_back(m_values.size());
+}
+
+/// Lists of indices, e.g., the detectors of each spectrum in
+/// Coord::DetectorGrouping.
+using IndexListColumn = ListColumn<gsl::index, gsl::span<const gsl::index>,
+                                   std::vector<gsl::index>>;
+
+#endif // LIST_COLUMN_H
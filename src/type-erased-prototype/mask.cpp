@@ -0,0 +1,151 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "mask.h"
+#include "parallel.h"
+
+namespace {
+bool isFloatingPoint(const Variable &var) {
+  bool result = false;
+  callForTag(var.type(), [&](auto tag) {
+    using Tag = decltype(tag);
+    result = std::is_same<storage_t<Tag>, Vector<double>>::value;
+  });
+  return result;
+}
+
+/// Returns the number of contiguous elements of `var` covered by each flag of
+/// `mask`, after checking that the mask can be applied to `var`.
+gsl::index maskBlock(const Variable &var, const Variable &mask) {
+  if (!isFloatingPoint(var))
+    throw std::runtime_error("Masked operations require variables of "
+                             "floating-point values.");
+  if (!mask.valueTypeIs<Coord::Mask>())
+    throw std::runtime_error("Mask must be a Coord::Mask variable.");
+  const auto &dims = var.dimensions();
+  const auto &maskDims = mask.dimensions();
+  const auto offset = dims.count() - maskDims.count();
+  bool outer = offset >= 0 && !dims.isRagged() && !maskDims.isRagged();
+  for (gsl::index i = 0; outer && i < maskDims.count(); ++i)
+    outer = dims.label(offset + i) == maskDims.label(i) &&
+            dims.size(offset + i) == maskDims.size(i);
+  if (!outer)
+    throw std::runtime_error("Mask dimensions must be the outer dimensions of "
+                             "the variable.");
+  return maskDims.volume() == 0 ? 0 : dims.volume() / maskDims.volume();
+}
+
+/// Returns `a` unchanged, for applyMask.
+struct Keep {
+  double operator()(const double a, const double) const { return a; }
+};
+
+/// Writes `out[i] = op(a[i], b[i])` for the elements not masked by `mask`,
+/// whose flags each cover `block` elements. Masked elements are set to zero if
+/// `zeroMasked` is true, else to `a[i]`, in which case words of 64 masked
+/// blocks are skipped without touching the data. Threads work on ranges of
+/// words. For words with some flags set and `block` 1 the flags are blended
+/// element-wise with a select that the compiler vectorizes, for larger blocks
+/// each block is either skipped or processed as a whole.
+template <class Op>
+void maskedTransform(const MaskColumn &mask, const gsl::index block,
+                     const gsl::index size, const double *a, const double *b,
+                     double *out, const bool zeroMasked, const Op op) {
+  const auto &words = mask.words();
+  const auto wordSize = mask::bitsPerWord * block;
+  const auto apply = [&](const gsl::index begin, const gsl::index end) {
+    for (auto i = begin; i < end; ++i)
+      out[i] = op(a[i], b[i]);
+  };
+  const auto skip = [&](const gsl::index begin, const gsl::index end) {
+    if (zeroMasked)
+      std::fill(out + begin, out + end, 0.0);
+    else if (out != a)
+      std::copy(a + begin, a + end, out + begin);
+  };
+  parallel::forEachChunk(
+      words.size(),
+      [&](const gsl::index first, const gsl::index last) {
+        for (auto w = first; w < last; ++w) {
+          const auto word = words[w];
+          const auto begin = w * wordSize;
+          const auto end = std::min(size, begin + wordSize);
+          if (word == 0) {
+            apply(begin, end);
+          } else if (word == ~uint64_t{0}) {
+            skip(begin, end);
+          } else if (block == 1) {
+            for (auto i = begin; i < end; ++i) {
+              const auto masked = (word >> (i - begin)) & 1;
+              out[i] = masked ? (zeroMasked ? 0.0 : a[i]) : op(a[i], b[i]);
+            }
+          } else {
+            for (auto i = begin; i < end; i += block)
+              if ((word >> ((i - begin) / block)) & 1)
+                skip(i, i + block);
+              else
+                apply(i, i + block);
+          }
+        }
+      },
+      std::max(gsl::index{1}, parallel::grainSize / std::max(gsl::index{1},
+                                                             wordSize)));
+}
+
+template <class Op>
+Variable &maskedApply(Variable &a, const Variable &b, const Variable &mask,
+                      const Op op) {
+  if (!(a.dimensions() == b.dimensions()) || !isFloatingPoint(b))
+    throw std::runtime_error("Masked operations require operands with equal "
+                             "dimensions.");
+  const auto block = maskBlock(a, mask);
+  // Obtain the input before the output, which may trigger a copy of `a`.
+  const auto in = b.get<const Data::Value>();
+  const auto out = a.get<Data::Value>();
+  maskedTransform(mask.get<const Coord::Mask>().column(), block, out.size(),
+                  out.data(), in.data(), out.data(), false, op);
+  return a;
+}
+}
+
+Variable applyMask(const Variable &var, const Variable &mask) {
+  const auto block = maskBlock(var, mask);
+  const auto in = var.get<const Data::Value>();
+  auto result(var);
+  // Replace rather than copy-on-write the data shared with `var`, which would
+  // copy it only to overwrite it.
+  result.setDimensions(Dimensions{});
+  result.setDimensions(var.dimensions());
+  const auto out = result.get<Data::Value>();
+  maskedTransform(mask.get<const Coord::Mask>().column(), block, in.size(),
+                  in.data(), in.data(), out.data(), true, Keep{});
+  return result;
+}
+
+Variable &maskedPlusEquals(Variable &a, const Variable &b,
+                           const Variable &mask) {
+  if (a.unit() != b.unit())
+    throw std::runtime_error("Cannot add Variables: Units do not match.");
+  return maskedApply(a, b, mask, std::plus<double>());
+}
+
+Variable &maskedMinusEquals(Variable &a, const Variable &b,
+                            const Variable &mask) {
+  if (a.unit() != b.unit())
+    throw std::runtime_error("Cannot subtract Variables: Units do not match.");
+  return maskedApply(a, b, mask, std::minus<double>());
+}
+
+Variable &maskedTimesEquals(Variable &a, const Variable &b,
+                            const Variable &mask) {
+  maskedApply(a, b, mask, std::multiplies<double>());
+  a.setUnit(a.unit() * b.unit());
+  return a;
+}
@@ -0,0 +1,34 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef MASK_H
+#define MASK_H
+
+#include "variable.h"
+
+// Masked operations on variables of floating-point values such as Data::Value.
+// `mask` is a Coord::Mask variable whose dimensions are the outer dimensions of
+// the data, e.g., Dimension::Spectrum for data with dimensions {Tof, Spectrum},
+// or all dimensions of the data. Each flag thus covers a contiguous block of
+// elements. Masks are processed a word of 64 flags at a time: blocks of fully
+// masked words are skipped (or zeroed) without reading the data, words with
+// some flags set are blended element-wise in the same pass.
+
+/// Returns `var` with the elements masked by `mask` set to zero.
+Variable applyMask(const Variable &var, const Variable &mask);
+
+/// Adds `b` to `a`, except for the elements masked by `mask`, which keep their
+/// value. `a` and `b` must have the same dimensions.
+Variable &maskedPlusEquals(Variable &a, const Variable &b,
+                           const Variable &mask);
+/// Subtracts `b` from `a`, except for the elements masked by `mask`.
+Variable &maskedMinusEquals(Variable &a, const Variable &b,
+                            const Variable &mask);
+/// Multiplies `a` by `b`, except for the elements masked by `mask`. As for
+/// operator*=, the unit of `a` becomes the product of the units.
+Variable &maskedTimesEquals(Variable &a, const Variable &b,
+                            const Variable &mask);
+
+#endif // MASK_H
@@ -0,0 +1,157 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef MASK_COLUMN_H
+#define MASK_COLUMN_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+#include <gsl/gsl_util>
+#include <gsl/span>
+
+#include "column_span.h"
+#include "vector.h"
+
+namespace mask {
+/// Number of flags stored in one word of a MaskColumn.
+constexpr gsl::index bitsPerWord = 64;
+
+/// Returns the number of set bits of `word`.
+inline gsl::index countSet(const uint64_t word) {
+  return __builtin_popcountll(word);
+}
+
+/// Returns the position of the lowest set bit of `word`, which must not be 0.
+inline gsl::index firstSet(const uint64_t word) {
+  return __builtin_ctzll(word);
+}
+}
+
+/// Bit-packed storage for flags such as Coord::Mask, 64 flags per word. Flag i
+/// is bit i % 64 of word i / 64, which is also the layout of Arrow's boolean
+/// arrays. Bits past the end of the last word are always zero, such that words
+/// can be compared, counted, and combined without special cases. Operations
+/// over many flags work on whole words, e.g., to skip 64 masked spectra at a
+/// time. Elements are read as char (0 or 1) and cannot be written concurrently.
+class MaskColumn {
+public:
+  using value_type = char;
+  using const_reference = char;
+  using reference = ColumnReference<MaskColumn>;
+  using const_iterator = ColumnIterator<const MaskColumn>;
+  using iterator = ColumnIterator<MaskColumn>;
+
+  MaskColumn() = default;
+  explicit MaskColumn(const gsl::index size) { resize(size); }
+  MaskColumn(const gsl::index size, const char value) {
+    m_size = size;
+    m_words.assign(wordCount(size), value ? ~uint64_t{0} : 0);
+    clearTail();
+  }
+  template <class InputIt,
+            class = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  MaskColumn(InputIt first, InputIt last) {
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+  MaskColumn(std::initializer_list<char> values)
+      : MaskColumn(values.begin(), values.end()) {}
+  template <class T, class Allocator>
+  MaskColumn(const std::vector<T, Allocator> &values)
+      : MaskColumn(values.begin(), values.end()) {}
+
+  gsl::index size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  void resize(const gsl::index size) {
+    m_size = size;
+    m_words.resize(wordCount(size));
+    clearTail();
+  }
+
+  const_reference operator[](const gsl::index i) const {
+    return (m_words[i / mask::bitsPerWord] >> (i % mask::bitsPerWord)) & 1;
+  }
+  reference operator[](const gsl::index i) { return {*this, i}; }
+
+  const_iterator begin() const { return {*this, 0}; }
+  const_iterator end() const { return {*this, size()}; }
+  iterator begin() { return {*this, 0}; }
+  iterator end() { return {*this, size()}; }
+
+  void assign(const gsl::index i, const_reference value) {
+    const auto bit = uint64_t{1} << (i % mask::bitsPerWord);
+    auto &word = m_words[i / mask::bitsPerWord];
+    word = value ? word | bit : word & ~bit;
+  }
+  void push_back(const_reference value) {
+    if (m_size % mask::bitsPerWord == 0)
+      m_words.push_back(0);
+    assign(m_size++, value);
+  }
+
+  /// The words holding the flags, for word-wise operations.
+  const Vector<uint64_t> &words() const { return m_words; }
+  gsl::span<uint64_t> words() { return m_words; }
+
+  /// Returns the number of set flags.
+  gsl::index count() const {
+    gsl::index count = 0;
+    for (const auto word : m_words)
+      count += mask::countSet(word);
+    return count;
+  }
+
+  /// Calls `f(begin, end)` for each maximal range of unset flags within
+  /// [first, last), in order. Words without unset flags are skipped in one step
+  /// and words without set flags are passed over in one step, i.e., the cost is
+  /// proportional to the number of words and ranges, not flags.
+  template <class F>
+  void forEachUnsetRange(const gsl::index first, const gsl::index last,
+                         F &&f) const {
+    auto begin = next(first, last, ~uint64_t{0});
+    while (begin < last) {
+      const auto end = next(begin, last, 0);
+      f(begin, end);
+      begin = next(end, last, ~uint64_t{0});
+    }
+  }
+
+  bool operator==(const MaskColumn &other) const {
+    return m_size == other.m_size && m_words == other.m_words;
+  }
+  bool operator!=(const MaskColumn &other) const { return !(*this == other); }
+
+private:
+  static gsl::index wordCount(const gsl::index size) {
+    return (size + mask::bitsPerWord - 1) / mask::bitsPerWord;
+  }
+  void clearTail() {
+    if (m_size % mask::bitsPerWord != 0)
+      m_words.back() &=
+          (uint64_t{1} << (m_size % mask::bitsPerWord)) - uint64_t{1};
+  }
+  /// Returns the first index in [i, last) whose flag differs from the flags in
+  /// `skip`, i.e., the next unset flag for `skip` with all bits set, or `last`.
+  gsl::index next(gsl::index i, const gsl::index last,
+                  const uint64_t skip) const {
+    while (i < last) {
+      const auto shift = i % mask::bitsPerWord;
+      const auto word = (m_words[i / mask::bitsPerWord] ^ skip) >> shift;
+      if (word != 0)
+        return std::min(last, i + mask::firstSet(word));
+      i += mask::bitsPerWord - shift;
+    }
+    return last;
+  }
+
+  gsl::index m_size{0};
+  Vector<uint64_t> m_words;
+};
+
+#endif // MASK_COLUMN_H
@@ -6,9 +6,12 @@
 #ifndef MULTI_INDEX_H
 #define MULTI_INDEX_H
 
+#include <algorithm>
+
 #include <boost/container/small_vector.hpp>
 
 #include "dimensions.h"
+#include "variable.h"
 
 class MultiIndex {
 public:
@@ -20,6 +23,10 @@ public:
     if (subdimensions.size() > 4)
       throw std::runtime_error("MultiIndex supports at most 4 subindices.");
     m_dims = parentDimensions.count();
+    if (parentDimensions.isRagged()) {
+      initRagged(parentDimensions, subdimensions);
+      return;
+    }
     for (gsl::index d = 0; d < m_dims; ++d)
       m_extent[d] = parentDimensions.size(d);
 
@@ -83,6 +90,8 @@ public:
     m_fullIndex = index;
     if (m_dims == 0)
       return;
+    if (m_raggedOffsets)
+      return setRaggedIndex(index);
     auto remainder{index};
     for (int32_t d = 0; d < m_dims - 1; ++d) {
       m_coord[d] = remainder % m_extent[d];
@@ -105,6 +114,8 @@ public:
 
 private:
   void indexWrapped() {
+    if (m_raggedOffsets)
+      return raggedIndexWrapped();
     for (int i = 0; i < 4; ++i)
       m_index[i] += m_delta[4 + i];
     m_coord[0] = 0;
@@ -123,6 +134,113 @@ private:
     }
   }
 
+  // Iteration with a ragged dimension. This is supported only if it is the
+  // innermost dimension and followed by the dimensions its size depends on,
+  // e.g., Tof (ragged), Spectrum, with sizes depending on Spectrum. Subindices
+  // for variables with the ragged dimension must have the same dimensions as
+  // the parent (their index is the full index), other subindices must not
+  // depend on the ragged dimension. m_extent[0] is the size of the current row.
+  void initRagged(
+      const Dimensions &parentDimensions,
+      const boost::container::small_vector<Dimensions, 4> &subdimensions) {
+    if (!parentDimensions.isRagged(0))
+      throw std::runtime_error(
+          "MultiIndex: Ragged dimension must be the innermost dimension.");
+    const auto &dependent = parentDimensions.raggedSize(0).dimensions();
+    for (gsl::index d = 0; d < dependent.count(); ++d)
+      if (d + 1 >= m_dims ||
+          dependent.label(d) != parentDimensions.label(d + 1))
+        throw std::runtime_error("MultiIndex: Dimensions of ragged size must "
+                                 "follow the ragged dimension.");
+    m_raggedOffsets = parentDimensions.raggedOffsets(0).data();
+    m_raggedRows = dependent.volume();
+    for (gsl::index d = 1; d < m_dims; ++d)
+      m_extent[d] = parentDimensions.size(d);
+
+    m_numberOfSubindices = subdimensions.size();
+    for (gsl::index j = 0; j < m_numberOfSubindices; ++j) {
+      const auto &dimensions = subdimensions[j];
+      if (dimensions.contains(parentDimensions.label(0))) {
+        if (!(dimensions == parentDimensions))
+          throw std::runtime_error("MultiIndex: Ragged variables must have "
+                                   "the iteration dimensions.");
+        // Marks the subindex as equal to the full index.
+        m_subdims[j] = -1;
+        m_delta[j] = 1;
+        continue;
+      }
+      gsl::index factor{1};
+      gsl::index k = 0;
+      for (gsl::index i = 0; i < dimensions.count(); ++i) {
+        const auto dimension = dimensions.label(i);
+        if (parentDimensions.contains(dimension)) {
+          m_offsets[j][k] = parentDimensions.index(dimension);
+          m_factors[j][k] = factor;
+          ++k;
+        }
+        factor *= dimensions.size(i);
+      }
+      m_subdims[j] = k;
+    }
+    setIndex(0);
+  }
+
+  void setRaggedIndex(const gsl::index index) {
+    // Empty iteration space.
+    if (m_raggedRows == 0)
+      return;
+    const auto total = m_raggedOffsets[m_raggedRows];
+    const auto block = total == 0 ? 0 : index / total;
+    const auto inBlock = total == 0 ? 0 : index % total;
+    // Last row starting at or before inBlock, skipping empty rows.
+    m_raggedRow = std::upper_bound(m_raggedOffsets,
+                                   m_raggedOffsets + m_raggedRows + 1,
+                                   inBlock) -
+                  m_raggedOffsets - 1;
+    m_raggedRow = std::min(m_raggedRow, m_raggedRows - 1);
+    m_coord[0] = inBlock - m_raggedOffsets[m_raggedRow];
+    m_extent[0] =
+        m_raggedOffsets[m_raggedRow + 1] - m_raggedOffsets[m_raggedRow];
+    auto remainder = m_raggedRow + block * m_raggedRows;
+    for (int32_t d = 1; d < m_dims - 1; ++d) {
+      m_coord[d] = remainder % m_extent[d];
+      remainder /= m_extent[d];
+    }
+    if (m_dims > 1)
+      m_coord[m_dims - 1] = remainder;
+    updateRaggedSubindices(index);
+  }
+
+  void raggedIndexWrapped() {
+    // Advance to the next non-empty row.
+    do {
+      m_coord[0] = 0;
+      for (int32_t d = 1; d < m_dims; ++d) {
+        if (++m_coord[d] < m_extent[d] || d == m_dims - 1)
+          break;
+        m_coord[d] = 0;
+      }
+      if (++m_raggedRow == m_raggedRows)
+        m_raggedRow = 0;
+      m_extent[0] =
+          m_raggedOffsets[m_raggedRow + 1] - m_raggedOffsets[m_raggedRow];
+    } while (m_extent[0] == 0 && m_dims > 1 &&
+             m_coord[m_dims - 1] < m_extent[m_dims - 1]);
+    updateRaggedSubindices(m_fullIndex + 1);
+  }
+
+  void updateRaggedSubindices(const gsl::index fullIndex) {
+    for (int32_t i = 0; i < m_numberOfSubindices; ++i) {
+      if (m_subdims[i] == -1) {
+        m_index[i] = fullIndex;
+        continue;
+      }
+      m_index[i] = 0;
+      for (int32_t j = 0; j < m_subdims[i]; ++j)
+        m_index[i] += m_factors[i][j] * m_coord[m_offsets[i][j]];
+    }
+  }
+
   // alignas does not help, for some reason gcc does not generate SIMD
   // instructions.
   // Using std::array is 1.5x slower, for some reason intermediate values of
@@ -135,6 +253,9 @@ private:
   gsl::index m_fullIndex;
   int32_t m_dims;
   int32_t m_numberOfSubindices;
+  const gsl::index *m_raggedOffsets{nullptr};
+  gsl::index m_raggedRows{0};
+  gsl::index m_raggedRow{0};
   std::array<int32_t, 4> m_subdims;
   std::array<std::array<int32_t, 4>, 4> m_offsets;
   std::array<std::array<gsl::index, 4>, 4> m_factors;
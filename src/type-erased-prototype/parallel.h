@@ -0,0 +1,164 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <omp.h>
+
+#include <gsl/gsl_util>
+
+/// Thin layer on top of OpenMP, which is the thread pool used by this library.
+/// Keeping this in one place lets us swap the backend (e.g., for TBB) later.
+namespace parallel {
+/// Below this number of elements per thread the overhead of spawning threads
+/// outweighs the gain, for simple element-wise operations.
+constexpr gsl::index grainSize = 32768;
+
+/// Chunk boundaries are multiples of this, such that chunks of any element
+/// type start at an AVX-aligned address and threads do not share cache lines.
+constexpr gsl::index chunkAlignment = 64;
+
+namespace detail {
+/// Returns the range [begin, end) of [0, size) processed by `thread`.
+inline std::pair<gsl::index, gsl::index> chunk(const gsl::index size,
+                                               const gsl::index thread,
+                                               const gsl::index threads) {
+  auto chunk = (size + threads - 1) / threads;
+  chunk = (chunk + chunkAlignment - 1) / chunkAlignment * chunkAlignment;
+  const auto begin = std::min(size, thread * chunk);
+  return {begin, std::min(size, begin + chunk)};
+}
+}
+
+/// Splits [0, size) into one contiguous chunk per thread and calls
+/// `f(begin, end)` for each chunk. Runs serially if `size` is small. `f` must
+/// not throw.
+template <class F>
+void forEachChunk(const gsl::index size, F &&f,
+                  const gsl::index grain = grainSize) {
+#pragma omp parallel if (size >= 2 * grain)
+  {
+    const auto range =
+        detail::chunk(size, omp_get_thread_num(), omp_get_num_threads());
+    if (range.first != range.second)
+      f(range.first, range.second);
+  }
+}
+
+/// Calls `f(i)` for each i in [0, size), with the items distributed evenly
+/// between threads. For a small number of coarse-grained items, which
+/// forEachChunk would not split due to its chunk alignment. `f` must not
+/// throw.
+template <class F> void forEach(const gsl::index size, F &&f) {
+#pragma omp parallel for schedule(static) if (size > 1)
+  for (gsl::index i = 0; i < size; ++i)
+    f(i);
+}
+
+/// Parallel version of std::transform for random-access ranges.
+template <class In1, class In2, class Out, class Op>
+void transform(const gsl::index size, In1 in1, In2 in2, Out out, Op op) {
+  forEachChunk(size, [&](const gsl::index begin, const gsl::index end) {
+    std::transform(in1 + begin, in1 + end, in2 + begin, out + begin, op);
+  });
+}
+
+/// Parallel version of std::copy for random-access ranges.
+template <class In, class Out>
+void copy(const gsl::index size, In in, Out out) {
+  forEachChunk(size, [&](const gsl::index begin, const gsl::index end) {
+    std::copy(in + begin, in + end, out + begin);
+  });
+}
+
+/// Replaces the elements of `data` by their exclusive prefix sum, i.e.,
+/// element i becomes the sum of elements [0, i). Returns the total. Each thread
+/// sums its chunk, the chunk sums are scanned serially, and each thread then
+/// writes the prefix sum of its chunk.
+template <class T> T exclusiveScan(const gsl::index size, T *data) {
+  std::vector<T> sums(omp_get_max_threads() + 1, T{0});
+#pragma omp parallel if (size >= 2 * grainSize)
+  {
+    const gsl::index thread = omp_get_thread_num();
+    const auto range = detail::chunk(size, thread, omp_get_num_threads());
+    T sum{0};
+    for (auto i = range.first; i < range.second; ++i)
+      sum += data[i];
+    sums[thread + 1] = sum;
+#pragma omp barrier
+#pragma omp single
+    std::partial_sum(sums.begin(), sums.end(), sums.begin());
+    sum = sums[thread];
+    for (auto i = range.first; i < range.second; ++i) {
+      const auto value = data[i];
+      data[i] = sum;
+      sum += value;
+    }
+  }
+  return sums.back();
+}
+
+/// Returns the combination with `combine` of `map(begin, end)` over chunks of
+/// [0, size), one chunk per thread, i.e., a parallel std::accumulate. The
+/// partial results of the threads are combined pairwise, as a tree of depth
+/// log2(threads). `map` must not throw.
+template <class T, class Map, class Combine>
+T reduce(const gsl::index size, const T &identity, Map &&map,
+         Combine &&combine, const gsl::index grain = grainSize) {
+  std::vector<T> partials(omp_get_max_threads(), identity);
+#pragma omp parallel if (size >= 2 * grain)
+  {
+    const gsl::index thread = omp_get_thread_num();
+    const auto range = detail::chunk(size, thread, omp_get_num_threads());
+    if (range.first != range.second)
+      partials[thread] = map(range.first, range.second);
+  }
+  const gsl::index count = partials.size();
+  for (gsl::index stride = 1; stride < count; stride *= 2)
+    for (gsl::index i = 0; i + stride < count; i += 2 * stride)
+      partials[i] = combine(std::move(partials[i]), partials[i + stride]);
+  return partials.front();
+}
+
+/// Sorts [data, data + size) with `comp`, i.e., a parallel std::sort. Each
+/// thread sorts a chunk, then the sorted chunks are merged pairwise, with the
+/// merges of each level running in parallel. Not stable.
+template <class T, class Compare>
+void sort(const gsl::index size, T *data, Compare comp) {
+  const gsl::index chunks = size >= 2 * grainSize ? omp_get_max_threads() : 1;
+  std::vector<gsl::index> bounds(chunks + 1, size);
+  for (gsl::index i = 0; i < chunks; ++i)
+    bounds[i] = detail::chunk(size, i, chunks).first;
+#pragma omp parallel for schedule(static, 1) if (chunks > 1)
+  for (gsl::index i = 0; i < chunks; ++i)
+    std::sort(data + bounds[i], data + bounds[i + 1], comp);
+  for (gsl::index width = 1; width < chunks; width *= 2) {
+#pragma omp parallel for schedule(static, 1)
+    for (gsl::index i = 0; i < chunks - width; i += 2 * width)
+      std::inplace_merge(data + bounds[i], data + bounds[i + width],
+                         data + bounds[std::min(i + 2 * width, chunks)], comp);
+  }
+}
+
+/// Atomically adds `value` to `target` and returns the previous value of
+/// `target`. For counters shared between the threads of forEachChunk.
+template <class T> T fetchAdd(T &target, const T value) {
+  T previous;
+#pragma omp atomic capture
+  {
+    previous = target;
+    target += value;
+  }
+  return previous;
+}
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,104 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef POSITION_COLUMN_H
+#define POSITION_COLUMN_H
+
+#include <array>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include <gsl/gsl_util>
+#include <gsl/span>
+
+#include "column_span.h"
+#include "vector.h"
+
+/// A position or direction in 3D space, with components x, y, and z.
+using Position = std::array<double, 3>;
+
+/// Columnar storage for 3-vectors such as Coord::DetectorPosition: the x, y,
+/// and z components are stored in three separate arrays (structure of arrays).
+/// Batch operations over all elements, see geometry.h, thus read contiguous
+/// arrays of each component, which the compiler can vectorize. Elements are
+/// returned by value.
+class PositionColumn {
+public:
+  using value_type = Position;
+  using const_reference = Position;
+  using reference = ColumnReference<PositionColumn>;
+  using const_iterator = ColumnIterator<const PositionColumn>;
+  using iterator = ColumnIterator<PositionColumn>;
+
+  PositionColumn() = default;
+  explicit PositionColumn(const gsl::index size)
+      : m_x(size), m_y(size), m_z(size) {}
+  template <class InputIt> PositionColumn(InputIt first, InputIt last) {
+    for (; first != last; ++first)
+      push_back(*first);
+  }
+  PositionColumn(std::initializer_list<Position> values)
+      : PositionColumn(values.begin(), values.end()) {}
+  template <class Allocator>
+  PositionColumn(const std::vector<Position, Allocator> &values)
+      : PositionColumn(values.begin(), values.end()) {}
+  /// Creates a column from the arrays of the components.
+  PositionColumn(Vector<double> x, Vector<double> y, Vector<double> z)
+      : m_x(std::move(x)), m_y(std::move(y)), m_z(std::move(z)) {
+    if (m_y.size() != m_x.size() || m_z.size() != m_x.size())
+      throw std::runtime_error("Components of positions differ in size.");
+  }
+
+  gsl::index size() const { return m_x.size(); }
+  bool empty() const { return m_x.empty(); }
+  void resize(const gsl::index size) {
+    m_x.resize(size);
+    m_y.resize(size);
+    m_z.resize(size);
+  }
+
+  const_reference operator[](const gsl::index i) const {
+    return {{m_x[i], m_y[i], m_z[i]}};
+  }
+  reference operator[](const gsl::index i) { return {*this, i}; }
+
+  const_iterator begin() const { return {*this, 0}; }
+  const_iterator end() const { return {*this, size()}; }
+  iterator begin() { return {*this, 0}; }
+  iterator end() { return {*this, size()}; }
+
+  void assign(const gsl::index i, const_reference value) {
+    m_x[i] = value[0];
+    m_y[i] = value[1];
+    m_z[i] = value[2];
+  }
+  void push_back(const_reference value) {
+    m_x.push_back(value[0]);
+    m_y.push_back(value[1]);
+    m_z.push_back(value[2]);
+  }
+
+  const Vector<double> &x() const { return m_x; }
+  const Vector<double> &y() const { return m_y; }
+  const Vector<double> &z() const { return m_z; }
+  gsl::span<double> x() { return m_x; }
+  gsl::span<double> y() { return m_y; }
+  gsl::span<double> z() { return m_z; }
+
+  bool operator==(const PositionColumn &other) const {
+    return m_x == other.m_x && m_y == other.m_y && m_z == other.m_z;
+  }
+  bool operator!=(const PositionColumn &other) const {
+    return !(*this == other);
+  }
+
+private:
+  Vector<double> m_x;
+  Vector<double> m_y;
+  Vector<double> m_z;
+};
+
+#endif // POSITION_COLUMN_H
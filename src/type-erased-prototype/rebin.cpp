@@ -0,0 +1,258 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+#include "parallel.h"
+#include "rebin.h"
+
+namespace {
+/// Returns the id of the coordinate holding the bin edges for `dim`.
+uint16_t edgeCoordId(const Dimension dim) {
+  switch (dim) {
+  case Dimension::Tof:
+    return tag_id<Coord::Tof>;
+  case Dimension::MonitorTof:
+    return tag_id<Coord::MonitorTof>;
+  case Dimension::X:
+    return tag_id<Coord::X>;
+  case Dimension::Y:
+    return tag_id<Coord::Y>;
+  case Dimension::Z:
+    return tag_id<Coord::Z>;
+  case Dimension::Temperature:
+    return tag_id<Coord::Temperature>;
+  default:
+    throw std::runtime_error("Rebinning is not supported for this dimension.");
+  }
+}
+
+// Coordinates returned by edgeCoordId as well as Data::Value and
+// Data::Variance are of type double, and access is by storage type, so
+// Coord::Tof serves for all of them.
+gsl::span<const double> doubleValues(const Variable &var) {
+  return var.get<const Coord::Tof>();
+}
+
+bool isIncreasing(const double *edges, const gsl::index size) {
+  return std::adjacent_find(edges, edges + size,
+                            std::greater_equal<double>()) == edges + size;
+}
+
+/// Calls `f(oldBin, newBin, fraction)` for each pair of overlapping bins, with
+/// `fraction` the fraction of the old bin covered by the new bin. Pairs are
+/// visited in ascending order of both bins.
+template <class F>
+void forEachOverlap(const double *oldEdges, const gsl::index oldBins,
+                    const double *newEdges, const gsl::index newBins, F &&f) {
+  gsl::index i = std::upper_bound(oldEdges, oldEdges + oldBins, newEdges[0]) -
+                 oldEdges;
+  gsl::index j = std::upper_bound(newEdges, newEdges + newBins, oldEdges[0]) -
+                 newEdges;
+  i = std::max(i - 1, gsl::index{0});
+  j = std::max(j - 1, gsl::index{0});
+  while (i < oldBins && j < newBins) {
+    const auto low = std::max(oldEdges[i], newEdges[j]);
+    const auto high = std::min(oldEdges[i + 1], newEdges[j + 1]);
+    if (high > low)
+      f(i, j, (high - low) / (oldEdges[i + 1] - oldEdges[i]));
+    if (oldEdges[i + 1] <= newEdges[j + 1])
+      ++i;
+    else
+      ++j;
+  }
+}
+
+/// Number of histograms interleaved by applyPlan when the rebinned dimension
+/// is the inner dimension. 16 doubles are four AVX registers.
+constexpr gsl::index blockSize = 16;
+
+/// Rebins `outer` blocks of `inner` interleaved histograms, see
+/// RebinPlan::apply. If the histograms are not interleaved (`inner` is 1),
+/// blocks of histograms are transposed into a buffer, such that the kernel
+/// always runs over contiguous lanes.
+void applyPlan(const RebinPlan &plan, const double *in, double *out,
+               const gsl::index outer, const gsl::index inner) {
+  const auto oldSize = plan.oldBins() * inner;
+  const auto newSize = plan.newBins() * inner;
+  if (inner != 1) {
+    parallel::forEachChunk(
+        outer,
+        [&](const gsl::index begin, const gsl::index end) {
+          for (auto i = begin; i < end; ++i)
+            plan.apply(in + i * oldSize, out + i * newSize, inner);
+        },
+        parallel::grainSize / (oldSize + 1));
+    return;
+  }
+  parallel::forEachChunk(
+      outer,
+      [&](const gsl::index begin, const gsl::index end) {
+        Vector<double> oldBlock(plan.oldBins() * blockSize);
+        Vector<double> newBlock(plan.newBins() * blockSize);
+        for (auto first = begin; first < end; first += blockSize) {
+          const auto lanes = std::min(blockSize, end - first);
+          for (gsl::index lane = 0; lane < lanes; ++lane)
+            for (gsl::index bin = 0; bin < plan.oldBins(); ++bin)
+              oldBlock[bin * lanes + lane] = in[(first + lane) * oldSize + bin];
+          plan.apply(oldBlock.data(), newBlock.data(), lanes);
+          for (gsl::index lane = 0; lane < lanes; ++lane)
+            for (gsl::index bin = 0; bin < plan.newBins(); ++bin)
+              out[(first + lane) * newSize + bin] =
+                  newBlock[bin * lanes + lane];
+        }
+      },
+      parallel::grainSize / (oldSize + 1));
+}
+
+/// Rebins `outer` histograms, each with its own old bin edges. There is no
+/// plan to share, so the overlaps are computed while walking the edges.
+void applyEdges(const double *oldEdges, const gsl::index oldBins,
+                gsl::span<const double> newEdges, const double *in, double *out,
+                const gsl::index outer) {
+  const auto newBins = newEdges.size() - 1;
+  parallel::forEachChunk(
+      outer,
+      [&](const gsl::index begin, const gsl::index end) {
+        for (auto i = begin; i < end; ++i) {
+          const auto values = in + i * oldBins;
+          const auto result = out + i * newBins;
+          std::fill(result, result + newBins, 0.0);
+          forEachOverlap(oldEdges + i * (oldBins + 1), oldBins,
+                         newEdges.data(), newBins,
+                         [&](const gsl::index oldBin, const gsl::index newBin,
+                             const double fraction) {
+                           result[newBin] += fraction * values[oldBin];
+                         });
+        }
+      },
+      parallel::grainSize / (oldBins + 1));
+}
+
+Dimensions withoutDimension(Dimensions dims, const Dimension dim) {
+  dims.erase(dim);
+  return dims;
+}
+}
+
+RebinPlan::RebinPlan(gsl::span<const double> oldEdges,
+                     gsl::span<const double> newEdges)
+    : m_oldBins(oldEdges.size() - 1) {
+  if (oldEdges.size() < 2 || newEdges.size() < 2)
+    throw std::runtime_error("Bin edges must define at least one bin.");
+  if (!isIncreasing(oldEdges.data(), oldEdges.size()) ||
+      !isIncreasing(newEdges.data(), newEdges.size()))
+    throw std::runtime_error("Bin edges must be strictly increasing.");
+  const auto newBins = newEdges.size() - 1;
+  m_offsets.assign(newBins + 1, 0);
+  forEachOverlap(oldEdges.data(), m_oldBins, newEdges.data(), newBins,
+                 [&](const gsl::index oldBin, const gsl::index newBin,
+                     const double fraction) {
+                   ++m_offsets[newBin + 1];
+                   m_oldBin.push_back(oldBin);
+                   m_weight.push_back(fraction);
+                 });
+  std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+}
+
+void RebinPlan::apply(const double *in, double *out,
+                      const gsl::index lanes) const {
+  for (gsl::index bin = 0; bin < newBins(); ++bin) {
+    const auto result = out + bin * lanes;
+    std::fill(result, result + lanes, 0.0);
+    for (auto i = m_offsets[bin]; i < m_offsets[bin + 1]; ++i) {
+      const auto weight = m_weight[i];
+      const auto values = in + m_oldBin[i] * lanes;
+      for (gsl::index lane = 0; lane < lanes; ++lane)
+        result[lane] += weight * values[lane];
+    }
+  }
+}
+
+Dataset rebin(const Dataset &d, const Dimension dim, const Variable &newEdges) {
+  const auto coordId = edgeCoordId(dim);
+  if (newEdges.type() != coordId || newEdges.dimensions().count() != 1 ||
+      newEdges.dimensions().label(0) != dim)
+    throw std::runtime_error("New bin edges must be a one-dimensional "
+                             "variable of the coordinate of the dimension.");
+  const auto &oldEdges = d[d.find(coordId, "")];
+  const auto &edgeDims = oldEdges.dimensions();
+  const auto oldBins = d.dimensions().size(dim);
+  if (edgeDims.size(dim) != oldBins + 1)
+    throw std::runtime_error("Rebinning requires bin edges.");
+  const auto newValues = doubleValues(newEdges);
+  const auto newBins = newValues.size() - 1;
+
+  const bool sharedEdges = edgeDims.count() == 1;
+  std::unique_ptr<RebinPlan> plan;
+  if (sharedEdges) {
+    plan = std::make_unique<RebinPlan>(doubleValues(oldEdges), newValues);
+  } else {
+    const auto oldValues = doubleValues(oldEdges);
+    if (edgeDims.label(0) != dim)
+      throw std::runtime_error("Bin edges depending on other dimensions must "
+                               "have the rebinned dimension as inner "
+                               "dimension.");
+    if (newValues.size() < 2)
+      throw std::runtime_error("Bin edges must define at least one bin.");
+    std::atomic<bool> increasing{isIncreasing(newValues.data(), newBins + 1)};
+    parallel::forEachChunk(
+        edgeDims.volume() / (oldBins + 1),
+        [&](const gsl::index begin, const gsl::index end) {
+          for (auto i = begin; i < end; ++i)
+            if (!isIncreasing(oldValues.data() + i * (oldBins + 1),
+                              oldBins + 1))
+              increasing = false;
+        });
+    if (!increasing)
+      throw std::runtime_error("Bin edges must be strictly increasing.");
+  }
+
+  Dataset result;
+  for (const auto &var : d) {
+    const auto &dims = var.dimensions();
+    if (var.type() == coordId) {
+      result.insertAsEdge(dim, newEdges);
+      continue;
+    }
+    if (!dims.contains(dim)) {
+      result.insert(var);
+      continue;
+    }
+    if (!var.valueTypeIs<Data::Value>() && !var.valueTypeIs<Data::Variance>())
+      throw std::runtime_error("Cannot rebin variables other than Data::Value "
+                               "and Data::Variance.");
+    auto resultDims = dims;
+    resultDims.resize(dim, newBins);
+    Vector<double> values(resultDims.volume());
+    const auto in = doubleValues(var).data();
+    const auto inner = dims.offset(dim);
+    const auto outer = dims.volume() / (oldBins * inner);
+    if (sharedEdges) {
+      applyPlan(*plan, in, values.data(), outer, inner);
+    } else {
+      if (inner != 1 || !(withoutDimension(dims, dim) ==
+                          withoutDimension(edgeDims, dim)))
+        throw std::runtime_error("Data must have the same dimensions as bin "
+                                 "edges depending on other dimensions.");
+      applyEdges(doubleValues(oldEdges).data(), oldBins, newValues, in,
+                 values.data(), outer);
+    }
+    auto rebinned = var.valueTypeIs<Data::Value>()
+                        ? makeVariable<Data::Value>(resultDims,
+                                                    std::move(values))
+                        : makeVariable<Data::Variance>(resultDims,
+                                                       std::move(values));
+    rebinned.setName(var.name());
+    rebinned.setUnit(var.unit());
+    result.insert(std::move(rebinned));
+  }
+  return result;
+}
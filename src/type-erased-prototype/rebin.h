@@ -0,0 +1,50 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef REBIN_H
+#define REBIN_H
+
+#include <gsl/gsl_util>
+#include <gsl/span>
+
+#include "dataset.h"
+
+/// Sparse matrix mapping histograms with bin edges `oldEdges` to histograms
+/// with bin edges `newEdges`. Each new bin is the sum over the overlapping old
+/// bins, weighted by the fraction of the old bin covered by the new bin. The
+/// old bins contributing to a new bin are consecutive, so the weights are
+/// stored by new bin. Computing the plan is independent of the data, so one
+/// plan can be applied to any number of histograms sharing their bin edges.
+class RebinPlan {
+public:
+  RebinPlan(gsl::span<const double> oldEdges, gsl::span<const double> newEdges);
+
+  gsl::index oldBins() const { return m_oldBins; }
+  gsl::index newBins() const { return m_offsets.size() - 1; }
+
+  /// Rebins `lanes` interleaved histograms, i.e., bin `i` of histogram `l` is
+  /// at `in[i * lanes + l]`, writing the result to `out` in the same layout.
+  /// The inner loop is over lanes, which the compiler vectorizes.
+  void apply(const double *in, double *out, const gsl::index lanes = 1) const;
+
+private:
+  gsl::index m_oldBins;
+  Vector<gsl::index> m_offsets;
+  Vector<gsl::index> m_oldBin;
+  Vector<double> m_weight;
+};
+
+/// Returns `d` rebinned to the bin edges `newEdges` in dimension `dim`, a
+/// one-dimensional variable with the same tag as the coordinate of `dim`,
+/// e.g., Coord::Tof for Dimension::Tof. Data::Value and Data::Variance are
+/// redistributed proportionally to the overlap of old and new bins, i.e., the
+/// data are counts and a fraction `f` of a bin contributes `f` of its value
+/// and of its variance. Bins outside the old edges are zero. The old edges may
+/// depend on other dimensions, e.g., Dimension::Spectrum, in which case `dim`
+/// must be the inner dimension. Other variables depending on `dim` cannot be
+/// rebinned, variables not depending on `dim` are copied.
+Dataset rebin(const Dataset &d, const Dimension dim, const Variable &newEdges);
+
+#endif // REBIN_H
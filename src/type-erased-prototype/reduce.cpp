@@ -0,0 +1,559 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+#include "reduce.h"
+
+namespace {
+struct Sum {
+  static double identity() { return 0.0; }
+  double operator()(const double a, const double b) const { return a + b; }
+};
+
+// Written as comparison and select, which maps to vminpd and vmaxpd.
+struct Min {
+  static double identity() { return std::numeric_limits<double>::infinity(); }
+  double operator()(const double a, const double b) const {
+    return b < a ? b : a;
+  }
+};
+
+struct Max {
+  static double identity() { return -std::numeric_limits<double>::infinity(); }
+  double operator()(const double a, const double b) const {
+    return b > a ? b : a;
+  }
+};
+
+/// Sum with Neumaier's compensation, which accumulates the rounding errors of
+/// the additions separately. Partial results are combined by plain addition.
+struct CompensatedSum : Sum {};
+
+/// Adds `x` to `sum` and the rounding error of the addition to `error`. The
+/// error is computed with Knuth's TwoSum, which gives the same result as the
+/// comparison of magnitudes in Neumaier's algorithm but without a branch, so
+/// the loops using this vectorize.
+inline void addCompensated(double &sum, double &error, const double x) {
+  const double t = sum + x;
+  const double xRounded = t - sum;
+  error += (sum - (t - xRounded)) + (x - xRounded);
+  sum = t;
+}
+
+/// Number of independent accumulators for horizontal reductions. Floating-point
+/// addition is not associative, so the compiler does not vectorize a single
+/// accumulator. With 8 accumulators it keeps two AVX registers.
+constexpr gsl::index lanes = 8;
+
+/// Returns the reduction of the contiguous range [in, in + size).
+template <class Op>
+double reduceContiguous(const double *in, const gsl::index size, const Op op) {
+  double acc[lanes];
+  std::fill(acc, acc + lanes, Op::identity());
+  gsl::index i = 0;
+  for (; i + lanes <= size; i += lanes)
+    for (gsl::index lane = 0; lane < lanes; ++lane)
+      acc[lane] = op(acc[lane], in[i + lane]);
+  for (; i < size; ++i)
+    acc[0] = op(acc[0], in[i]);
+  for (gsl::index width = lanes / 2; width > 0; width /= 2)
+    for (gsl::index lane = 0; lane < width; ++lane)
+      acc[lane] = op(acc[lane], acc[lane + width]);
+  return acc[0];
+}
+
+/// Number of output elements processed at a time in reduceStrided, such that
+/// they stay in L1 cache while streaming over the reduced dimension.
+constexpr gsl::index tileSize = 512;
+
+/// Accumulates `out[i] = op(out[i], in[k * stride + i])` for `k` in [0, count)
+/// and `i` in [0, size). The inner loop is over contiguous elements, i.e., the
+/// reduction is vertical and vectorizes without reordering operations.
+template <class Op>
+void reduceStrided(const double *in, double *out, const gsl::index count,
+                   const gsl::index stride, const gsl::index size,
+                   const Op op) {
+  for (gsl::index begin = 0; begin < size; begin += tileSize) {
+    const auto end = std::min(size, begin + tileSize);
+    for (gsl::index k = 0; k < count; ++k) {
+      const double *row = in + k * stride;
+      for (auto i = begin; i < end; ++i)
+        out[i] = op(out[i], row[i]);
+    }
+  }
+}
+
+void reduceStrided(const double *in, double *out, const gsl::index count,
+                   const gsl::index stride, const gsl::index size,
+                   const CompensatedSum) {
+  double error[tileSize];
+  for (gsl::index begin = 0; begin < size; begin += tileSize) {
+    const auto end = std::min(size, begin + tileSize);
+    std::fill(error, error + (end - begin), 0.0);
+    for (gsl::index k = 0; k < count; ++k) {
+      const double *row = in + k * stride;
+      for (auto i = begin; i < end; ++i)
+        addCompensated(out[i], error[i - begin], row[i]);
+    }
+    for (auto i = begin; i < end; ++i)
+      out[i] += error[i - begin];
+  }
+}
+
+/// The row is viewed as a matrix with `lanes` columns, which is reduced
+/// vertically, since the compiler does not vectorize the compensated
+/// accumulators of the horizontal reduction.
+double reduceContiguous(const double *in, const gsl::index size,
+                        const CompensatedSum op) {
+  double partial[lanes] = {};
+  const auto rows = size / lanes;
+  reduceStrided(in, partial, rows, lanes, lanes, op);
+  double total = 0.0;
+  double error = 0.0;
+  for (gsl::index lane = 0; lane < lanes; ++lane)
+    addCompensated(total, error, partial[lane]);
+  for (auto i = rows * lanes; i < size; ++i)
+    addCompensated(total, error, in[i]);
+  return total + error;
+}
+
+/// Accumulates the reduction of the elements [begin, end) of the reduced
+/// dimension into `partial`, which has the size of the output.
+template <class Op>
+void reducePartial(const double *in, double *partial, const gsl::index outer,
+                   const gsl::index count, const gsl::index inner,
+                   const gsl::index begin, const gsl::index end, const Op op) {
+  for (gsl::index o = 0; o < outer; ++o) {
+    if (inner == 1)
+      partial[o] = op(partial[o], reduceContiguous(in + o * count + begin,
+                                                   end - begin, op));
+    else
+      reduceStrided(in + (o * count + begin) * inner, partial + o * inner,
+                    end - begin, inner, inner, op);
+  }
+}
+
+/// Length of the blocks of the reduced dimension in reproducible mode. This
+/// must not depend on the number of threads.
+constexpr gsl::index blockSize = 4096;
+
+/// Returns the reduction of `in`, with dimensions `dims`, along `dim`. The
+/// work is split between threads along the output, or, if the output is
+/// smaller than the reduced dimension, along `dim`. In that case partial
+/// results are combined in a tree, for `reproducible` over blocks of fixed
+/// size, else over one chunk per thread.
+template <class Op>
+Vector<double> reduce(const double *in, const Dimensions &dims,
+                      const Dimension dim, const Op op,
+                      const bool reproducible) {
+  const auto count = dims.size(dim);
+  const auto inner = dims.offset(dim);
+  // Product of the sizes of the dimensions outside `dim`.
+  gsl::index outer = 1;
+  bool isOuter = false;
+  for (gsl::index i = 0; i < dims.count(); ++i) {
+    if (isOuter)
+      outer *= dims.size(i);
+    isOuter |= dims.label(i) == dim;
+  }
+  const auto size = outer * inner;
+  Vector<double> out(size, Op::identity());
+  if (count > size && reproducible) {
+    const auto blocks = (count + blockSize - 1) / blockSize;
+    Vector<double> partials(blocks * size, Op::identity());
+    parallel::forEach(blocks, [&](const gsl::index block) {
+      reducePartial(in, partials.data() + block * size, outer, count, inner,
+                    block * blockSize,
+                    std::min(count, (block + 1) * blockSize), op);
+    });
+    for (gsl::index stride = 1; stride < blocks; stride *= 2)
+      for (gsl::index block = 0; block + stride < blocks; block += 2 * stride) {
+        double *a = partials.data() + block * size;
+        const double *b = a + stride * size;
+        for (gsl::index i = 0; i < size; ++i)
+          a[i] = op(a[i], b[i]);
+      }
+    out.assign(partials.begin(), partials.begin() + size);
+    return out;
+  }
+  if (count > size) {
+    if (inner == 1) {
+      for (gsl::index o = 0; o < outer; ++o)
+        out[o] = parallel::reduce(
+            count, Op::identity(),
+            [&](const gsl::index begin, const gsl::index end) {
+              return reduceContiguous(in + o * count + begin, end - begin, op);
+            },
+            op);
+    } else {
+      out = parallel::reduce(
+          count, out,
+          [&](const gsl::index begin, const gsl::index end) {
+            Vector<double> partial(size, Op::identity());
+            reducePartial(in, partial.data(), outer, count, inner, begin, end,
+                          op);
+            return partial;
+          },
+          [op](Vector<double> a, const Vector<double> &b) {
+            for (gsl::index i = 0; i < a.size(); ++i)
+              a[i] = op(a[i], b[i]);
+            return a;
+          },
+          parallel::grainSize / (size + 1));
+    }
+    return out;
+  }
+
+  parallel::forEachChunk(
+      size,
+      [&](const gsl::index begin, const gsl::index end) {
+        if (inner == 1) {
+          for (auto o = begin; o < end; ++o)
+            out[o] = reduceContiguous(in + o * count, count, op);
+          return;
+        }
+        // Chunks of the output may span several blocks of the outer
+        // dimensions.
+        for (auto i = begin; i < end;) {
+          const auto o = i / inner;
+          const auto blockEnd = std::min(end, (o + 1) * inner);
+          reduceStrided(in + o * count * inner + (i - o * inner),
+                        out.data() + i, count, inner, blockEnd - i, op);
+          i = blockEnd;
+        }
+      },
+      parallel::grainSize / (count + 1));
+  return out;
+}
+
+/// As reduce, excluding the slices along `dim` masked by `mask`. Unmasked
+/// slices are processed as ranges, see MaskColumn::forEachUnsetRange, i.e.,
+/// masked slices are never read and words of 64 masked slices are skipped in
+/// one step. The work is split as in reduce, always in the fast order.
+template <class Op>
+Vector<double> reduce(const double *in, const Dimensions &dims,
+                      const Dimension dim, const MaskColumn &mask,
+                      const Op op) {
+  const auto count = dims.size(dim);
+  const auto inner = dims.offset(dim);
+  const auto size = count * inner == 0 ? 0 : dims.volume() / count;
+  const auto outer = inner == 0 ? 0 : size / inner;
+  Vector<double> out(size, Op::identity());
+  if (count > size)
+    return parallel::reduce(
+        count, out,
+        [&](const gsl::index begin, const gsl::index end) {
+          Vector<double> partial(size, Op::identity());
+          mask.forEachUnsetRange(
+              begin, end, [&](const gsl::index first, const gsl::index last) {
+                reducePartial(in, partial.data(), outer, count, inner, first,
+                              last, op);
+              });
+          return partial;
+        },
+        [op](Vector<double> a, const Vector<double> &b) {
+          for (gsl::index i = 0; i < a.size(); ++i)
+            a[i] = op(a[i], b[i]);
+          return a;
+        },
+        parallel::grainSize / (size + 1));
+
+  std::vector<std::pair<gsl::index, gsl::index>> ranges;
+  mask.forEachUnsetRange(0, count,
+                         [&](const gsl::index first, const gsl::index last) {
+                           ranges.emplace_back(first, last);
+                         });
+  parallel::forEachChunk(
+      size,
+      [&](const gsl::index begin, const gsl::index end) {
+        for (auto i = begin; i < end;) {
+          const auto o = i / inner;
+          const auto blockEnd = std::min(end, (o + 1) * inner);
+          for (const auto &range : ranges) {
+            const auto first = in + (o * count + range.first) * inner;
+            if (inner == 1)
+              out[o] = op(out[o], reduceContiguous(
+                                      first, range.second - range.first, op));
+            else
+              reduceStrided(first + (i - o * inner), out.data() + i,
+                            range.second - range.first, inner, blockEnd - i,
+                            op);
+          }
+          i = blockEnd;
+        }
+      },
+      parallel::grainSize / (count + 1));
+  return out;
+}
+
+enum class Reduction { Sum, Mean, Min, Max };
+
+Vector<double> reduce(const Variable &var, const Dimension dim,
+                      const Reduction reduction, const ReductionMode mode,
+                      const MaskColumn *mask) {
+  const auto in = var.get<const Data::Value>().data();
+  const auto &dims = var.dimensions();
+  if (mask) {
+    if (reduction == Reduction::Min)
+      return reduce(in, dims, dim, *mask, Min{});
+    if (reduction == Reduction::Max)
+      return reduce(in, dims, dim, *mask, Max{});
+    return reduce(in, dims, dim, *mask, Sum{});
+  }
+  switch (reduction) {
+  case Reduction::Min:
+    return reduce(in, dims, dim, Min{}, false);
+  case Reduction::Max:
+    return reduce(in, dims, dim, Max{}, false);
+  default:
+    if (mode == ReductionMode::Compensated)
+      return reduce(in, dims, dim, CompensatedSum{}, true);
+    return reduce(in, dims, dim, Sum{}, mode == ReductionMode::Reproducible);
+  }
+}
+
+void divide(Vector<double> &values, const double divisor) {
+  parallel::transform(
+      values.size(), values.begin(), values.begin(), values.begin(),
+      [divisor](const double x, double) { return x / divisor; });
+}
+
+/// Inserts a copy of `var` into `d`, as bin edges if it is longer by one than
+/// the data along one of its dimensions.
+void insertCopy(Dataset &d, const Variable &var, const Dimensions &dims) {
+  for (const auto &item : var.dimensions())
+    if (dims.contains(item.first) && item.second == dims.size(item.first) + 1)
+      return d.insertAsEdge(item.first, var);
+  d.insert(var);
+}
+
+/// Sums the rows of `in` of the spectra of each group into `out`, viewed as
+/// [outer][spectra][inner] and [outer][groups][inner], respectively. `out`
+/// must be zero-initialized. Threads work on disjoint ranges of `out`, i.e.,
+/// no atomics are required, and since the ranges do not need to be whole rows
+/// a few large groups still make use of all threads. Each range is processed
+/// in tiles that stay in L1 cache while the rows of the group are added.
+void groupSum(const double *in, double *out, const IndexListColumn &grouping,
+              const gsl::index outer, const gsl::index spectra,
+              const gsl::index inner) {
+  const gsl::index groups = grouping.size();
+  const gsl::index items = grouping.values().size();
+  const auto groupSize =
+      std::max(gsl::index{1}, items / std::max(gsl::index{1}, groups));
+  parallel::forEachChunk(
+      outer * groups * inner,
+      [&](const gsl::index begin, const gsl::index end) {
+        const auto offsets = grouping.offsets().data();
+        const auto indices = grouping.values().data();
+        for (auto i = begin; i < end;) {
+          const auto row = i / inner;
+          const auto rowBegin = row * inner;
+          const auto rowEnd = std::min(end, rowBegin + inner);
+          const auto group = row % groups;
+          const auto first = in + (row / groups) * spectra * inner;
+          for (auto tile = i; tile < rowEnd; tile += tileSize) {
+            const auto size = std::min(tileSize, rowEnd - tile);
+            const auto target = out + tile;
+            for (auto k = offsets[group]; k < offsets[group + 1]; ++k) {
+              const auto source = first + indices[k] * inner + tile - rowBegin;
+              for (gsl::index j = 0; j < size; ++j)
+                target[j] += source[j];
+            }
+          }
+          i = rowEnd;
+        }
+      },
+      parallel::grainSize / groupSize);
+}
+
+/// Returns the detectors of each group, i.e., the concatenation of the
+/// detectors, given by `detectors`, of the spectra of the group.
+IndexListColumn groupDetectors(const IndexListColumn &detectors,
+                               const IndexListColumn &grouping) {
+  const auto &spectrumOffsets = detectors.offsets();
+  const auto &groupOffsets = grouping.offsets();
+  const auto &spectra = grouping.values();
+  Vector<int64_t> offsets(grouping.size() + 1, 0);
+  parallel::forEachChunk(
+      grouping.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto group = begin; group < end; ++group)
+          for (auto k = groupOffsets[group]; k < groupOffsets[group + 1]; ++k)
+            offsets[group] += spectrumOffsets[spectra[k] + 1] -
+                              spectrumOffsets[spectra[k]];
+      });
+  Vector<gsl::index> values(
+      parallel::exclusiveScan(offsets.size(), offsets.data()));
+  parallel::forEachChunk(
+      grouping.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto group = begin; group < end; ++group) {
+          auto out = values.begin() + offsets[group];
+          for (auto k = groupOffsets[group]; k < groupOffsets[group + 1]; ++k)
+            out = std::copy(
+                detectors.values().begin() + spectrumOffsets[spectra[k]],
+                detectors.values().begin() + spectrumOffsets[spectra[k] + 1],
+                out);
+        }
+      });
+  return IndexListColumn(std::move(offsets), std::move(values));
+}
+
+Dataset reduce(const Dataset &d, const Dimension dim,
+               const Reduction reduction,
+               const ReductionMode mode = ReductionMode::Fast,
+               const Variable *mask = nullptr) {
+  if (!d.dimensions().contains(dim))
+    throw std::runtime_error("Dataset does not contain the dimension to "
+                             "reduce.");
+  const MaskColumn *maskColumn = nullptr;
+  if (mask) {
+    if (!mask->valueTypeIs<Coord::Mask>() ||
+        !(mask->dimensions() == Dimensions(dim, d.dimensions().size(dim))))
+      throw std::runtime_error("Mask must be a one-dimensional Coord::Mask "
+                               "variable along the reduced dimension.");
+    maskColumn = &mask->get<const Coord::Mask>().column();
+  }
+  Dataset result;
+  for (const auto &var : d) {
+    if (var.isCoord() &&
+        (var.dimensions().contains(dim) ||
+         (dim == Dimension::Detector &&
+          var.valueTypeIs<Coord::DetectorGrouping>())))
+      continue;
+    if (!var.dimensions().contains(dim)) {
+      insertCopy(result, var, d.dimensions());
+      continue;
+    }
+    const bool isVariance = var.valueTypeIs<Data::Variance>();
+    if (!isVariance && !var.valueTypeIs<Data::Value>())
+      throw std::runtime_error("Cannot reduce variables other than "
+                               "Data::Value and Data::Variance.");
+    if (isVariance &&
+        (reduction == Reduction::Min || reduction == Reduction::Max))
+      throw std::runtime_error("Cannot compute minimum or maximum of "
+                               "variances.");
+    if (var.dimensions().isRagged())
+      throw std::runtime_error("Cannot reduce ragged variables.");
+
+    auto values = reduce(var, dim, reduction, mode, maskColumn);
+    if (reduction == Reduction::Mean) {
+      const double count =
+          var.dimensions().size(dim) - (maskColumn ? maskColumn->count() : 0);
+      divide(values, isVariance ? count * count : count);
+    }
+    auto dims = var.dimensions();
+    dims.erase(dim);
+    auto reduced =
+        isVariance ? makeVariable<Data::Variance>(dims, std::move(values))
+                   : makeVariable<Data::Value>(dims, std::move(values));
+    reduced.setName(var.name());
+    reduced.setUnit(var.unit());
+    result.insert(std::move(reduced));
+  }
+  return result;
+}
+}
+
+Dataset sum(const Dataset &d, const Dimension dim, const ReductionMode mode) {
+  return reduce(d, dim, Reduction::Sum, mode);
+}
+
+Dataset mean(const Dataset &d, const Dimension dim, const ReductionMode mode) {
+  return reduce(d, dim, Reduction::Mean, mode);
+}
+
+Dataset min(const Dataset &d, const Dimension dim) {
+  return reduce(d, dim, Reduction::Min);
+}
+
+Dataset max(const Dataset &d, const Dimension dim) {
+  return reduce(d, dim, Reduction::Max);
+}
+
+Dataset sum(const Dataset &d, const Dimension dim, const Variable &mask) {
+  return reduce(d, dim, Reduction::Sum, ReductionMode::Fast, &mask);
+}
+
+Dataset mean(const Dataset &d, const Dimension dim, const Variable &mask) {
+  return reduce(d, dim, Reduction::Mean, ReductionMode::Fast, &mask);
+}
+
+Dataset min(const Dataset &d, const Dimension dim, const Variable &mask) {
+  return reduce(d, dim, Reduction::Min, ReductionMode::Fast, &mask);
+}
+
+Dataset max(const Dataset &d, const Dimension dim, const Variable &mask) {
+  return reduce(d, dim, Reduction::Max, ReductionMode::Fast, &mask);
+}
+
+Dataset groupSum(const Dataset &d, const Variable &grouping) {
+  const auto &groupDims = grouping.dimensions();
+  if (!grouping.valueTypeIs<Coord::DetectorGrouping>() ||
+      groupDims.count() != 1 || groupDims.label(0) != Dimension::Spectrum)
+    throw std::runtime_error("Grouping must be a Coord::DetectorGrouping "
+                             "variable with Dimension::Spectrum.");
+  if (!d.dimensions().contains(Dimension::Spectrum))
+    throw std::runtime_error("Dataset does not contain the dimension to "
+                             "reduce.");
+  const auto &column = grouping.get<const Coord::DetectorGrouping>().column();
+  const auto spectra = d.dimensions().size(Dimension::Spectrum);
+  const auto &indices = column.values();
+  std::atomic<bool> outOfRange{false};
+  parallel::forEachChunk(
+      indices.size(), [&](const gsl::index begin, const gsl::index end) {
+        for (auto i = begin; i < end; ++i)
+          if (indices[i] < 0 || indices[i] >= spectra)
+            outOfRange = true;
+      });
+  if (outOfRange)
+    throw std::runtime_error("Spectrum index in grouping out of range.");
+
+  Dataset result;
+  for (const auto &var : d) {
+    if (var.valueTypeIs<Coord::DetectorGrouping>() &&
+        var.dimensions() == Dimensions(Dimension::Spectrum, spectra)) {
+      result.insert(makeVariable<Coord::DetectorGrouping>(
+          groupDims,
+          groupDetectors(var.get<const Coord::DetectorGrouping>().column(),
+                         column)));
+      continue;
+    }
+    if (var.isCoord() && var.dimensions().contains(Dimension::Spectrum))
+      continue;
+    if (!var.dimensions().contains(Dimension::Spectrum)) {
+      insertCopy(result, var, d.dimensions());
+      continue;
+    }
+    const bool isVariance = var.valueTypeIs<Data::Variance>();
+    if (!isVariance && !var.valueTypeIs<Data::Value>())
+      throw std::runtime_error("Cannot reduce variables other than "
+                               "Data::Value and Data::Variance.");
+    if (var.dimensions().isRagged())
+      throw std::runtime_error("Cannot reduce ragged variables.");
+
+    auto dims = var.dimensions();
+    const auto inner = dims.offset(Dimension::Spectrum);
+    const auto outer =
+        inner * spectra == 0 ? 0 : dims.volume() / (inner * spectra);
+    dims.resize(Dimension::Spectrum, column.size());
+    Vector<double> values(dims.volume(), 0.0);
+    groupSum(var.get<const Data::Value>().data(), values.data(), column, outer,
+             spectra, inner);
+    auto grouped =
+        isVariance ? makeVariable<Data::Variance>(dims, std::move(values))
+                   : makeVariable<Data::Value>(dims, std::move(values));
+    grouped.setName(var.name());
+    grouped.setUnit(var.unit());
+    result.insert(std::move(grouped));
+  }
+  return result;
+}
@@ -0,0 +1,65 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "dataset.h"
+
+// Reductions of a Dataset along a dimension. Data::Value and Data::Variance
+// are reduced, other variables depending on `dim` are not supported.
+// Coordinates depending on `dim`, including bin edges, are dropped, as is
+// Coord::DetectorGrouping when reducing Dimension::Detector since it refers to
+// detector indices. Variables that do not depend on `dim` are copied.
+
+/// Order of operations of sum and mean. Minimum and maximum do not depend on
+/// the order and are always reproducible.
+enum class ReductionMode {
+  /// Fastest. If threads split the reduced dimension, the result depends on the
+  /// number of threads in the last bits.
+  Fast,
+  /// Bitwise reproducible, independent of the number of threads. The reduced
+  /// dimension is split into blocks of fixed size, whose sums are combined
+  /// pairwise in a fixed order.
+  Reproducible,
+  /// As Reproducible, with compensated (Neumaier) summation, i.e., the rounding
+  /// error does not grow with the number of summed values.
+  Compensated
+};
+
+/// Returns the sum of `d` along `dim`. Variances are summed as well, i.e., the
+/// result holds the variance of the sum of uncorrelated values.
+Dataset sum(const Dataset &d, const Dimension dim,
+            const ReductionMode mode = ReductionMode::Fast);
+/// Returns the mean of `d` along `dim`. The variance of the mean is the sum of
+/// the variances divided by the square of the size of `dim`.
+Dataset mean(const Dataset &d, const Dimension dim,
+             const ReductionMode mode = ReductionMode::Fast);
+/// Returns the minimum of `d` along `dim`. Variances are not supported.
+Dataset min(const Dataset &d, const Dimension dim);
+/// Returns the maximum of `d` along `dim`. Variances are not supported.
+Dataset max(const Dataset &d, const Dimension dim);
+
+// Masked reductions, excluding the slices along `dim` masked by `mask`, a
+// one-dimensional Coord::Mask variable along `dim`, e.g., masked spectra when
+// summing over Dimension::Spectrum. Masked slices are not read, the mean is
+// over the unmasked slices. These always use ReductionMode::Fast.
+Dataset sum(const Dataset &d, const Dimension dim, const Variable &mask);
+Dataset mean(const Dataset &d, const Dimension dim, const Variable &mask);
+Dataset min(const Dataset &d, const Dimension dim, const Variable &mask);
+Dataset max(const Dataset &d, const Dimension dim, const Variable &mask);
+
+/// Returns the sum of the spectra of `d` in each group of `grouping`, e.g., for
+/// focussing or grouping detectors into banks. `grouping` is a
+/// Coord::DetectorGrouping variable along Dimension::Spectrum which lists, for
+/// each group, the indices of the spectra of `d` it contains. A spectrum may be
+/// part of several groups or of none. Dimension::Spectrum of the result has
+/// the size of `grouping`. Data::Value and Data::Variance are summed, and
+/// Coord::DetectorGrouping of `d` is replaced by the concatenation of the
+/// detectors of the spectra of each group. Other coordinates depending on
+/// Dimension::Spectrum are dropped.
+Dataset groupSum(const Dataset &d, const Variable &grouping);
+
+#endif // REDUCE_H
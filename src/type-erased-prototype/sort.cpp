@@ -0,0 +1,498 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dataset_index.h"
+#include "parallel.h"
+#include "sort.h"
+
+namespace {
+/// Keys for sorting and joining.
+template <class Tag>
+using is_key = std::integral_constant<
+    bool, std::is_arithmetic<typename Tag::type>::value ||
+              std::is_same<typename Tag::type, std::string>::value>;
+
+template <class T> bool isNaN(const T &) { return false; }
+bool isNaN(const double &x) { return std::isnan(x); }
+
+/// Returns the permutation that stably sorts `keys`. Pairs of key and index
+/// are sorted, i.e., keys are read sequentially once and equal keys stay in
+/// order of their index. NaN is moved to the end beforehand, such that the
+/// comparison in the sort is a plain `<`.
+template <class Keys> Vector<gsl::index> sortPermutation(const Keys &keys) {
+  using Key = std::decay_t<decltype(keys[0])>;
+  using Item = std::pair<Key, gsl::index>;
+  const gsl::index size = keys.size();
+  std::vector<Item> items(size);
+  parallel::forEachChunk(size, [&](const gsl::index begin,
+                                   const gsl::index end) {
+    for (auto i = begin; i < end; ++i)
+      items[i] = {keys[i], i};
+  });
+  const auto numbers = std::stable_partition(items.begin(), items.end(),
+                                             [](const Item &item) {
+                                               return !isNaN(item.first);
+                                             }) -
+                       items.begin();
+  parallel::sort(numbers, items.data(), [](const Item &a, const Item &b) {
+    return a.first < b.first || (!(b.first < a.first) && a.second < b.second);
+  });
+  Vector<gsl::index> order(size);
+  parallel::forEachChunk(size, [&](const gsl::index begin,
+                                   const gsl::index end) {
+    for (auto i = begin; i < end; ++i)
+      order[i] = items[i].second;
+  });
+  return order;
+}
+
+template <class Tag>
+Vector<gsl::index> sortPermutation(const Variable &key, std::true_type) {
+  return sortPermutation(key.get<const Tag>());
+}
+
+template <class Tag>
+Vector<gsl::index> sortPermutation(const Variable &, std::false_type) {
+  throw std::runtime_error("Sort key must be a variable of numbers or "
+                           "strings.");
+}
+
+/// Value of the slices missing on one side of a join.
+template <class T> T missingValue() { return T{}; }
+template <> double missingValue<double>() {
+  return std::numeric_limits<double>::quiet_NaN();
+}
+template <> Position missingValue<Position>() {
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  return {nan, nan, nan};
+}
+
+/// Returns `var` with a slice of missing values appended along `dim`.
+Variable withMissingSlice(const Variable &var, const Dimension dim) {
+  auto missing = slice(var, dim, 0);
+  callForTag(var.type(), [&](auto tag) {
+    using Tag = decltype(tag);
+    auto values = missing.get<Tag>();
+    std::fill(values.begin(), values.end(),
+              missingValue<typename Tag::type>());
+  });
+  return concatenate(dim, var, missing);
+}
+
+/// Inserts a copy of `var` into `d`, as bin edges if it is longer by one than
+/// the data along one of its dimensions.
+void insertCopy(Dataset &d, const Variable &var, const Dimensions &dims) {
+  for (const auto &item : var.dimensions())
+    if (dims.contains(item.first) && item.second == dims.size(item.first) + 1)
+      return d.insertAsEdge(item.first, var);
+  d.insert(var);
+}
+
+/// Returns `d` with the slices along `dim` given by `indices`, which are
+/// gathered from all variables depending on `dim`. Variables not depending on
+/// `dim` share their data with `d`. Index -1 gives a slice of missing values.
+/// `operation` names the caller in errors.
+Dataset gatherSlices(const Dataset &d, const Dimension dim,
+                     gsl::span<const gsl::index> indices,
+                     const std::string &operation) {
+  const auto size = d.dimensions().size(dim);
+  std::vector<Variable> gathered;
+  bool small = true;
+  for (const auto &var : d) {
+    const auto &dims = var.dimensions();
+    if (!dims.contains(dim))
+      continue;
+    if (dims.size(dim) != size)
+      throw std::runtime_error("Cannot " + operation +
+                               " along a dimension with bin edges.");
+    if (dims.isRagged())
+      throw std::runtime_error("Cannot " + operation + " ragged variables.");
+    small &= dims.volume() < 2 * parallel::grainSize;
+    gathered.push_back(var);
+  }
+  // Missing slices are gathered from a slice appended to each variable.
+  const bool missing = std::any_of(indices.begin(), indices.end(),
+                                   [](const gsl::index i) { return i < 0; });
+  Vector<gsl::index> filled;
+  if (missing) {
+    filled.resize(indices.size());
+    parallel::forEachChunk(filled.size(), [&](const gsl::index begin,
+                                              const gsl::index end) {
+      for (auto i = begin; i < end; ++i)
+        filled[i] = indices[i] < 0 ? size : indices[i];
+    });
+    indices = filled;
+  }
+  // Variables too small to be gathered by several threads, e.g., the columns
+  // of a table, are gathered concurrently. Otherwise the variables are
+  // gathered one after the other, each by all threads.
+  const auto gatherVariable = [&](const gsl::index i) {
+    gathered[i] = gather(
+        missing ? withMissingSlice(gathered[i], dim) : gathered[i], dim,
+        indices);
+  };
+  if (small)
+    parallel::forEach(gathered.size(), gatherVariable);
+  else
+    for (gsl::index i = 0; i < static_cast<gsl::index>(gathered.size()); ++i)
+      gatherVariable(i);
+
+  Dataset result;
+  auto next = gathered.begin();
+  for (const auto &var : d) {
+    if (var.dimensions().contains(dim))
+      result.insert(std::move(*next++));
+    else
+      insertCopy(result, var, d.dimensions());
+  }
+  return result;
+}
+
+/// Returns the indices of the unset flags of `mask`, in order. Each block of
+/// words is counted by one thread, the exclusive prefix sum of the counts gives
+/// the offset in the output of each block, and each thread then writes the
+/// indices of its block directly at that offset. Both passes work on whole
+/// words of the inverted mask, the second extracts its set bits one by one.
+Vector<gsl::index> unmaskedIndices(const MaskColumn &mask) {
+  const auto &words = mask.words();
+  const gsl::index count = words.size();
+  const auto tail = mask.size() % mask::bitsPerWord;
+  const auto unmasked = [&](const gsl::index w) {
+    return ~words[w] & (w == count - 1 && tail != 0
+                            ? (uint64_t{1} << tail) - uint64_t{1}
+                            : ~uint64_t{0});
+  };
+  const auto block = parallel::grainSize / mask::bitsPerWord;
+  const auto blocks = (count + block - 1) / block;
+  std::vector<gsl::index> offsets(blocks + 1, 0);
+  parallel::forEach(blocks, [&](const gsl::index b) {
+    const auto end = std::min(count, (b + 1) * block);
+    gsl::index selected = 0;
+    for (auto w = b * block; w < end; ++w)
+      selected += mask::countSet(unmasked(w));
+    offsets[b] = selected;
+  });
+  Vector<gsl::index> indices(
+      parallel::exclusiveScan(blocks + 1, offsets.data()));
+  parallel::forEach(blocks, [&](const gsl::index b) {
+    const auto end = std::min(count, (b + 1) * block);
+    auto out = indices.data() + offsets[b];
+    for (auto w = b * block; w < end; ++w)
+      for (auto bits = unmasked(w); bits != 0; bits &= bits - 1)
+        *out++ = w * mask::bitsPerWord + mask::firstSet(bits);
+  });
+  return indices;
+}
+
+/// Returns the indices i in [0, size) for which `selected(i)` is true, in
+/// order. As in unmaskedIndices, blocks are counted in parallel, scanned, and
+/// then written in parallel.
+template <class Predicate>
+Vector<gsl::index> selectedIndices(const gsl::index size,
+                                   const Predicate &selected) {
+  const auto block = parallel::grainSize;
+  const auto blocks = (size + block - 1) / block;
+  std::vector<gsl::index> offsets(blocks + 1, 0);
+  parallel::forEach(blocks, [&](const gsl::index b) {
+    const auto end = std::min(size, (b + 1) * block);
+    gsl::index count = 0;
+    for (auto i = b * block; i < end; ++i)
+      count += selected(i);
+    offsets[b] = count;
+  });
+  Vector<gsl::index> indices(
+      parallel::exclusiveScan(blocks + 1, offsets.data()));
+  parallel::forEach(blocks, [&](const gsl::index b) {
+    const auto end = std::min(size, (b + 1) * block);
+    auto out = indices.data() + offsets[b];
+    for (auto i = b * block; i < end; ++i)
+      if (selected(i))
+        *out++ = i;
+  });
+  return indices;
+}
+
+/// Slices of `left` and `right` forming the slices of a join, -1 where a
+/// slice is missing on one side.
+struct JoinSlices {
+  Vector<gsl::index> left;
+  Vector<gsl::index> right;
+};
+
+/// Hash join: the index of the keys of `right` is built in parallel, then the
+/// keys of `left` are looked up in parallel, see DatasetIndex. For
+/// JoinMode::Outer the matches of each key of `right` are counted, to append
+/// the keys without a match.
+template <class Tag>
+JoinSlices joinSlices(const Dataset &left, const Dataset &right,
+                      const JoinMode mode, std::true_type) {
+  const DatasetIndex<Tag> index(right);
+  auto matches = index.indices(left.get<const Tag>(), -1);
+  const gsl::index size = matches.size();
+
+  JoinSlices slices;
+  if (mode == JoinMode::Inner) {
+    slices.left = selectedIndices(
+        size, [&](const gsl::index i) { return matches[i] >= 0; });
+    slices.right.resize(slices.left.size());
+    parallel::forEachChunk(slices.left.size(), [&](const gsl::index begin,
+                                                   const gsl::index end) {
+      for (auto i = begin; i < end; ++i)
+        slices.right[i] = matches[slices.left[i]];
+    });
+    return slices;
+  }
+  slices.left.resize(size);
+  std::iota(slices.left.begin(), slices.left.end(), gsl::index{0});
+  slices.right = std::move(matches);
+  if (mode == JoinMode::Outer) {
+    const gsl::index rightSize = right.get<const Tag>().size();
+    std::vector<gsl::index> counts(rightSize, 0);
+    parallel::forEachChunk(size, [&](const gsl::index begin,
+                                     const gsl::index end) {
+      for (auto i = begin; i < end; ++i)
+        if (slices.right[i] >= 0)
+          parallel::fetchAdd(counts[slices.right[i]], gsl::index{1});
+    });
+    const auto unmatched = selectedIndices(
+        rightSize, [&](const gsl::index j) { return counts[j] == 0; });
+    slices.left.resize(size + unmatched.size(), -1);
+    slices.right.insert(slices.right.end(), unmatched.begin(),
+                        unmatched.end());
+  }
+  return slices;
+}
+
+template <class Tag>
+JoinSlices joinSlices(const Dataset &, const Dataset &, const JoinMode,
+                      std::false_type) {
+  throw std::runtime_error("Join key must be a variable of numbers or "
+                           "strings.");
+}
+
+/// Copies the keys of the slices of a join present only in `right`, which
+/// follow the slices of `left`.
+template <class Tag>
+void copyRightKeys(Dataset &result, const Dataset &right,
+                   const JoinSlices &slices, std::true_type) {
+  const auto keys = right.get<const Tag>();
+  auto out = result.get<Tag>();
+  const gsl::index size = slices.left.size();
+  for (gsl::index i = 0; i < size; ++i)
+    if (slices.left[i] < 0)
+      out[i] = keys[slices.right[i]];
+}
+
+template <class Tag>
+void copyRightKeys(Dataset &, const Dataset &, const JoinSlices &,
+                   std::false_type) {}
+
+bool hasKey(const Dataset &d, const Dimension dim, const uint16_t key) {
+  if (!d.dimensions().contains(dim))
+    return false;
+  const Dimensions dims(dim, d.dimensions().size(dim));
+  return std::any_of(d.begin(), d.end(), [&](const Variable &var) {
+    return var.type() == key && var.isCoord() && var.dimensions() == dims;
+  });
+}
+
+/// Returns the coordinate with tag id `key` of `d` used for selecting slices
+/// along `dim`.
+const Variable &selectionAxis(const Dataset &d, const Dimension dim,
+                              const uint16_t key) {
+  const auto axis = std::find_if(d.begin(), d.end(), [&](const Variable &var) {
+    return var.type() == key && var.isCoord();
+  });
+  if (axis == d.end() || !d.dimensions().contains(dim) ||
+      axis->dimensions().count() != 1 ||
+      axis->dimensions().label(0) != dim)
+    throw std::runtime_error("Selection requires a one-dimensional coordinate "
+                             "along the selected dimension.");
+  return *axis;
+}
+
+/// Coordinates of numbers stored contiguously, which are searched directly.
+template <class Tag>
+using is_number = std::integral_constant<
+    bool, std::is_arithmetic<typename Tag::type>::value &&
+              std::is_same<storage_t<Tag>, Vector<typename Tag::type>>::value>;
+
+template <class Tag, class F>
+void callForValues(const Variable &axis, const gsl::index bins, F &f,
+                   std::true_type) {
+  const auto values = axis.get<const Tag>();
+  f(values.begin(), values.end(), bins);
+}
+
+template <class Tag, class F>
+void callForValues(const Variable &, const gsl::index, F &, std::false_type) {
+  throw std::runtime_error("Selection requires a coordinate of numbers.");
+}
+
+/// Calls `f(begin, end, bins)` with iterators to the values of `axis`, the
+/// coordinate along `dim` of `d`, and the number of bins if `axis` holds bin
+/// edges, else -1.
+template <class F>
+void callForAxis(const Dataset &d, const Dimension dim, const uint16_t key,
+                 F &&f) {
+  const auto &axis = selectionAxis(d, dim, key);
+  const auto size = d.dimensions().size(dim);
+  const auto bins = axis.dimensions().size(dim) == size + 1 ? size : -1;
+  callForTag(key, [&](auto tag) {
+    using Tag = decltype(tag);
+    callForValues<Tag>(axis, bins, f, is_number<Tag>{});
+  });
+}
+
+}
+
+Dataset sort(const Dataset &d, const Dimension dim, const uint16_t key) {
+  const auto &keyVar = d[d.find(key, "")];
+  if (!d.dimensions().contains(dim) ||
+      !(keyVar.dimensions() == Dimensions(dim, d.dimensions().size(dim))))
+    throw std::runtime_error("Sort key must be a one-dimensional variable "
+                             "along the sorted dimension.");
+  Vector<gsl::index> order;
+  callForTag(key, [&](auto tag) {
+    using Tag = decltype(tag);
+    order = sortPermutation<Tag>(keyVar, is_key<Tag>{});
+  });
+
+  return gatherSlices(d, dim, order, "sort");
+}
+
+Dataset filter(const Dataset &d, const Dimension dim, const Variable &mask) {
+  if (!mask.valueTypeIs<Coord::Mask>() || !d.dimensions().contains(dim) ||
+      !(mask.dimensions() == Dimensions(dim, d.dimensions().size(dim))))
+    throw std::runtime_error("Mask must be a one-dimensional Coord::Mask "
+                             "variable along the filtered dimension.");
+  const auto indices =
+      unmaskedIndices(mask.get<const Coord::Mask>().column());
+  if (indices.empty())
+    throw std::runtime_error("Cannot filter out all slices.");
+  return gatherSlices(d, dim, indices, "filter");
+}
+
+Dataset join(const Dataset &left, const Dataset &right, const Dimension dim,
+             const uint16_t key, const JoinMode mode) {
+  if (!hasKey(left, dim, key) || !hasKey(right, dim, key))
+    throw std::runtime_error("Join key must be a one-dimensional coordinate "
+                             "along the joined dimension in both datasets.");
+  JoinSlices slices;
+  callForTag(key, [&](auto tag) {
+    using Tag = decltype(tag);
+    slices = joinSlices<Tag>(left, right, mode, is_key<Tag>{});
+  });
+  if (slices.left.empty())
+    throw std::runtime_error("Cannot join datasets without matching keys.");
+
+  auto result = gatherSlices(left, dim, slices.left, "join");
+  if (mode == JoinMode::Outer)
+    callForTag(key, [&](auto tag) {
+      using Tag = decltype(tag);
+      copyRightKeys<Tag>(result, right, slices, is_key<Tag>{});
+    });
+  Dataset other;
+  for (const auto &var : right)
+    if (var.type() != key || !var.isCoord())
+      insertCopy(other, var, right.dimensions());
+  if (other.dimensions().contains(dim))
+    other = gatherSlices(other, dim, slices.right, "join");
+  for (const auto &var : other) {
+    if (var.dimensions().contains(dim)) {
+      result.insert(var);
+      continue;
+    }
+    const auto shared =
+        std::find_if(result.begin(), result.end(), [&](const Variable &item) {
+          return item.type() == var.type() && item.name() == var.name();
+        });
+    if (shared == result.end())
+      insertCopy(result, var, other.dimensions());
+    else if (!(*shared == var))
+      throw std::runtime_error("Cannot join datasets with different variables "
+                               "not depending on the joined dimension.");
+  }
+  return result;
+}
+
+std::pair<gsl::index, gsl::index> selectRange(const Dataset &d,
+                                              const Dimension dim,
+                                              const uint16_t key,
+                                              const double lo,
+                                              const double hi) {
+  std::pair<gsl::index, gsl::index> range;
+  callForAxis(d, dim, key, [&](const auto begin, const auto end,
+                               const gsl::index bins) {
+    if (bins < 0) {
+      range.first = std::lower_bound(begin, end, lo) - begin;
+      range.second = std::lower_bound(begin, end, hi) - begin;
+    } else {
+      // Bin i spans [edges[i], edges[i + 1]).
+      range.first = std::max(
+          gsl::index{0}, (std::upper_bound(begin, end, lo) - begin) - 1);
+      range.second = std::min(bins, std::lower_bound(begin, end, hi) - begin);
+    }
+    range.second = std::max(range.first, range.second);
+  });
+  return range;
+}
+
+Dataset select(const Dataset &d, const Dimension dim, const uint16_t key,
+               const double lo, const double hi) {
+  const auto range = selectRange(d, dim, key, lo, hi);
+  if (range.first == range.second)
+    throw std::runtime_error("Cannot select an empty range.");
+  auto dims = d.dimensions();
+  dims.resize(dim, range.second - range.first);
+  Vector<gsl::index> indices(range.second - range.first + 1);
+  std::iota(indices.begin(), indices.end(), range.first);
+  Dataset result;
+  for (const auto &var : d) {
+    const auto &varDims = var.dimensions();
+    if (!varDims.contains(dim)) {
+      insertCopy(result, var, d.dimensions());
+      continue;
+    }
+    // Bin edges include the edge following the last bin.
+    const auto edges = varDims.size(dim) == d.dimensions().size(dim) + 1;
+    const auto count = dims.size(dim) + (edges ? 1 : 0);
+    insertCopy(result,
+               gather(var, dim,
+                      gsl::span<const gsl::index>(indices.data(), count)),
+               dims);
+  }
+  return result;
+}
+
+gsl::index nearest(const Dataset &d, const Dimension dim, const uint16_t key,
+                   const double value) {
+  gsl::index index = 0;
+  callForAxis(d, dim, key, [&](const auto begin, const auto end,
+                               const gsl::index bins) {
+    if (bins < 0) {
+      index = std::lower_bound(begin, end, value) - begin;
+      if (index == end - begin ||
+          (index > 0 && value - begin[index - 1] <= begin[index] - value))
+        --index;
+    } else {
+      index = std::min(bins - 1,
+                       std::max(gsl::index{0},
+                                (std::upper_bound(begin, end, value) - begin) -
+                                    1));
+    }
+  });
+  return index;
+}
@@ -0,0 +1,103 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef SORT_H
+#define SORT_H
+
+#include <utility>
+
+#include "dataset.h"
+
+/// Returns `d` with the slices along `dim` reordered such that the coordinate
+/// with tag id `key`, a one-dimensional variable along `dim`, is ascending,
+/// e.g., to sort the rows of a table by Coord::Temperature. The sort is stable
+/// and NaN is sorted last. Keys must be numbers or strings. All variables
+/// depending on `dim` are permuted, variables not depending on `dim` share
+/// their data with `d`.
+Dataset sort(const Dataset &d, const Dimension dim, const uint16_t key);
+
+template <class Tag> Dataset sort(const Dataset &d, const Dimension dim) {
+  static_assert(is_coord<Tag>, "Sort key must be a coordinate.");
+  return sort(d, dim, tag_id<Tag>);
+}
+
+/// Returns `d` without the slices along `dim` that are masked by `mask`, a
+/// one-dimensional Coord::Mask variable along `dim`, e.g., to drop masked
+/// spectra or the rows of a table not matching a predicate. All variables
+/// depending on `dim` are compacted, variables not depending on `dim` share
+/// their data with `d`. Throws if all slices are masked, since dimensions
+/// cannot be empty.
+Dataset filter(const Dataset &d, const Dimension dim, const Variable &mask);
+
+enum class JoinMode { Inner, Left, Outer };
+
+/// Returns the slices along `dim` of `left` and `right` combined on equal
+/// values of the coordinate with tag id `key`, a one-dimensional variable along
+/// `dim` in both, e.g., to join a calibration table onto a table of detectors
+/// along Dimension::Row by Coord::DetectorId. Values of the key must be unique
+/// in `right` and may repeat in `left`. The result has the slices of `left`
+/// with a matching key for JoinMode::Inner, all slices of `left` for
+/// JoinMode::Left, and in addition the slices of `right` without a matching
+/// key for JoinMode::Outer, in this order. Values missing in a slice are NaN
+/// for floating-point variables and default-constructed otherwise. Apart from
+/// the key the datasets must not share variables depending on `dim`. Variables
+/// not depending on `dim` are taken from `left`, and from `right` if `left`
+/// does not contain them.
+Dataset join(const Dataset &left, const Dataset &right, const Dimension dim,
+             const uint16_t key, const JoinMode mode = JoinMode::Inner);
+
+template <class Tag>
+Dataset join(const Dataset &left, const Dataset &right, const Dimension dim,
+             const JoinMode mode = JoinMode::Inner) {
+  static_assert(is_coord<Tag>, "Join key must be a coordinate.");
+  return join(left, right, dim, tag_id<Tag>, mode);
+}
+
+/// Returns the range [begin, end) of slices along `dim` whose coordinate with
+/// tag id `key`, a one-dimensional variable of numbers along `dim` sorted in
+/// ascending order, lies within [lo, hi), e.g., a range of Coord::Temperature.
+/// For bin edges, e.g., of Coord::Tof, the range contains the bins
+/// overlapping [lo, hi). Bounds are found by binary search. The range is empty
+/// if no slice lies within [lo, hi).
+std::pair<gsl::index, gsl::index> selectRange(const Dataset &d,
+                                              const Dimension dim,
+                                              const uint16_t key,
+                                              const double lo,
+                                              const double hi);
+/// Returns `d` with the slices along `dim` in selectRange(d, dim, key, lo, hi).
+/// Variables not depending on `dim` share their data with `d`. Throws if the
+/// range is empty, since dimensions cannot be empty.
+Dataset select(const Dataset &d, const Dimension dim, const uint16_t key,
+               const double lo, const double hi);
+/// Returns the slice along `dim` whose coordinate with tag id `key`, as for
+/// selectRange, is nearest to `value`, the first of two equally near slices.
+/// For bin edges this is the bin containing `value`, or the first or last bin
+/// for values outside the edges.
+gsl::index nearest(const Dataset &d, const Dimension dim, const uint16_t key,
+                   const double value);
+
+template <class Tag>
+std::pair<gsl::index, gsl::index> selectRange(const Dataset &d,
+                                              const Dimension dim,
+                                              const double lo,
+                                              const double hi) {
+  static_assert(is_coord<Tag>, "Selection requires a coordinate.");
+  return selectRange(d, dim, tag_id<Tag>, lo, hi);
+}
+
+template <class Tag>
+Dataset select(const Dataset &d, const Dimension dim, const double lo,
+               const double hi) {
+  static_assert(is_coord<Tag>, "Selection requires a coordinate.");
+  return select(d, dim, tag_id<Tag>, lo, hi);
+}
+
+template <class Tag>
+gsl::index nearest(const Dataset &d, const Dimension dim, const double value) {
+  static_assert(is_coord<Tag>, "Selection requires a coordinate.");
+  return nearest(d, dim, tag_id<Tag>, value);
+}
+
+#endif // SORT_H
@@ -0,0 +1,45 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <stdexcept>
+
+#include "string_column.h"
+
+DictionaryColumn::DictionaryColumn(const gsl::index size) {
+  if (size > 0)
+    m_codes.resize(size, encode(""));
+}
+
+DictionaryColumn::DictionaryColumn(Vector<int32_t> codes,
+                                   StringColumn dictionary)
+    : m_codes(std::move(codes)), m_dictionary(std::move(dictionary)) {
+  for (const auto code : m_codes)
+    if (code < 0 || code >= m_dictionary.size())
+      throw std::runtime_error("Dictionary code out of range.");
+}
+
+void DictionaryColumn::resize(const gsl::index size) {
+  if (size <= this->size())
+    m_codes.resize(size);
+  else
+    m_codes.resize(size, encode(""));
+}
+
+bool DictionaryColumn::operator==(const DictionaryColumn &other) const {
+  if (size() != other.size())
+    return false;
+  if (m_dictionary == other.m_dictionary)
+    return m_codes == other.m_codes;
+  return std::equal(begin(), end(), other.begin());
+}
+
+int32_t DictionaryColumn::encode(const_reference value) {
+  for (gsl::index i = 0; i < m_dictionary.size(); ++i)
+    if (m_dictionary[i] == value)
+      return i;
+  m_dictionary.push_back(value);
+  return m_dictionary.size() - 1;
+}
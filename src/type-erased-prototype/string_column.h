@@ -0,0 +1,90 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#ifndef STRING_COLUMN_H
+#define STRING_COLUMN_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#include <boost/utility/string_view.hpp>
+#include <gsl/gsl_util>
+
+#include "column_span.h"
+#include "list_column.h"
+#include "vector.h"
+
+/// Columnar storage for strings: all characters are stored in a single buffer
+/// with offsets marking the start of each string, see ListColumn.
+using StringColumn = ListColumn<char, boost::string_view, std::string>;
+
+/// Dictionary-encoded strings: each element is a code referring to an entry of
+/// a dictionary of unique strings. For low-cardinality labels such as
+/// Coord::Polarization this is much more compact than StringColumn and
+/// comparing elements is comparing integers. Assignment searches the dictionary
+/// linearly, so this is unsuitable for columns with many distinct values.
+class DictionaryColumn {
+public:
+  using value_type = std::string;
+  using const_reference = boost::string_view;
+  using reference = ColumnReference<DictionaryColumn>;
+  using const_iterator = ColumnIterator<const DictionaryColumn>;
+  using iterator = ColumnIterator<DictionaryColumn>;
+
+  DictionaryColumn() = default;
+  explicit DictionaryColumn(const gsl::index size);
+  template <class InputIt> DictionaryColumn(InputIt first, InputIt last);
+  template <class T>
+  DictionaryColumn(std::initializer_list<T> values)
+      : DictionaryColumn(values.begin(), values.end()) {}
+  template <class T, class Allocator>
+  DictionaryColumn(const std::vector<T, Allocator> &values)
+      : DictionaryColumn(values.begin(), values.end()) {}
+  /// Creates a column from existing codes and dictionary. The dictionary does
+  /// not need to be unique.
+  DictionaryColumn(Vector<int32_t> codes, StringColumn dictionary);
+
+  gsl::index size() const { return m_codes.size(); }
+  bool empty() const { return m_codes.empty(); }
+  void resize(const gsl::index size);
+
+  const_reference operator[](const gsl::index i) const {
+    return m_dictionary[m_codes[i]];
+  }
+  reference operator[](const gsl::index i) { return {*this, i}; }
+
+  const_iterator begin() const { return {*this, 0}; }
+  const_iterator end() const { return {*this, size()}; }
+  iterator begin() { return {*this, 0}; }
+  iterator end() { return {*this, size()}; }
+
+  void assign(const gsl::index i, const_reference value) {
+    m_codes[i] = encode(value);
+  }
+  void push_back(const_reference value) { m_codes.push_back(encode(value)); }
+
+  const Vector<int32_t> &codes() const { return m_codes; }
+  const StringColumn &dictionary() const { return m_dictionary; }
+
+  bool operator==(const DictionaryColumn &other) const;
+  bool operator!=(const DictionaryColumn &other) const {
+    return !(*this == other);
+  }
+
+private:
+  int32_t encode(const_reference value);
+
+  Vector<int32_t> m_codes;
+  StringColumn m_dictionary;
+};
+
+template <class InputIt>
+DictionaryColumn::DictionaryColumn(InputIt first, InputIt last) {
+  for (; first != last; ++first)
+    push_back(*first);
+}
+
+#endif // STRING_COLUMN_H
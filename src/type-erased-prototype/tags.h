@@ -6,12 +6,22 @@
 #ifndef TAGS_H
 #define TAGS_H
 
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <gsl/gsl_util>
 
+#include "list_column.h"
+#include "mask_column.h"
+#include "position_column.h"
+#include "string_column.h"
 #include "unit.h"
+#include "vector.h"
 
 namespace detail {
 template <class T, class Tuple> struct index;
@@ -55,25 +65,31 @@ struct Coord {
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct DetectorPosition {
-    // Dummy for now, should be something like Eigen::Vector3d.
-    using type = double;
+    using type = Position;
+    using storage_type = PositionColumn;
     static constexpr auto unit = Unit::Id::Length;
   };
   struct DetectorGrouping {
-    // Dummy for now, or sufficient like this?
+    // Detector indices for each spectrum.
     using type = std::vector<gsl::index>;
+    using storage_type = IndexListColumn;
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct SpectrumPosition : public detail::ReturnByValuePolicy {
-    using type = double;
+    // Mean position of the detectors of a spectrum.
+    using type = Position;
+    using storage_type = PositionColumn;
   };
   struct RowLabel {
     using type = std::string;
+    using storage_type = StringColumn;
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct Polarization {
     // Dummy for now
     using type = std::string;
+    // Few distinct values, typically repeated for many spectra.
+    using storage_type = DictionaryColumn;
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct Temperature {
@@ -85,14 +101,65 @@ struct Coord {
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct Mask {
+    // Set for masked elements, e.g., spectra of broken detectors.
     using type = char;
+    using storage_type = MaskColumn;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct Time {
+    // Nanoseconds since epoch, e.g., for time series of logs.
+    using type = int64_t;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct L1 {
+    // Distance from source to sample in m, a variable without dimensions.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Length;
+  };
+  struct L2 {
+    // Distance from sample to each detector in m.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Length;
+  };
+  struct TwoTheta {
+    // Scattering angle of each detector in rad.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct DSpacing {
+    // Angstrom.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct Wavelength {
+    // Angstrom.
+    using type = double;
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
+  struct DeltaE {
+    // Energy transfer in meV.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct SourcePosition {
+    // Variable without dimensions.
+    using type = Position;
+    using storage_type = PositionColumn;
+    static constexpr auto unit = Unit::Id::Length;
+  };
+  struct SamplePosition {
+    // Variable without dimensions.
+    using type = Position;
+    using storage_type = PositionColumn;
+    static constexpr auto unit = Unit::Id::Length;
+  };
 
   using tags =
       std::tuple<X, Y, Z, Tof, MonitorTof, DetectorId, SpectrumNumber,
                  DetectorPosition, DetectorGrouping, SpectrumPosition, RowLabel,
-                 Polarization, Temperature, TimeInterval, Mask>;
+                 Polarization, Temperature, TimeInterval, Mask, Time, L1, L2,
+                 TwoTheta, DSpacing, Wavelength, DeltaE, SourcePosition,
+                 SamplePosition>;
 };
 
 class Histogram;
@@ -122,14 +189,34 @@ struct Data {
   };
   struct String {
     using type = std::string;
+    using storage_type = StringColumn;
     static constexpr auto unit = Unit::Id::Dimensionless;
   };
   struct Histogram {
     using type = ::Histogram;
   };
+  struct PulseTime {
+    // Nanoseconds since epoch.
+    using type = int64_t;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct Weight {
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct WeightVariance {
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
+  struct CumulativeValue {
+    // Sum of the preceding values along a dimension, see integrate.h.
+    using type = double;
+    static constexpr auto unit = Unit::Id::Dimensionless;
+  };
 
   using tags = std::tuple<Tof, Value, Variance, StdDev, Int, DimensionSize,
-                          String, Histogram>;
+                          String, Histogram, PulseTime, Weight, WeightVariance,
+                          CumulativeValue>;
 };
 
 template <class T>
@@ -141,6 +228,61 @@ template <class T>
 static constexpr bool is_coord =
     tag_id<T> < std::tuple_size<Coord::tags>::value;
 
+namespace detail {
+template <class...> using void_t = void;
+template <class Tag, class = void> struct storage {
+  using type = Vector<typename Tag::type>;
+};
+template <class Tag>
+struct storage<Tag, void_t<typename Tag::storage_type>> {
+  using type = typename Tag::storage_type;
+};
+}
+
+/// Type holding the data of a variable with given tag. This is Vector unless
+/// the tag defines `storage_type`, see for example StringColumn.
+template <class Tag>
+using storage_t = typename detail::storage<std::remove_const_t<Tag>>::type;
+
+namespace detail {
+using all_tags = decltype(
+    std::tuple_cat(std::declval<Coord::tags>(), std::declval<Data::tags>()));
+
+// Tags that are computed on the fly or are views into other variables cannot
+// be the type of a Variable.
+template <class Tag>
+using is_stored = std::integral_constant<
+    bool, !std::is_base_of<ReturnByValuePolicy, Tag>::value &&
+              !std::is_same<Tag, Data::Histogram>::value>;
+
+template <class Tag, class F> void callIfStored(F &f, std::true_type) {
+  f(Tag{});
+}
+template <class Tag, class F> void callIfStored(F &, std::false_type) {
+  throw std::runtime_error("Tag does not correspond to a stored variable.");
+}
+
+template <class F, size_t... Is>
+void callForTag(const uint16_t id, F &f, std::index_sequence<Is...>) {
+  static_cast<void>(std::initializer_list<int>{
+      (id == Is ? (callIfStored<std::tuple_element_t<Is, all_tags>>(
+                       f, is_stored<std::tuple_element_t<Is, all_tags>>{}),
+                   0)
+                : 0)...});
+}
+}
+
+/// Calls `f(Tag{})` with the tag corresponding to the runtime type id `id`,
+/// e.g., as returned by Variable::type(). This is the bridge from type-erased
+/// code (Python exports, serialization) back to typed access via `get<Tag>`.
+template <class F> void callForTag(const uint16_t id, F &&f) {
+  if (id >= std::tuple_size<detail::all_tags>::value)
+    throw std::runtime_error("Invalid tag id.");
+  detail::callForTag(
+      id, f,
+      std::make_index_sequence<std::tuple_size<detail::all_tags>::value>{});
+}
+
 class DataBin {
 public:
   DataBin(const double left, const double right)
@@ -158,12 +300,20 @@ private:
 
 template <class T> struct Bin { using type = DataBin; };
 
+namespace detail {
+template <class Tag> struct element_reference {
+  using type = std::conditional_t<std::is_const<Tag>::value,
+                                  typename storage_t<Tag>::const_reference,
+                                  typename storage_t<Tag>::reference>;
+};
+template <class T> struct identity { using type = T; };
+}
+
 template <class Tag> struct element_return_type {
-  using type = std::conditional_t<
+  using type = typename std::conditional_t<
       std::is_base_of<detail::ReturnByValuePolicy, Tag>::value,
-      typename Tag::type,
-      std::conditional_t<std::is_const<Tag>::value, const typename Tag::type &,
-                         typename Tag::type &>>;
+      detail::identity<typename Tag::type>,
+      detail::element_reference<Tag>>::type;
 };
 
 template <class Tags> struct element_return_type<Bin<Tags>> {
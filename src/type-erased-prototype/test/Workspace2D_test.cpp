@@ -22,8 +22,10 @@ TEST(Workspace2D, multi_dimensional_merging_and_slicing) {
   // d.insert<Coord::Instrument>({}, Beamline::ComponentInfo{});
   d.insert<Coord::DetectorId>({Dimension::Detector, 4},
                               {1001, 1002, 1003, 1004});
-  d.insert<Coord::DetectorPosition>({Dimension::Detector, 4},
-                                    {1.0, 2.0, 4.0, 8.0});
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 4},
+      {Position{{1.0, 0.0, 0.0}}, Position{{2.0, 0.0, 0.0}},
+       Position{{4.0, 0.0, 0.0}}, Position{{8.0, 0.0, 0.0}}});
 
   // Spectrum to detector mapping and spectrum numbers.
   Vector<std::vector<gsl::index>> grouping = {{0, 2}, {1}, {}};
@@ -134,8 +136,10 @@ TEST(Workspace2D, scanning) {
   // d.insert<Coord::Instrument>({}, Beamline::ComponentInfo{});
   d.insert<Coord::DetectorId>({Dimension::Detector, 4},
                               {1001, 1002, 1003, 1004});
-  d.insert<Coord::DetectorPosition>({Dimension::Detector, 4},
-                                    {1.0, 2.0, 3.0, 4.0});
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 4},
+      {Position{{1.0, 0.0, 0.0}}, Position{{2.0, 0.0, 0.0}},
+       Position{{3.0, 0.0, 0.0}}, Position{{4.0, 0.0, 0.0}}});
 
   // In the current implementation in Mantid, ComponentInfo holds a reference to
   // DetectorInfo. Now the contents of DetectorInfo are simply variables in the
@@ -153,8 +157,8 @@ TEST(Workspace2D, scanning) {
   //   }
   // };
   auto moved(d);
-  for (auto &pos : moved.get<Coord::DetectorPosition>())
-    pos += 0.5;
+  for (auto &x : moved.get<Coord::DetectorPosition>().column().x())
+    x += 0.5;
 
   auto scanning = concatenate(Dimension::DetectorScan, d, moved);
   scanning.insert<Coord::TimeInterval>(
@@ -176,9 +180,9 @@ TEST(Workspace2D, scanning) {
   DatasetView<Coord::SpectrumPosition> view(scanning);
   ASSERT_EQ(view.size(), 3);
   auto it = view.begin();
-  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), 1.0);
-  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), 3.0);
-  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), 1.5);
+  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), (Position{{1.0, 0.0, 0.0}}));
+  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), (Position{{3.0, 0.0, 0.0}}));
+  EXPECT_EQ(it++->get<Coord::SpectrumPosition>(), (Position{{1.5, 0.0, 0.0}}));
 }
 
 TEST(Workspace2D, masking) {
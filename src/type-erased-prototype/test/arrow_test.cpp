@@ -0,0 +1,182 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "arrow.h"
+
+Dataset makeTable() {
+  Dataset table;
+  table.insert<Coord::RowLabel>({Dimension::Row, 3},
+                                Vector<std::string>{"a", "bc", ""});
+  table.insert<Data::Value>("Data", {Dimension::Row, 3}, {1.0, -2.0, 3.0});
+  table.insert<Data::String>("Comment", {Dimension::Row, 3},
+                             Vector<std::string>{"", "negative", ""});
+  return table;
+}
+
+void expectEqual(const Dataset &a, const Dataset &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (gsl::index i = 0; i < a.size(); ++i)
+    EXPECT_EQ(a[i], b[i]);
+}
+
+TEST(Arrow, export_schema) {
+  const auto table = makeTable();
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(table, &schema, &array);
+
+  EXPECT_STREQ(schema.format, "+s");
+  ASSERT_EQ(schema.n_children, 3);
+  EXPECT_STREQ(schema.children[0]->format, "U");
+  EXPECT_STREQ(schema.children[0]->name, "RowLabel");
+  EXPECT_STREQ(schema.children[1]->format, "g");
+  EXPECT_STREQ(schema.children[1]->name, "Data");
+  EXPECT_STREQ(schema.children[2]->format, "U");
+  EXPECT_STREQ(schema.children[2]->name, "Comment");
+
+  EXPECT_EQ(array.length, 3);
+  ASSERT_EQ(array.n_children, 3);
+  const auto &labels = *array.children[0];
+  const auto offsets = static_cast<const int64_t *>(labels.buffers[1]);
+  const auto chars = static_cast<const char *>(labels.buffers[2]);
+  EXPECT_EQ(std::string(chars + offsets[1], chars + offsets[2]), "bc");
+
+  array.release(&array);
+  schema.release(&schema);
+  EXPECT_EQ(array.release, nullptr);
+  EXPECT_EQ(schema.release, nullptr);
+}
+
+TEST(Arrow, export_is_zero_copy) {
+  auto table = makeTable();
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(table, &schema, &array);
+  const auto values =
+      static_cast<const double *>(array.children[1]->buffers[1]);
+  EXPECT_EQ(values, table.get<const Data::Value>().data());
+
+  // Exported data is kept alive and is not affected by modifications.
+  table.get<Data::Value>()[0] = 10.0;
+  table = Dataset();
+  EXPECT_EQ(values[0], 1.0);
+  EXPECT_EQ(values[1], -2.0);
+
+  array.release(&array);
+  schema.release(&schema);
+}
+
+TEST(Arrow, export_strings_is_zero_copy) {
+  const auto table = makeTable();
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(table, &schema, &array);
+  const auto &comments = table.get<const Data::String>("Comment").column();
+  EXPECT_EQ(array.children[2]->buffers[1], comments.offsets().data());
+  EXPECT_EQ(array.children[2]->buffers[2], comments.values().data());
+  array.release(&array);
+  schema.release(&schema);
+}
+
+TEST(Arrow, export_dictionary) {
+  Dataset d;
+  d.insert<Coord::Polarization>(
+      {Dimension::Polarization, 3},
+      Vector<std::string>{"spin-up", "spin-down", "spin-up"});
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(d, &schema, &array);
+  EXPECT_STREQ(schema.children[0]->format, "i");
+  ASSERT_NE(schema.children[0]->dictionary, nullptr);
+  EXPECT_STREQ(schema.children[0]->dictionary->format, "U");
+  const auto &column = *array.children[0];
+  EXPECT_EQ(static_cast<const int32_t *>(column.buffers[1])[2], 0);
+  ASSERT_NE(column.dictionary, nullptr);
+  EXPECT_EQ(column.dictionary->length, 2);
+
+  const auto imported = importFromArrow(&schema, &array);
+  expectEqual(imported, d);
+}
+
+TEST(Arrow, export_fail) {
+  Dataset d;
+  ArrowSchema schema;
+  ArrowArray array;
+  EXPECT_THROW_MSG(exportToArrow(d, &schema, &array), std::runtime_error,
+                   "Arrow export requires a Dataset with a single dimension.");
+  d.insert<Data::Value>("a", {Dimension::Row, 2}, 2);
+  d.insert<Data::Value>("b", {Dimension::X, 2}, 2);
+  EXPECT_THROW_MSG(exportToArrow(d, &schema, &array), std::runtime_error,
+                   "Arrow export requires a Dataset with a single dimension.");
+}
+
+TEST(Arrow, roundtrip) {
+  const auto table = makeTable();
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(table, &schema, &array);
+  const auto imported = importFromArrow(&schema, &array);
+  EXPECT_EQ(array.release, nullptr);
+  EXPECT_EQ(schema.release, nullptr);
+  expectEqual(imported, table);
+}
+
+TEST(Arrow, roundtrip_nested_types) {
+  Dataset d;
+  d.insert<Coord::TimeInterval>(
+      {Dimension::Temperature, 2},
+      Vector<std::pair<int64_t, int64_t>>{{1, 2}, {3, 4}});
+  d.insert<Coord::DetectorGrouping>(
+      {Dimension::Temperature, 2},
+      Vector<std::vector<gsl::index>>{{1, 2, 3}, {}});
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Temperature, 2},
+      {Position{{1.0, 2.0, 3.0}}, Position{{4.0, 5.0, 6.0}}});
+  d.insert<Coord::Mask>({Dimension::Temperature, 2}, Vector<char>{0, 1});
+  d.insert<Data::Int>("counts", {Dimension::Temperature, 2},
+                      Vector<int64_t>{7, 8});
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(d, &schema, &array);
+  EXPECT_STREQ(schema.children[0]->format, "+w:2");
+  EXPECT_STREQ(schema.children[1]->format, "+L");
+  EXPECT_STREQ(schema.children[2]->format, "+s");
+  EXPECT_STREQ(schema.children[3]->format, "b");
+  EXPECT_EQ(array.children[2]->children[1]->buffers[1],
+            d.get<const Coord::DetectorPosition>().column().y().data());
+  EXPECT_EQ(array.children[3]->buffers[1],
+            d.get<const Coord::Mask>().column().words().data());
+  expectEqual(importFromArrow(&schema, &array), d);
+}
+
+TEST(Arrow, import_sliced_without_metadata) {
+  const auto table = makeTable();
+  ArrowSchema schema;
+  ArrowArray array;
+  exportToArrow(table, &schema, &array);
+  // Drop our metadata to simulate data produced by another library, and take
+  // a slice via the offset.
+  for (int64_t i = 0; i < schema.n_children; ++i)
+    schema.children[i]->metadata = nullptr;
+  schema.metadata = nullptr;
+  array.length = 2;
+  for (int64_t i = 0; i < array.n_children; ++i) {
+    array.children[i]->offset = 1;
+    array.children[i]->length = 2;
+  }
+  const auto imported = importFromArrow(&schema, &array);
+
+  ASSERT_EQ(imported.size(), 3);
+  EXPECT_EQ(imported.dimensions(), Dimensions(Dimension::Row, 2));
+  EXPECT_EQ(imported[0].name(), "RowLabel");
+  EXPECT_EQ(imported.get<const Data::String>("RowLabel")[0], "bc");
+  EXPECT_EQ(imported.get<const Data::String>("RowLabel")[1], "");
+  EXPECT_EQ(imported.get<const Data::Value>("Data")[0], -2.0);
+  EXPECT_EQ(imported.get<const Data::String>("Comment")[0], "negative");
+}
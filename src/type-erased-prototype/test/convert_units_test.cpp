@@ -0,0 +1,192 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "test_macros.h"
+
+#include "convert_units.h"
+
+namespace {
+// Wavelength in Angstrom for 1 microsecond over 1 m.
+constexpr double wavelengthPerTof = 3.956034e-3;
+
+/// Two spectra, the first with detector 0, the second with detectors 1 and 2,
+/// i.e., with mean L2 of 3 m and mean two-theta of 90 degrees.
+Dataset makeInstrument() {
+  Dataset d;
+  d.insert<Coord::L1>({}, {10.0});
+  d.insert<Coord::L2>({Dimension::Detector, 3}, {1.0, 2.0, 4.0});
+  d.insert<Coord::TwoTheta>({Dimension::Detector, 3},
+                            {M_PI / 2.0, M_PI / 3.0, 2.0 * M_PI / 3.0});
+  d.insert<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, 2},
+      Vector<std::vector<gsl::index>>{{0}, {1, 2}});
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 2}, {1, 2});
+  return d;
+}
+
+Dataset makeHistograms(const Variable &tof) {
+  auto d = makeInstrument();
+  d.insertAsEdge(Dimension::Tof, tof);
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}});
+  d.insert<Data::Value>("sample", dims, {1.0, 2.0, 3.0, 4.0});
+  d.insert<Data::Variance>("sample", dims, {1.0, 2.0, 3.0, 4.0});
+  return d;
+}
+}
+
+TEST(ConvertUnits, wavelength) {
+  const auto d = makeHistograms(makeVariable<Coord::Tof>(
+      {Dimension::Tof, 3}, {1000.0, 2000.0, 3000.0}));
+  const auto result = convertUnits(d, Dimension::Wavelength);
+
+  EXPECT_FALSE(result.dimensions().contains(Dimension::Tof));
+  const Dimensions edgeDims(
+      {{Dimension::Wavelength, 3}, {Dimension::Spectrum, 2}});
+  EXPECT_EQ(result.dimensions<Coord::Wavelength>(), edgeDims);
+  const auto wavelength = result.get<const Coord::Wavelength>();
+  for (gsl::index i = 0; i < 3; ++i) {
+    const double tof = 1000.0 * (i + 1);
+    EXPECT_NEAR(wavelength[i], tof * wavelengthPerTof / 11.0, 1e-6);
+    EXPECT_NEAR(wavelength[3 + i], tof * wavelengthPerTof / 13.0, 1e-6);
+  }
+
+  // Data is unchanged, only the dimension label is replaced.
+  const Dimensions dims({{Dimension::Wavelength, 2}, {Dimension::Spectrum, 2}});
+  EXPECT_EQ(result.dimensions<Data::Value>("sample"), dims);
+  EXPECT_EQ(result.get<const Data::Value>("sample"),
+            d.get<const Data::Value>("sample"));
+  EXPECT_EQ(result.get<const Data::Variance>("sample"),
+            d.get<const Data::Variance>("sample"));
+  EXPECT_EQ(result.get<const Coord::SpectrumNumber>(),
+            d.get<const Coord::SpectrumNumber>());
+  EXPECT_EQ(result.get<const Coord::L2>(), d.get<const Coord::L2>());
+}
+
+TEST(ConvertUnits, dspacing_spectrum_tof) {
+  const auto d = makeHistograms(makeVariable<Coord::Tof>(
+      Dimensions({{Dimension::Tof, 3}, {Dimension::Spectrum, 2}}),
+      {1000.0, 2000.0, 3000.0, 1500.0, 2500.0, 3500.0}));
+  const auto result = convertUnits(d, Dimension::DSpacing);
+
+  const auto dspacing = result.get<const Coord::DSpacing>();
+  ASSERT_EQ(dspacing.size(), 6);
+  const auto tof = d.get<const Coord::Tof>();
+  for (gsl::index i = 0; i < 3; ++i) {
+    EXPECT_NEAR(dspacing[i],
+                tof[i] * wavelengthPerTof / (11.0 * 2.0 * std::sin(M_PI / 4)),
+                1e-6);
+    EXPECT_NEAR(dspacing[3 + i],
+                tof[3 + i] * wavelengthPerTof /
+                    (13.0 * 2.0 * std::sin(M_PI / 4)),
+                1e-6);
+  }
+}
+
+TEST(ConvertUnits, energy_transfer) {
+  // For 25 meV the elastic time of flight over 11 m is 5029.8 microseconds,
+  // the time of flight to the sample 4572.5 microseconds.
+  auto d = makeInstrument();
+  d.insert<Coord::Tof>({Dimension::Tof, 3}, {4000.0, 5029.797, 6000.0});
+  d.insert<Data::Value>("sample", Dimensions({{Dimension::Tof, 3},
+                                              {Dimension::Spectrum, 2}}),
+                        6, 1.0);
+  const auto result = convertUnits(d, Dimension::DeltaE, 25.0);
+
+  const auto deltaE = result.get<const Coord::DeltaE>();
+  ASSERT_EQ(deltaE.size(), 6);
+  EXPECT_TRUE(std::isnan(deltaE[0]));
+  EXPECT_NEAR(deltaE[1], 0.0, 1e-3);
+  EXPECT_GT(deltaE[2], deltaE[1]);
+  EXPECT_LT(deltaE[2], 25.0);
+  // Longer flight path in the second spectrum.
+  EXPECT_LT(deltaE[4], deltaE[1]);
+}
+
+TEST(ConvertUnits, from_positions) {
+  // Same flight paths as makeInstrument, given by positions.
+  auto d = makeInstrument();
+  d.erase<Coord::L1>();
+  d.erase<Coord::L2>();
+  d.erase<Coord::TwoTheta>();
+  d.insert<Coord::SourcePosition>({}, {Position{{0.0, 0.0, -10.0}}});
+  d.insert<Coord::SamplePosition>({}, {Position{{0.0, 0.0, 0.0}}});
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 3},
+      {Position{{1.0, 0.0, 0.0}},
+       Position{{0.0, 2.0 * std::sin(M_PI / 3.0), 2.0 * std::cos(M_PI / 3.0)}},
+       Position{{0.0, -4.0 * std::sin(M_PI / 3.0),
+                 -4.0 * std::cos(M_PI / 3.0)}}});
+  d.insert<Coord::Tof>({Dimension::Tof, 3}, {1000.0, 2000.0, 3000.0});
+
+  const auto reference =
+      convertUnits(makeHistograms(makeVariable<Coord::Tof>(
+                       {Dimension::Tof, 3}, {1000.0, 2000.0, 3000.0})),
+                   Dimension::DSpacing);
+  const auto expected = reference.get<const Coord::DSpacing>();
+  const auto result = convertUnits(d, Dimension::DSpacing);
+  const auto dspacing = result.get<const Coord::DSpacing>();
+  ASSERT_EQ(dspacing.size(), expected.size());
+  for (gsl::index i = 0; i < dspacing.size(); ++i)
+    EXPECT_NEAR(dspacing[i], expected[i], 1e-9);
+}
+
+TEST(ConvertUnits, large) {
+  // Enough spectra to run in parallel, checked against the first spectrum.
+  const gsl::index spectra = 100000;
+  Dataset d;
+  d.insert<Coord::L1>({}, {10.0});
+  d.insert<Coord::L2>({Dimension::Detector, spectra}, spectra, 2.0);
+  d.insert<Coord::TwoTheta>({Dimension::Detector, spectra}, spectra, 1.0);
+  Vector<std::vector<gsl::index>> grouping(spectra);
+  for (gsl::index i = 0; i < spectra; ++i)
+    grouping[i] = {i};
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, spectra}, grouping);
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 4},
+                                          {1.0, 2.0, 3.0, 4.0}));
+  const auto result = convertUnits(d, Dimension::DSpacing);
+  const auto dspacing = result.get<const Coord::DSpacing>();
+  ASSERT_EQ(dspacing.size(), 4 * spectra);
+  for (gsl::index i = 0; i < dspacing.size(); ++i)
+    EXPECT_EQ(dspacing[i], dspacing[i % 4]);
+}
+
+TEST(ConvertUnits, fail) {
+  const auto d = makeHistograms(makeVariable<Coord::Tof>(
+      {Dimension::Tof, 3}, {1000.0, 2000.0, 3000.0}));
+  EXPECT_THROW_MSG(convertUnits(d, Dimension::Q), std::runtime_error,
+                   "Unsupported target dimension for unit conversion.");
+  EXPECT_THROW_MSG(convertUnits(d, Dimension::DeltaE), std::runtime_error,
+                   "Conversion to energy transfer requires a positive "
+                   "incident energy.");
+
+  auto missing = makeInstrument();
+  missing.erase<Coord::L1>();
+  missing.insert<Coord::Tof>({Dimension::Tof, 2}, {1.0, 2.0});
+  EXPECT_THROW(convertUnits(missing, Dimension::Wavelength),
+               std::runtime_error);
+
+  auto badGrouping = makeInstrument();
+  badGrouping.erase<Coord::DetectorGrouping>();
+  badGrouping.insert<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, 2}, Vector<std::vector<gsl::index>>{{0}, {3}});
+  badGrouping.insert<Coord::Tof>({Dimension::Tof, 2}, {1.0, 2.0});
+  EXPECT_THROW_MSG(convertUnits(badGrouping, Dimension::Wavelength),
+                   std::runtime_error,
+                   "Detector index in grouping out of range.");
+
+  auto badTof = makeInstrument();
+  badTof.insert<Coord::Tof>(
+      Dimensions({{Dimension::Tof, 2}, {Dimension::Run, 2}}), 4, 1.0);
+  EXPECT_THROW_MSG(convertUnits(badTof, Dimension::Wavelength),
+                   std::runtime_error,
+                   "Time-of-flight coordinate must have Dimension::Tof as "
+                   "inner dimension and otherwise depend only on the "
+                   "dimensions of the spectra.");
+}
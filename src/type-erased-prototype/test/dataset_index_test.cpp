@@ -0,0 +1,105 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "test_macros.h"
+
+#include "dataset_index.h"
+
+TEST(DatasetIndex, dense_integers) {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 4}, {12, 10, 13, 11});
+  DatasetIndex<Coord::SpectrumNumber> index(d);
+  EXPECT_EQ(index[10], 1);
+  EXPECT_EQ(index[13], 2);
+  EXPECT_EQ(index.find(14), -1);
+  EXPECT_EQ(index.find(9), -1);
+  EXPECT_EQ(index.find(-2147483647 - 1), -1);
+  EXPECT_THROW_MSG(index[14], std::runtime_error,
+                   "Axis does not contain the label.");
+}
+
+TEST(DatasetIndex, sparse_integers) {
+  Dataset d;
+  d.insert<Coord::DetectorId>({Dimension::Detector, 3},
+                              {1000000, -7, 2147483647});
+  DatasetIndex<Coord::DetectorId> index(d);
+  EXPECT_EQ(index[1000000], 0);
+  EXPECT_EQ(index[-7], 1);
+  EXPECT_EQ(index[2147483647], 2);
+  EXPECT_EQ(index.find(0), -1);
+}
+
+TEST(DatasetIndex, strings) {
+  Dataset d;
+  d.insert<Coord::RowLabel>({Dimension::Row, 3},
+                            Vector<std::string>{"a", "bb", ""});
+  DatasetIndex<Coord::RowLabel> index(d);
+  EXPECT_EQ(index["bb"], 1);
+  EXPECT_EQ(index[""], 2);
+  EXPECT_EQ(index.find("c"), -1);
+  // Labels of a StringColumn are looked up as views.
+  Dataset other;
+  other.insert<Coord::RowLabel>({Dimension::Row, 4},
+                                Vector<std::string>{"", "c", "a", "bb"});
+  EXPECT_EQ(index.indices(other.get<const Coord::RowLabel>(), -1),
+            (Vector<gsl::index>{2, -1, 0, 1}));
+}
+
+TEST(DatasetIndex, indices) {
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 3}, {0.5, -1.0, 2.0});
+  DatasetIndex<Coord::X> index(d);
+  const Vector<double> keys{2.0, 3.0, 0.5};
+  EXPECT_EQ(index.indices(keys, 7), (Vector<gsl::index>{2, 7, 0}));
+  EXPECT_THROW_MSG(index.indices(keys), std::runtime_error,
+                   "Axis does not contain the label.");
+  const Vector<double> present{-1.0, 0.5};
+  EXPECT_EQ(index.indices(present), (Vector<gsl::index>{1, 0}));
+}
+
+TEST(DatasetIndex, large) {
+  // Dense and sparse labels of an axis large enough to be built in parallel,
+  // in shuffled order.
+  const gsl::index size = 1000003;
+  for (const int32_t stride : {1, 7919}) {
+    Vector<int32_t> labels(size);
+    for (gsl::index i = 0; i < size; ++i)
+      labels[i] = (i * 104729 % size) * stride;
+    Dataset d;
+    d.insert<Coord::DetectorId>({Dimension::Detector, size}, labels);
+    DatasetIndex<Coord::DetectorId> index(d);
+    const auto indices = index.indices(labels);
+    Vector<gsl::index> expected(size);
+    std::iota(expected.begin(), expected.end(), gsl::index{0});
+    EXPECT_EQ(indices, expected);
+    EXPECT_EQ(index.find(-1), -1);
+    EXPECT_EQ(index.find(size * stride), -1);
+  }
+}
+
+TEST(DatasetIndex, duplicates) {
+  for (const int32_t stride : {1, 1000}) {
+    Dataset d;
+    d.insert<Coord::DetectorId>({Dimension::Detector, 3},
+                                {stride, 2 * stride, stride});
+    EXPECT_THROW_MSG(DatasetIndex<Coord::DetectorId>{d}, std::runtime_error,
+                     "Axis contains duplicate labels. Cannot use it to "
+                     "index into the data.");
+  }
+  const gsl::index size = 100000;
+  Vector<int32_t> labels(size);
+  std::iota(labels.begin(), labels.end(), 0);
+  labels[size - 1] = 12345 * 1000;
+  labels[size / 2] = 12345 * 1000;
+  Dataset d;
+  d.insert<Coord::DetectorId>({Dimension::Detector, size}, labels);
+  EXPECT_THROW_MSG(DatasetIndex<Coord::DetectorId>{d}, std::runtime_error,
+                   "Axis contains duplicate labels. Cannot use it to index "
+                   "into the data.");
+}
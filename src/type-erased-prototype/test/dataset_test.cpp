@@ -451,3 +451,44 @@ TEST(Dataset, concatenate) {
   EXPECT_EQ(xy.get<const Coord::X>().size(), 2);
   EXPECT_EQ(xy.get<const Data::Value>().size(), 12);
 }
+
+TEST(Dataset, cache_derived) {
+  Dataset d;
+  d.insert<Data::Variance>("data", {Dimension::X, 2}, {4.0, 9.0});
+  EXPECT_EQ(d.cached<Data::StdDev>(), nullptr);
+  d.enableCache<Data::StdDev>();
+  const auto cache = d.cached<Data::StdDev>();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache, d.cached<Data::StdDev>("data"));
+  EXPECT_EQ(cache->name(), "data");
+  EXPECT_EQ(cache->dimensions(), Dimensions(Dimension::X, 2));
+  EXPECT_EQ(cache->get<const Data::StdDev>()[0], 2.0);
+  EXPECT_EQ(cache->get<const Data::StdDev>()[1], 3.0);
+  // The cache is hidden.
+  EXPECT_EQ(d.size(), 1);
+  // Up to date, no recomputation.
+  EXPECT_EQ(d.cached<Data::StdDev>(), cache);
+}
+
+TEST(Dataset, cache_derived_invalidated_by_source_change) {
+  Dataset d;
+  d.insert<Data::Variance>("data", {Dimension::X, 2}, {4.0, 9.0});
+  d.enableCache<Data::StdDev>("data");
+  EXPECT_EQ(d.cached<Data::StdDev>()->get<const Data::StdDev>()[0], 2.0);
+  const Dataset copy(d);
+
+  d.get<Data::Variance>("data")[0] = 16.0;
+  EXPECT_EQ(d.cached<Data::StdDev>()->get<const Data::StdDev>()[0], 4.0);
+  // The copy keeps the old values.
+  EXPECT_EQ(copy.cached<Data::StdDev>()->get<const Data::StdDev>()[0], 2.0);
+}
+
+TEST(Dataset, cache_derived_fail) {
+  Dataset d;
+  d.insert<Data::Value>("data", {Dimension::X, 2}, 2);
+  EXPECT_THROW_MSG(d.enableCache<Data::Value>("data"), std::runtime_error,
+                   "Only derived variables can be cached.");
+  EXPECT_THROW_MSG(d.enableCache<Coord::SpectrumPosition>(),
+                   std::runtime_error,
+                   "Dataset does not contain such a variable.");
+}
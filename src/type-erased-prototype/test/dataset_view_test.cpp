@@ -598,18 +598,45 @@ TEST(DatasetView, named_variable_and_coordinate) {
   (DatasetView<Coord::X, Data::Value>(d, "name"));
 }
 
+TEST(DatasetView, ragged) {
+  Dimensions dims;
+  dims.add(Dimension::Tof,
+           makeVariable<Data::DimensionSize>({Dimension::Spectrum, 3},
+                                             {2l, 0l, 1l}));
+  dims.add(Dimension::Spectrum, 3);
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {10, 20, 30});
+  d.insert<Data::Value>("events", dims, {1.0, 2.0, 3.0});
+  d.insert<Data::Variance>("events", dims, 3);
+
+  DatasetView<const Coord::SpectrumNumber, Data::Value, Data::Variance> view(
+      d);
+  ASSERT_EQ(view.size(), 3);
+  std::vector<int32_t> spectra;
+  for (const auto &item : view) {
+    item.get<Data::Variance>() = item.value();
+    spectra.push_back(item.get<Coord::SpectrumNumber>());
+  }
+  EXPECT_EQ(spectra, (std::vector<int32_t>{10, 10, 30}));
+  const auto variances = d.get<const Data::Variance>();
+  EXPECT_EQ(Vector<double>(variances.begin(), variances.end()),
+            (Vector<double>{1.0, 2.0, 3.0}));
+}
+
 TEST(DatasetView, spectrum_position) {
   Dataset d;
-  d.insert<Coord::DetectorPosition>({Dimension::Detector, 4},
-                                    {1.0, 2.0, 4.0, 8.0});
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 4},
+      {Position{{1.0, 0.0, 1.0}}, Position{{2.0, 0.0, 1.0}},
+       Position{{4.0, 0.0, 1.0}}, Position{{8.0, 0.0, 1.0}}});
   Vector<std::vector<gsl::index>> grouping = {{0, 2}, {1}, {}};
   d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 3}, grouping);
 
   DatasetView<Coord::SpectrumPosition> view(d);
   auto it = view.begin();
-  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), 2.5);
+  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), (Position{{2.5, 0.0, 1.0}}));
   ++it;
-  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), 2.0);
+  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), (Position{{2.0, 0.0, 1.0}}));
   ++it;
   EXPECT_THROW_MSG(it->get<Coord::SpectrumPosition>(), std::runtime_error,
                    "Spectrum has no detectors, cannot get position.");
@@ -617,6 +644,31 @@ TEST(DatasetView, spectrum_position) {
   ASSERT_EQ(it, view.end());
 }
 
+TEST(DatasetView, spectrum_position_cached) {
+  Dataset d;
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 4},
+      {Position{{1.0, 0.0, 1.0}}, Position{{2.0, 0.0, 1.0}},
+       Position{{4.0, 0.0, 1.0}}, Position{{8.0, 0.0, 1.0}}});
+  Vector<std::vector<gsl::index>> grouping = {{0, 2}, {1}, {}};
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 3}, grouping);
+  d.enableCache<Coord::SpectrumPosition>();
+
+  DatasetView<Coord::SpectrumPosition> view(d);
+  auto it = view.begin();
+  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), (Position{{2.5, 0.0, 1.0}}));
+  ++it;
+  EXPECT_EQ(it->get<Coord::SpectrumPosition>(), (Position{{2.0, 0.0, 1.0}}));
+  ++it;
+  EXPECT_THROW_MSG(it->get<Coord::SpectrumPosition>(), std::runtime_error,
+                   "Spectrum has no detectors, cannot get position.");
+
+  d.get<Coord::DetectorPosition>()[1] = Position{{3.0, 1.0, 2.0}};
+  DatasetView<Coord::SpectrumPosition> updated(d);
+  EXPECT_EQ(std::next(updated.begin())->get<Coord::SpectrumPosition>(),
+            (Position{{3.0, 1.0, 2.0}}));
+}
+
 TEST(DatasetView, derived_standard_deviation) {
   Dataset d;
   d.insert<Data::Variance>("data", {Dimension::X, 3}, {4.0, 9.0, -1.0});
@@ -629,6 +681,19 @@ TEST(DatasetView, derived_standard_deviation) {
   EXPECT_TRUE(std::isnan(it->get<Data::StdDev>()));
 }
 
+TEST(DatasetView, derived_standard_deviation_cached) {
+  Dataset d;
+  d.insert<Data::Variance>("data", {Dimension::X, 3}, {4.0, 9.0, -1.0});
+  d.enableCache<Data::StdDev>();
+  DatasetView<Data::StdDev> view(d);
+  auto it = view.begin();
+  EXPECT_EQ(it->get<Data::StdDev>(), 2.0);
+  ++it;
+  EXPECT_EQ(it->get<Data::StdDev>(), 3.0);
+  ++it;
+  EXPECT_TRUE(std::isnan(it->get<Data::StdDev>()));
+}
+
 template <class T> constexpr int type_to_id();
 template <> constexpr int type_to_id<double>() { return 0; }
 template <> constexpr int type_to_id<int>() { return 1; }
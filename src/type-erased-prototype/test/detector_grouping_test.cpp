@@ -0,0 +1,96 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "dataset.h"
+#include "detector_grouping.h"
+
+using Indices = std::vector<gsl::index>;
+
+TEST(DetectorGrouping, invert) {
+  const IndexListColumn grouping(Vector<Indices>{{0, 2}, {1}, {}, {2, 3}});
+  const auto inverse = invertGrouping(grouping, 5);
+  EXPECT_EQ(inverse,
+            IndexListColumn(Vector<Indices>{{0}, {1}, {0, 3}, {3}, {}}));
+  EXPECT_EQ(invertGrouping(IndexListColumn(), 2),
+            IndexListColumn(Vector<Indices>{{}, {}}));
+}
+
+TEST(DetectorGrouping, invert_fail) {
+  const IndexListColumn grouping(Vector<Indices>{{0, 2}, {-1}});
+  EXPECT_THROW_MSG(invertGrouping(grouping, 3), std::runtime_error,
+                   "Detector index in grouping out of range.");
+  EXPECT_THROW_MSG(invertGrouping(IndexListColumn(Vector<Indices>{{3}}), 3),
+                   std::runtime_error,
+                   "Detector index in grouping out of range.");
+}
+
+TEST(DetectorGrouping, invert_large) {
+  // Large enough to run in parallel. Spectrum i contains detectors i and
+  // (i + 1) % n, and every 100th spectrum also contains detector 0.
+  const gsl::index n = 200000;
+  IndexListColumn grouping;
+  for (gsl::index i = 0; i < n; ++i) {
+    Indices detectors{i, (i + 1) % n};
+    if (i % 100 == 50)
+      detectors.push_back(0);
+    grouping.push_back(detectors);
+  }
+  const auto inverse = invertGrouping(grouping, n);
+  ASSERT_EQ(inverse.size(), n);
+  EXPECT_EQ(inverse[0].size(), 2 + n / 100);
+  for (gsl::index i = 1; i < inverse[0].size(); ++i)
+    EXPECT_LT(inverse[0][i - 1], inverse[0][i]);
+  for (gsl::index det = 1; det < n; ++det) {
+    ASSERT_EQ(inverse[det].size(), 2);
+    EXPECT_EQ(inverse[det][0], det - 1);
+    EXPECT_EQ(inverse[det][1], det);
+  }
+}
+
+TEST(Dataset, detectorSpectra) {
+  Dataset d;
+  d.insert<Coord::DetectorPosition>({Dimension::Detector, 4}, 4);
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 3},
+                                    Vector<Indices>{{0, 2}, {1}, {2}});
+  const auto &spectra = d.detectorSpectra();
+  EXPECT_EQ(spectra,
+            IndexListColumn(Vector<Indices>{{0}, {1}, {0, 2}, {}}));
+  // Cached.
+  EXPECT_EQ(&d.detectorSpectra(), &spectra);
+  // Copies share the cache.
+  const Dataset copy(d);
+  EXPECT_EQ(&copy.detectorSpectra(), &spectra);
+}
+
+TEST(Dataset, detectorSpectra_invalidated_by_grouping_change) {
+  Dataset d;
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 2},
+                                    Vector<Indices>{{0}, {1}});
+  const Dataset original(d);
+  EXPECT_EQ(d.detectorSpectra(), IndexListColumn(Vector<Indices>{{0}, {1}}));
+
+  const Indices detectors{0, 2};
+  d.get<Coord::DetectorGrouping>()[1] = detectors;
+  EXPECT_EQ(d.detectorSpectra(),
+            IndexListColumn(Vector<Indices>{{0, 1}, {}, {1}}));
+  // The original is unaffected.
+  EXPECT_EQ(original.detectorSpectra(),
+            IndexListColumn(Vector<Indices>{{0}, {1}}));
+}
+
+TEST(Dataset, detectorSpectra_fail) {
+  Dataset d;
+  EXPECT_THROW_MSG(d.detectorSpectra(), std::runtime_error,
+                   "Dataset does not contain such a variable.");
+  d.insert<Coord::DetectorPosition>({Dimension::Detector, 1}, 1);
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 1},
+                                    Vector<Indices>{{1}});
+  EXPECT_THROW_MSG(d.detectorSpectra(), std::runtime_error,
+                   "Detector index in grouping out of range.");
+}
@@ -5,7 +5,10 @@
 /// National Laboratory, and European Spallation Source ERIC.
 #include <gtest/gtest.h>
 
+#include "test_macros.h"
+
 #include "dimensions.h"
+#include "variable.h"
 
 TEST(Dimensions, count_and_volume) {
   Dimensions dims;
@@ -36,6 +39,16 @@ TEST(Dimensions, erase) {
   EXPECT_TRUE(dims.contains(Dimension::Q));
 }
 
+TEST(Dimensions, relabel) {
+  Dimensions dims({{Dimension::Tof, 3}, {Dimension::Q, 2}});
+  dims.relabel(Dimension::Tof, Dimension::DSpacing);
+  EXPECT_EQ(dims, Dimensions({{Dimension::DSpacing, 3}, {Dimension::Q, 2}}));
+  EXPECT_THROW_MSG(dims.relabel(Dimension::Q, Dimension::DSpacing),
+                   std::runtime_error, "Dimension already exists.");
+  EXPECT_THROW_MSG(dims.relabel(Dimension::Tof, Dimension::X),
+                   std::runtime_error, "Dimension not found.");
+}
+
 TEST(Dimensions, contains_other) {
   Dimensions a;
   a.add(Dimension::Tof, 3);
@@ -66,3 +79,57 @@ TEST(Dimensions, merge) {
   b.resize(Dimension::Tof, 3);
   EXPECT_NO_THROW(merge(a, b));
 }
+
+Dimensions makeRagged(const Vector<gsl::index> &sizes) {
+  Dimensions dims;
+  dims.add(Dimension::Tof, makeVariable<Data::DimensionSize>(
+                               {Dimension::Spectrum, 3}, sizes));
+  dims.add(Dimension::Spectrum, 3);
+  return dims;
+}
+
+TEST(Dimensions, ragged) {
+  auto dims = makeRagged({2, 0, 3});
+  EXPECT_TRUE(dims.isRagged());
+  EXPECT_TRUE(dims.isRagged(Dimension::Tof));
+  EXPECT_FALSE(dims.isRagged(Dimension::Spectrum));
+  EXPECT_EQ(dims.volume(), 5);
+  const auto offsets = dims.raggedOffsets(Dimension::Tof);
+  EXPECT_EQ(Vector<gsl::index>(offsets.begin(), offsets.end()),
+            (Vector<gsl::index>{0, 2, 2, 5}));
+  EXPECT_THROW_MSG(dims.raggedOffsets(Dimension::Spectrum), std::runtime_error,
+                   "Dimension is not ragged, no offsets available.");
+  dims.add(Dimension::X, 2);
+  EXPECT_EQ(dims.volume(), 10);
+}
+
+TEST(Dimensions, ragged_negative_size) {
+  EXPECT_THROW_MSG(makeRagged({2, -1, 3}), std::runtime_error,
+                   "Size of ragged dimension must not be negative.");
+}
+
+TEST(Dimensions, ragged_copy_shares_offsets) {
+  const auto dims = makeRagged({2, 0, 3});
+  const auto copy(dims);
+  EXPECT_EQ(copy.raggedOffsets(0).data(), dims.raggedOffsets(0).data());
+  Dimensions other;
+  other.add(Dimension::Tof, dims);
+  EXPECT_EQ(other.raggedOffsets(0).data(), dims.raggedOffsets(0).data());
+}
+
+TEST(Dimensions, ragged_operator_equals) {
+  const auto dims = makeRagged({2, 0, 3});
+  EXPECT_EQ(dims, dims);
+  EXPECT_EQ(dims, makeRagged({2, 0, 3}));
+  EXPECT_FALSE(dims == makeRagged({2, 1, 3}));
+  EXPECT_FALSE(dims ==
+               Dimensions({{Dimension::Tof, 2}, {Dimension::Spectrum, 3}}));
+}
+
+TEST(Dimensions, ragged_contains) {
+  const auto dims = makeRagged({2, 0, 3});
+  EXPECT_TRUE(dims.contains(Dimensions(Dimension::Spectrum, 3)));
+  EXPECT_FALSE(dims.contains(Dimensions(Dimension::Spectrum, 2)));
+  EXPECT_TRUE(dims.contains(makeRagged({2, 0, 3})));
+  EXPECT_FALSE(dims.contains(makeRagged({2, 1, 3})));
+}
@@ -0,0 +1,549 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "test_macros.h"
+
+#include "events.h"
+
+namespace {
+Dataset makeEvents(const Vector<gsl::index> &counts,
+                   const Vector<double> &tofs) {
+  const auto dims = eventDimensions(makeVariable<Data::DimensionSize>(
+      {Dimension::Spectrum, static_cast<gsl::index>(counts.size())}, counts));
+  Dataset d;
+  d.insert<Data::Tof>("events", dims, tofs);
+  d.insert<Data::PulseTime>("events", dims, tofs.size());
+  return d;
+}
+
+Variable makeEdges(const Vector<double> &edges) {
+  return makeVariable<Coord::Tof>(
+      {Dimension::Tof, static_cast<gsl::index>(edges.size())}, edges);
+}
+
+std::vector<double> values(const Dataset &d, const std::string &name) {
+  const auto values = d.get<const Data::Value>(name);
+  return std::vector<double>(values.begin(), values.end());
+}
+
+std::vector<double> variances(const Dataset &d, const std::string &name) {
+  const auto variances = d.get<const Data::Variance>(name);
+  return std::vector<double>(variances.begin(), variances.end());
+}
+}
+
+TEST(Events, eventDimensions) {
+  const auto dims = eventDimensions(makeVariable<Data::DimensionSize>(
+      {Dimension::Spectrum, 3}, {2l, 0l, 1l}));
+  ASSERT_EQ(dims.count(), 2);
+  EXPECT_EQ(dims.label(0), Dimension::Event);
+  EXPECT_TRUE(dims.isRagged(0));
+  EXPECT_EQ(dims.label(1), Dimension::Spectrum);
+  EXPECT_EQ(dims.size(1), 3);
+  EXPECT_EQ(dims.volume(), 3);
+}
+
+TEST(Events, histogram_linear) {
+  auto events = makeEvents({3, 0, 4}, {1.5, 0.5, 2.0, 3.0, 4.0, 1.0, 2.9});
+  events.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {1, 2, 3});
+  const auto edges = makeEdges({1.0, 2.0, 3.0, 4.0});
+  const auto hist = histogram(events, "events", edges);
+
+  EXPECT_EQ(hist.dimensions<Data::Value>("events"),
+            Dimensions({{Dimension::Tof, 3}, {Dimension::Spectrum, 3}}));
+  EXPECT_EQ(values(hist, "events"),
+            (std::vector<double>{1, 1, 0, 0, 0, 0, 1, 1, 1}));
+  EXPECT_EQ(variances(hist, "events"), values(hist, "events"));
+  const auto spectra = hist.get<const Coord::SpectrumNumber>();
+  EXPECT_EQ(std::vector<int32_t>(spectra.begin(), spectra.end()),
+            (std::vector<int32_t>{1, 2, 3}));
+  const auto histEdges = hist.get<const Coord::Tof>();
+  EXPECT_EQ(std::vector<double>(histEdges.begin(), histEdges.end()),
+            (std::vector<double>{1.0, 2.0, 3.0, 4.0}));
+  EXPECT_THROW(hist.get<const Data::Tof>("events"), std::runtime_error);
+}
+
+TEST(Events, histogram_bin_edges) {
+  // Edges that are not exactly representable, events exactly on the edges must
+  // end up in the bin to the right, as with binary search.
+  Vector<double> edges;
+  for (gsl::index i = 0; i <= 10; ++i)
+    edges.push_back(0.1 * i);
+  Vector<double> tofs(edges.begin(), edges.end());
+  const auto hist = histogram(makeEvents({11}, tofs), "events",
+                              makeEdges(edges));
+  EXPECT_EQ(values(hist, "events"), std::vector<double>(10, 1.0));
+}
+
+TEST(Events, histogram_log) {
+  Vector<double> edges;
+  for (gsl::index i = 0; i <= 20; ++i)
+    edges.push_back(10.0 * std::pow(1.5, i));
+  Vector<double> tofs;
+  for (gsl::index i = 0; i < 1000; ++i)
+    tofs.push_back(5.0 + 40000.0 * ((i * 7919) % 1000) / 1000.0);
+  for (const auto edge : edges)
+    tofs.push_back(edge);
+  const auto events =
+      makeEvents({static_cast<gsl::index>(tofs.size())}, tofs);
+  const auto hist = histogram(events, "events", makeEdges(edges));
+
+  std::vector<double> expected(20, 0.0);
+  for (const auto tof : tofs) {
+    const auto it = std::upper_bound(edges.begin(), edges.end(), tof);
+    if (it != edges.begin() && it != edges.end())
+      expected[it - edges.begin() - 1] += 1.0;
+  }
+  EXPECT_EQ(values(hist, "events"), expected);
+}
+
+TEST(Events, histogram_irregular) {
+  const auto events = makeEvents({4, 2}, {0.5, 1.0, 2.5, 9.0, 10.0, 3.0});
+  const auto hist =
+      histogram(events, "events", makeEdges({1.0, 2.0, 3.0, 10.0}));
+  EXPECT_EQ(values(hist, "events"),
+            (std::vector<double>{1, 1, 1, 0, 0, 1}));
+}
+
+TEST(Events, histogram_weighted) {
+  auto events = makeEvents({2, 1}, {1.5, 1.6, 2.5});
+  const auto &dims = events.dimensions<Data::Tof>("events");
+  events.insert<Data::Weight>("events", dims, {2.0, 3.0, 4.0});
+  EXPECT_THROW_MSG(
+      histogram(events, "events", makeEdges({1.0, 2.0, 3.0})),
+      std::runtime_error,
+      "Event weights require both Data::Weight and Data::WeightVariance.");
+  events.insert<Data::WeightVariance>("events", dims, {0.5, 1.0, 2.0});
+  const auto hist = histogram(events, "events", makeEdges({1.0, 2.0, 3.0}));
+  EXPECT_EQ(values(hist, "events"), (std::vector<double>{5.0, 0.0, 0.0, 4.0}));
+  EXPECT_EQ(variances(hist, "events"),
+            (std::vector<double>{1.5, 0.0, 0.0, 2.0}));
+}
+
+TEST(Events, histogram_large) {
+  // Large enough to run in parallel, with chunks of threads beginning and
+  // ending within the large spectrum.
+  const Vector<gsl::index> counts{10, 300000, 0, 5, 100000};
+  Vector<double> tofs;
+  for (gsl::index i = 0; i < 400015; ++i)
+    tofs.push_back(static_cast<double>((i * 7919) % 10007) / 10.0);
+  const auto hist = histogram(makeEvents(counts, tofs), "events",
+                              makeEdges({0.0, 250.0, 500.0, 750.0, 1000.0}));
+
+  std::vector<double> expected(4 * counts.size(), 0.0);
+  gsl::index event = 0;
+  for (gsl::index spectrum = 0; spectrum < 5; ++spectrum)
+    for (gsl::index i = 0; i < counts[spectrum]; ++i, ++event)
+      if (tofs[event] < 1000.0)
+        expected[4 * spectrum + static_cast<gsl::index>(tofs[event] / 250.0)] +=
+            1.0;
+  EXPECT_EQ(values(hist, "events"), expected);
+}
+
+TEST(Events, histogram_fail) {
+  const auto events = makeEvents({1}, {1.0});
+  EXPECT_THROW_MSG(
+      histogram(events, "events",
+                makeVariable<Coord::X>({Dimension::Tof, 2}, {1.0, 2.0})),
+      std::runtime_error,
+      "Bin edges must be a one-dimensional Coord::Tof variable.");
+  EXPECT_THROW_MSG(histogram(events, "events", makeEdges({1.0})),
+                   std::runtime_error,
+                   "Bin edges must define at least one bin.");
+  EXPECT_THROW_MSG(histogram(events, "events", makeEdges({1.0, 3.0, 3.0})),
+                   std::runtime_error,
+                   "Bin edges must be strictly increasing.");
+
+  Dataset d;
+  d.insert<Data::Tof>("events", {Dimension::Spectrum, 2}, {1.0, 2.0});
+  EXPECT_THROW_MSG(
+      histogram(d, "events", makeEdges({1.0, 2.0})), std::runtime_error,
+      "Events must have the ragged Dimension::Event as inner dimension.");
+}
+
+TEST(Events, sort_by_tof) {
+  auto events = makeEvents({4, 0, 3}, {3.0, -1.0, 2.0, 0.5, 2.0, 1.0, 1.5});
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  std::iota(pulseTimes.begin(), pulseTimes.end(), int64_t{0});
+  const auto &dims = events.dimensions<Data::Tof>("events");
+  events.insert<Data::Weight>("events", dims,
+                              {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0});
+  events.insert<Data::WeightVariance>("events", dims, dims.volume());
+  events.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {1, 2, 3});
+
+  sortEvents<Data::Tof>(events, "events");
+  const auto tofs = events.get<const Data::Tof>("events");
+  EXPECT_EQ(std::vector<double>(tofs.begin(), tofs.end()),
+            (std::vector<double>{-1.0, 0.5, 2.0, 3.0, 1.0, 1.5, 2.0}));
+  pulseTimes = events.get<Data::PulseTime>("events");
+  EXPECT_EQ(std::vector<int64_t>(pulseTimes.begin(), pulseTimes.end()),
+            (std::vector<int64_t>{1, 3, 2, 0, 5, 6, 4}));
+  const auto weights = events.get<const Data::Weight>("events");
+  EXPECT_EQ(std::vector<double>(weights.begin(), weights.end()),
+            (std::vector<double>{2.0, 4.0, 3.0, 1.0, 6.0, 7.0, 5.0}));
+  EXPECT_EQ(events.size(), 5);
+}
+
+TEST(Events, sort_by_pulse_time_is_stable) {
+  auto events = makeEvents({6}, {0.0, 1.0, 2.0, 3.0, 4.0, 5.0});
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  const std::vector<int64_t> times{5, -3, 5, -3, 0, 1l << 40};
+  std::copy(times.begin(), times.end(), pulseTimes.begin());
+
+  sortEvents<Data::PulseTime>(events, "events");
+  const auto tofs = events.get<const Data::Tof>("events");
+  EXPECT_EQ(std::vector<double>(tofs.begin(), tofs.end()),
+            (std::vector<double>{1.0, 3.0, 4.0, 0.0, 2.0, 5.0}));
+}
+
+TEST(Events, sort_large) {
+  // Spectra above and below the size for which radix sort is used, and enough
+  // events to sort in parallel.
+  const Vector<gsl::index> counts{100000, 7, 50000, 1000, 0};
+  const gsl::index size = 151007;
+  Vector<double> tofs(size);
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> tof(-10.0, 100000.0);
+  for (auto &t : tofs)
+    t = tof(rng);
+  // Some duplicates to check stability.
+  for (gsl::index i = 0; i < size; i += 10)
+    tofs[i] = 42.0;
+  auto events = makeEvents(counts, tofs);
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  std::iota(pulseTimes.begin(), pulseTimes.end(), int64_t{0});
+
+  sortEvents<Data::Tof>(events, "events");
+  std::vector<std::pair<double, int64_t>> expected;
+  for (gsl::index i = 0; i < size; ++i)
+    expected.emplace_back(tofs[i], i);
+  gsl::index offset = 0;
+  for (const auto count : counts) {
+    std::stable_sort(expected.begin() + offset,
+                     expected.begin() + offset + count,
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+    offset += count;
+  }
+  const auto sortedTofs = events.get<const Data::Tof>("events");
+  pulseTimes = events.get<Data::PulseTime>("events");
+  std::vector<std::pair<double, int64_t>> sorted;
+  for (gsl::index i = 0; i < size; ++i)
+    sorted.emplace_back(sortedTofs[i], pulseTimes[i]);
+  EXPECT_EQ(sorted, expected);
+}
+
+TEST(Events, sort_flag) {
+  auto events = makeEvents({3}, {3.0, 1.0, 2.0});
+  const auto &variable = [&]() -> const Variable & {
+    return events[events.find(tag_id<Data::Tof>, "events")];
+  };
+  EXPECT_FALSE(variable().isSortedBy<Data::Tof>());
+  sortEvents<Data::Tof>(events, "events");
+  EXPECT_TRUE(variable().isSortedBy<Data::Tof>());
+  EXPECT_FALSE(variable().isSortedBy<Data::PulseTime>());
+  EXPECT_TRUE(events[events.find(tag_id<Data::PulseTime>, "events")]
+                  .isSortedBy<Data::Tof>());
+
+  // Copies share the flag, read access does not clear it.
+  auto copy(events);
+  copy.get<const Data::Tof>("events");
+  EXPECT_TRUE(copy[copy.find(tag_id<Data::Tof>, "events")]
+                  .isSortedBy<Data::Tof>());
+  copy.get<Data::Tof>("events")[0] = 4.0;
+  EXPECT_FALSE(copy[copy.find(tag_id<Data::Tof>, "events")]
+                   .isSortedBy<Data::Tof>());
+  EXPECT_TRUE(variable().isSortedBy<Data::Tof>());
+
+  sortEvents<Data::PulseTime>(events, "events");
+  EXPECT_TRUE(variable().isSortedBy<Data::PulseTime>());
+}
+
+TEST(Events, sort_fail) {
+  auto events = makeEvents({2}, {2.0, 1.0});
+  events.insert<Data::Value>("events",
+                             events.dimensions<Data::Tof>("events"), 2);
+  EXPECT_THROW_MSG(sortEvents<Data::Tof>(events, "events"),
+                   std::runtime_error,
+                   "Cannot sort events with variables other than Data::Tof, "
+                   "Data::PulseTime, Data::Weight, and "
+                   "Data::WeightVariance.");
+  EXPECT_EQ(events.size(), 3);
+}
+
+TEST(CompactEvents, compress) {
+  auto events = makeEvents({4, 0, 2}, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  const std::vector<int64_t> times{300, 100, 300, 300, 200, 100};
+  std::copy(times.begin(), times.end(), pulseTimes.begin());
+
+  const auto compact = compress(events, "events");
+  EXPECT_EQ(compact.spectra(), 3);
+  EXPECT_EQ(compact.pulseTimes(), (Vector<int64_t>{100, 200, 300}));
+  ASSERT_EQ(compact.pulses(0).size(), 2);
+  EXPECT_EQ(compact.pulses(0)[0].delta, 0);
+  EXPECT_EQ(compact.pulses(0)[0].events, 1);
+  EXPECT_EQ(compact.pulses(0)[1].delta, 2);
+  EXPECT_EQ(compact.pulses(0)[1].events, 3);
+  EXPECT_EQ(compact.pulses(1).size(), 0);
+  ASSERT_EQ(compact.pulses(2).size(), 2);
+  EXPECT_EQ(compact.pulses(2)[1].delta, 1);
+  EXPECT_FALSE(compact.hasFloatTof());
+  EXPECT_EQ(compact.tof(), (Vector<double>{2.0, 1.0, 3.0, 4.0, 6.0, 5.0}));
+
+  std::vector<int64_t> pulses;
+  compact.forEachPulse(2, [&](const int64_t pulseTime, const gsl::index begin,
+                              const gsl::index end) {
+    pulses.insert(pulses.end(), {pulseTime, begin, end});
+  });
+  EXPECT_EQ(pulses, (std::vector<int64_t>{100, 4, 5, 200, 5, 6}));
+
+  // The input is unchanged.
+  pulseTimes = events.get<Data::PulseTime>("events");
+  EXPECT_EQ(std::vector<int64_t>(pulseTimes.begin(), pulseTimes.end()),
+            times);
+}
+
+TEST(CompactEvents, decompress) {
+  auto events = makeEvents({4, 0, 2}, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  const std::vector<int64_t> times{300, 100, 300, 300, 200, 100};
+  std::copy(times.begin(), times.end(), pulseTimes.begin());
+
+  const auto decompressed = decompress(compress(events, "events"), "events");
+  sortEvents<Data::PulseTime>(events, "events");
+  for (const auto &var : events)
+    EXPECT_EQ(decompressed[decompressed.find(var.type(), "events")], var);
+  EXPECT_TRUE(decompressed[decompressed.find(tag_id<Data::Tof>, "events")]
+                  .isSortedBy<Data::PulseTime>());
+}
+
+TEST(CompactEvents, float_tof) {
+  const auto events = makeEvents({2, 1}, {1.1, 2.2, 3.3});
+  const auto compact = compress(events, "events", true);
+  EXPECT_TRUE(compact.hasFloatTof());
+  EXPECT_TRUE(compact.tof().empty());
+  EXPECT_EQ(compact.floatTof(), (Vector<float>{1.1f, 2.2f, 3.3f}));
+  const auto decompressed = decompress(compact, "events");
+  const auto tofs = decompressed.get<const Data::Tof>("events");
+  EXPECT_EQ(std::vector<double>(tofs.begin(), tofs.end()),
+            (std::vector<double>{1.1f, 2.2f, 3.3f}));
+}
+
+TEST(CompactEvents, overflow) {
+  // Gaps of more than 2^16 pulses and pulses with more than 2^16 events
+  // require several entries in the pulse index.
+  const gsl::index pulses = 70000;
+  const gsl::index size = pulses + 2 + 70000;
+  auto events = makeEvents({pulses, 2, 70000}, Vector<double>(size, 1.0));
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  for (gsl::index i = 0; i < pulses; ++i)
+    pulseTimes[i] = 10 * i;
+  pulseTimes[pulses] = 0;
+  pulseTimes[pulses + 1] = 10 * (pulses - 1);
+  std::fill(pulseTimes.begin() + pulses + 2, pulseTimes.end(), 20);
+
+  const auto compact = compress(events, "events");
+  EXPECT_EQ(compact.pulseTimes().size(), pulses);
+  EXPECT_EQ(compact.pulses(1).size(), 3);
+  EXPECT_EQ(compact.pulses(2).size(), 2);
+  const auto decompressed = decompress(compact, "events");
+  EXPECT_EQ(decompressed.get<const Data::PulseTime>("events"), pulseTimes);
+}
+
+TEST(CompactEvents, histogram) {
+  Vector<double> tofs;
+  for (gsl::index i = 0; i < 100000; ++i)
+    tofs.push_back(static_cast<double>((i * 7919) % 10007) / 10.0);
+  auto events = makeEvents({60000, 0, 40000}, tofs);
+  auto pulseTimes = events.get<Data::PulseTime>("events");
+  for (gsl::index i = 0; i < 100000; ++i)
+    pulseTimes[i] = (i * 31) % 1000;
+  events.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {1, 2, 3});
+  const auto edges = makeEdges({0.0, 100.0, 200.0, 400.0, 800.0});
+
+  const auto expected = histogram(events, "events", edges);
+  for (const auto floatTof : {false, true}) {
+    const auto hist =
+        histogram(compress(events, "events", floatTof), "events", edges);
+    EXPECT_EQ(hist.size(), 3);
+    EXPECT_EQ(hist.get<const Coord::Tof>(),
+              expected.get<const Coord::Tof>());
+    EXPECT_EQ(values(hist, "events"), values(expected, "events"));
+    EXPECT_EQ(variances(hist, "events"), variances(expected, "events"));
+  }
+}
+
+TEST(CompactEvents, compress_fail) {
+  auto events = makeEvents({2}, {1.0, 2.0});
+  const auto &dims = events.dimensions<Data::Tof>("events");
+  events.insert<Data::Weight>("events", dims, 2);
+  EXPECT_THROW_MSG(compress(events, "events"), std::runtime_error,
+                   "Cannot compress weighted events.");
+}
+
+namespace {
+Variable makeIntervals(const Vector<std::pair<int64_t, int64_t>> &intervals) {
+  return makeVariable<Coord::TimeInterval>(
+      {Dimension::Time, static_cast<gsl::index>(intervals.size())}, intervals);
+}
+
+Dataset makeEvents(const Vector<gsl::index> &counts,
+                   const Vector<int64_t> &pulseTimes) {
+  Vector<double> tofs(pulseTimes.begin(), pulseTimes.end());
+  auto events = makeEvents(counts, tofs);
+  auto pulseTime = events.get<Data::PulseTime>("events");
+  std::copy(pulseTimes.begin(), pulseTimes.end(), pulseTime.begin());
+  return events;
+}
+
+std::vector<int64_t> pulseTimes(const Dataset &d, const std::string &name) {
+  const auto times = d.get<const Data::PulseTime>(name);
+  return std::vector<int64_t>(times.begin(), times.end());
+}
+
+std::vector<gsl::index> eventCounts(const Dataset &d,
+                                    const std::string &name) {
+  const auto sizes = d.dimensions<Data::Tof>(name)
+                         .raggedSize(Dimension::Event)
+                         .get<const Data::DimensionSize>();
+  return std::vector<gsl::index>(sizes.begin(), sizes.end());
+}
+}
+
+TEST(Events, timeIntervals) {
+  // The value at time 30 is replaced immediately and has no effect.
+  Dataset log;
+  log.insert<Coord::Time>({Dimension::Time, 7},
+                          {0l, 10l, 20l, 30l, 30l, 40l, 50l});
+  log.insert<Data::Value>("temp", {Dimension::Time, 7},
+                          {1.0, 5.0, 6.0, 1.0, 5.0, 7.0, 5.0});
+  const auto intervals = timeIntervals(log, "temp", 4.0, 6.0);
+  EXPECT_EQ(intervals.dimensions(), Dimensions(Dimension::Time, 2));
+  const auto values = intervals.get<const Coord::TimeInterval>();
+  EXPECT_EQ(values[0], std::make_pair(int64_t{10}, int64_t{40}));
+  EXPECT_EQ(values[1], std::make_pair(int64_t{50},
+                                      std::numeric_limits<int64_t>::max()));
+
+  log.get<Coord::Time>()[0] = 11;
+  EXPECT_THROW_MSG(timeIntervals(log, "temp", 4.0, 6.0), std::runtime_error,
+                   "Times of log must be ascending.");
+}
+
+TEST(Events, filterEvents) {
+  auto events = makeEvents({4, 0, 3}, Vector<int64_t>{5, 30, 10, 25, 1, 2, 3});
+  const auto &dims = events.dimensions<Data::Tof>("events");
+  events.insert<Data::Weight>("events", dims,
+                              {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0});
+  events.insert<Data::WeightVariance>("events", dims, dims.volume());
+  events.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {1, 2, 3});
+
+  const auto filtered =
+      filterEvents(events, "events", makeIntervals({{2, 6}, {20, 30}}));
+  EXPECT_EQ(eventCounts(filtered, "events"),
+            (std::vector<gsl::index>{2, 0, 2}));
+  EXPECT_EQ(pulseTimes(filtered, "events"),
+            (std::vector<int64_t>{5, 25, 2, 3}));
+  const auto weights = filtered.get<const Data::Weight>("events");
+  EXPECT_EQ(std::vector<double>(weights.begin(), weights.end()),
+            (std::vector<double>{1.0, 4.0, 6.0, 7.0}));
+  EXPECT_EQ(filtered.get<const Coord::SpectrumNumber>(),
+            events.get<const Coord::SpectrumNumber>());
+  EXPECT_TRUE(filtered[filtered.find(tag_id<Data::Tof>, "events")]
+                  .isSortedBy<Data::PulseTime>());
+  EXPECT_EQ(filtered.size(), 5);
+
+  EXPECT_EQ(eventCounts(filterEvents(events, "events", makeIntervals({})),
+                        "events"),
+            (std::vector<gsl::index>{0, 0, 0}));
+}
+
+TEST(Events, filterEvents_large) {
+  // Many events and many intervals, compared with a scan of all intervals for
+  // each event.
+  std::mt19937 rng;
+  std::uniform_int_distribution<int64_t> time(0, 1000000);
+  const Vector<gsl::index> counts{50000, 1, 0, 100000, 3};
+  Vector<int64_t> times(150004);
+  for (auto &t : times)
+    t = time(rng);
+  const auto events = makeEvents(counts, times);
+  for (const gsl::index step : {1000, 100000}) {
+    Vector<std::pair<int64_t, int64_t>> intervals;
+    for (int64_t start = 0; start < 1000000; start += step)
+      intervals.emplace_back(start + step / 4, start + step / 2);
+    const auto filtered =
+        filterEvents(events, "events", makeIntervals(intervals));
+
+    std::vector<gsl::index> expectedCounts;
+    std::vector<int64_t> expected;
+    gsl::index event = 0;
+    for (const auto count : counts) {
+      std::vector<int64_t> spectrum(times.begin() + event,
+                                    times.begin() + event + count);
+      event += count;
+      std::sort(spectrum.begin(), spectrum.end());
+      expectedCounts.push_back(0);
+      for (const auto t : spectrum)
+        for (const auto &interval : intervals)
+          if (interval.first <= t && t < interval.second) {
+            expected.push_back(t);
+            ++expectedCounts.back();
+          }
+    }
+    EXPECT_EQ(eventCounts(filtered, "events"), expectedCounts);
+    EXPECT_EQ(pulseTimes(filtered, "events"), expected);
+  }
+}
+
+TEST(Events, splitEvents) {
+  const auto events = makeEvents({4, 2}, Vector<int64_t>{5, 30, 10, 25, 1, 2});
+  const auto split =
+      splitEvents(events, "events", makeIntervals({{2, 6}, {6, 10}, {20, 31}}));
+  ASSERT_EQ(split.size(), 3);
+  EXPECT_EQ(pulseTimes(split[0], "events"), (std::vector<int64_t>{5, 2}));
+  EXPECT_EQ(eventCounts(split[0], "events"), (std::vector<gsl::index>{1, 1}));
+  EXPECT_EQ(pulseTimes(split[1], "events"), (std::vector<int64_t>{}));
+  EXPECT_EQ(pulseTimes(split[2], "events"), (std::vector<int64_t>{25, 30}));
+  EXPECT_EQ(eventCounts(split[2], "events"), (std::vector<gsl::index>{2, 0}));
+}
+
+TEST(Events, filterEvents_fail) {
+  const auto events = makeEvents({2}, Vector<int64_t>{1, 2});
+  EXPECT_THROW_MSG(filterEvents(events, "events", makeIntervals({{2, 1}})),
+                   std::runtime_error,
+                   "Time intervals must be non-empty, sorted, and disjoint.");
+  EXPECT_THROW_MSG(
+      filterEvents(events, "events", makeIntervals({{1, 3}, {2, 4}})),
+      std::runtime_error,
+      "Time intervals must be non-empty, sorted, and disjoint.");
+}
+
+TEST(CompactEvents, filterEvents) {
+  Vector<int64_t> times;
+  for (gsl::index i = 0; i < 100000; ++i)
+    times.push_back((i * 7919) % 100003);
+  const auto events = makeEvents({60000, 0, 40000}, times);
+  const auto intervals = makeIntervals({{100, 200}, {5000, 70000}});
+  const auto expected = filterEvents(events, "events", intervals);
+  for (const auto floatTof : {false, true}) {
+    const auto filtered =
+        filterEvents(compress(events, "events", floatTof), intervals);
+    const auto decompressed = decompress(filtered, "events");
+    EXPECT_EQ(eventCounts(decompressed, "events"),
+              eventCounts(expected, "events"));
+    EXPECT_EQ(pulseTimes(decompressed, "events"),
+              pulseTimes(expected, "events"));
+    EXPECT_EQ(decompressed.get<const Data::Tof>("events"),
+              expected.get<const Data::Tof>("events"));
+  }
+}
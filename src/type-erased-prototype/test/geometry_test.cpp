@@ -0,0 +1,64 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "geometry.h"
+
+namespace {
+const Position source{{0.0, 0.0, -10.0}};
+const Position sample{{0.0, 0.0, 0.0}};
+// Downstream, to the side, above, and upstream of the sample.
+const PositionColumn positions{
+    Position{{0.0, 0.0, 2.0}}, Position{{2.0, 0.0, 0.0}},
+    Position{{0.0, 3.0, 0.0}}, Position{{0.0, 0.0, -4.0}}};
+}
+
+TEST(Geometry, l2) {
+  const auto l2 = geometry::l2(positions, sample);
+  EXPECT_EQ(l2, (Vector<double>{2.0, 2.0, 3.0, 4.0}));
+  const auto shifted = geometry::l2(positions, Position{{0.0, 0.0, 1.0}});
+  EXPECT_DOUBLE_EQ(shifted[0], 1.0);
+  EXPECT_DOUBLE_EQ(shifted[1], std::sqrt(5.0));
+}
+
+TEST(Geometry, twoTheta) {
+  const auto twoTheta = geometry::twoTheta(positions, source, sample);
+  ASSERT_EQ(twoTheta.size(), 4);
+  EXPECT_DOUBLE_EQ(twoTheta[0], 0.0);
+  EXPECT_DOUBLE_EQ(twoTheta[1], M_PI / 2.0);
+  EXPECT_DOUBLE_EQ(twoTheta[2], M_PI / 2.0);
+  EXPECT_DOUBLE_EQ(twoTheta[3], M_PI);
+}
+
+TEST(Geometry, azimuth) {
+  const auto azimuth = geometry::azimuth(positions, sample);
+  ASSERT_EQ(azimuth.size(), 4);
+  EXPECT_DOUBLE_EQ(azimuth[1], 0.0);
+  EXPECT_DOUBLE_EQ(azimuth[2], M_PI / 2.0);
+}
+
+TEST(Geometry, solidAngle) {
+  const auto solidAngle = geometry::solidAngle(positions, sample, 0.5);
+  EXPECT_EQ(solidAngle, (Vector<double>{0.125, 0.125, 0.5 / 9.0, 0.03125}));
+}
+
+TEST(Geometry, large) {
+  // Enough detectors to run in parallel, on a ring around the sample.
+  const gsl::index size = 100000;
+  PositionColumn ring(size);
+  for (gsl::index i = 0; i < size; ++i) {
+    const double phi = 2.0 * M_PI * i / size;
+    ring[i] = Position{{std::cos(phi), std::sin(phi), 0.0}};
+  }
+  const auto l2 = geometry::l2(ring, sample);
+  const auto twoTheta = geometry::twoTheta(ring, source, sample);
+  for (gsl::index i = 0; i < size; ++i) {
+    EXPECT_NEAR(l2[i], 1.0, 1e-12);
+    EXPECT_NEAR(twoTheta[i], M_PI / 2.0, 1e-12);
+  }
+}
@@ -0,0 +1,232 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "integrate.h"
+#include "rebin.h"
+
+namespace {
+std::vector<double> toVector(gsl::span<const double> values) {
+  return std::vector<double>(values.begin(), values.end());
+}
+
+/// Histograms with bin edges, 4 bins and 2 spectra.
+Dataset makeHistograms() {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 2}, {1, 2});
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 5},
+                                          {0.0, 1.0, 2.0, 3.0, 4.0}));
+  const Dimensions dims({{Dimension::Tof, 4}, {Dimension::Spectrum, 2}});
+  d.insert<Data::Value>("sample", dims,
+                        {1.0, 2.0, 3.0, 4.0, 10.0, 20.0, 30.0, 40.0});
+  d.insert<Data::Variance>("sample", dims,
+                           {1.0, 2.0, 3.0, 4.0, 10.0, 20.0, 30.0, 40.0});
+  return d;
+}
+}
+
+TEST(CumulativeSum, inner) {
+  const auto d = makeHistograms();
+  const auto sums =
+      cumulativeSum(d[d.find(tag_id<Data::Value>, "sample")], Dimension::Tof);
+  EXPECT_TRUE(sums.valueTypeIs<Data::CumulativeValue>());
+  EXPECT_EQ(sums.name(), "sample");
+  EXPECT_EQ(sums.dimensions(),
+            Dimensions({{Dimension::Tof, 5}, {Dimension::Spectrum, 2}}));
+  EXPECT_EQ(toVector(sums.get<const Data::CumulativeValue>()),
+            (std::vector<double>{0.0, 1.0, 3.0, 6.0, 10.0, 0.0, 10.0, 30.0,
+                                 60.0, 100.0}));
+}
+
+TEST(CumulativeSum, outer) {
+  const auto d = makeHistograms();
+  const auto sums = cumulativeSum(d[d.find(tag_id<Data::Value>, "sample")],
+                                  Dimension::Spectrum);
+  EXPECT_EQ(sums.dimensions(),
+            Dimensions({{Dimension::Tof, 4}, {Dimension::Spectrum, 3}}));
+  EXPECT_EQ(toVector(sums.get<const Data::CumulativeValue>()),
+            (std::vector<double>{0.0, 0.0, 0.0, 0.0, 1.0, 2.0, 3.0, 4.0,
+                                 11.0, 22.0, 33.0, 44.0}));
+}
+
+TEST(CumulativeSum, large) {
+  // A single long line uses a parallel prefix sum, many short lines are split
+  // between threads. Integer values are summed exactly.
+  for (const auto shape : {std::make_pair(gsl::index{1000003}, gsl::index{1}),
+                           std::make_pair(gsl::index{7}, gsl::index{100003}),
+                           std::make_pair(gsl::index{100003}, gsl::index{7})}) {
+    const Dimensions dims({{Dimension::X, shape.first},
+                           {Dimension::Y, shape.second}});
+    Vector<double> values(dims.volume());
+    for (gsl::index i = 0; i < values.size(); ++i)
+      values[i] = i % 7;
+    const auto var = makeVariable<Data::Value>(dims, values);
+    for (const auto dim : {Dimension::X, Dimension::Y}) {
+      const auto size = dims.size(dim);
+      const auto stride = dims.offset(dim);
+      const auto sums = toVector(
+          cumulativeSum(var, dim).get<const Data::CumulativeValue>());
+      ASSERT_EQ(sums.size(), values.size() / size * (size + 1));
+      std::vector<double> expected(sums.size());
+      for (gsl::index outer = 0; outer < values.size() / (size * stride);
+           ++outer)
+        for (gsl::index i = 0; i < stride; ++i) {
+          double sum = 0.0;
+          for (gsl::index k = 0; k <= size; ++k) {
+            expected[(outer * (size + 1) + k) * stride + i] = sum;
+            if (k < size)
+              sum += values[(outer * size + k) * stride + i];
+          }
+        }
+      EXPECT_EQ(sums, expected);
+    }
+  }
+}
+
+TEST(Integrate, shared_windows) {
+  const auto d = makeHistograms();
+  const auto result =
+      integrate(d, makeVariable<Coord::Tof>({Dimension::Tof, 3},
+                                            {0.5, 1.0, -1.0}),
+                makeVariable<Coord::Tof>({Dimension::Tof, 3},
+                                         {2.0, 5.0, 0.5}));
+  // The bin edges are dropped.
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(result.get<const Coord::SpectrumNumber>(),
+            d.get<const Coord::SpectrumNumber>());
+  const Dimensions dims({{Dimension::Tof, 3}, {Dimension::Spectrum, 2}});
+  EXPECT_EQ(result.dimensions<Data::Value>("sample"), dims);
+  const std::vector<double> expected{2.5, 9.0, 0.5, 25.0, 90.0, 5.0};
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")), expected);
+  EXPECT_EQ(toVector(result.get<const Data::Variance>("sample")), expected);
+}
+
+TEST(Integrate, spectrum_windows_and_edges) {
+  auto d = makeHistograms();
+  d.erase<Coord::Tof>();
+  d.insertAsEdge(
+      Dimension::Tof,
+      makeVariable<Coord::Tof>(
+          Dimensions({{Dimension::Tof, 5}, {Dimension::Spectrum, 2}}),
+          {0.0, 1.0, 2.0, 3.0, 4.0, 0.0, 2.0, 4.0, 6.0, 8.0}));
+  const Dimensions windowDims({{Dimension::Tof, 1}, {Dimension::Spectrum, 2}});
+  const auto result =
+      integrate(d, makeVariable<Coord::Tof>(windowDims, {1.0, 1.0}),
+                makeVariable<Coord::Tof>(windowDims, {3.0, 3.0}));
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")),
+            (std::vector<double>{5.0, 0.5 * 10.0 + 0.5 * 20.0}));
+}
+
+TEST(Integrate, matches_rebin) {
+  // Integration over adjacent windows is equivalent to rebinning.
+  const gsl::index spectra = 10007;
+  const gsl::index bins = 100;
+  std::vector<double> edges(bins + 1);
+  for (gsl::index i = 0; i <= bins; ++i)
+    edges[i] = 0.1 * i * i;
+  Dataset d;
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, bins + 1},
+                                          edges.begin(), edges.end()));
+  const Dimensions dims({{Dimension::Tof, bins}, {Dimension::Spectrum,
+                                                  spectra}});
+  Vector<double> values(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    values[i] = i % 17;
+  d.insert<Data::Value>("sample", dims, values);
+
+  std::vector<double> newEdges;
+  for (double edge = -5.0; edge < 1100.0; edge += 7.3)
+    newEdges.push_back(edge);
+  const gsl::index windows = newEdges.size() - 1;
+  const auto rebinned =
+      rebin(d, Dimension::Tof,
+            makeVariable<Coord::Tof>({Dimension::Tof, windows + 1},
+                                     newEdges.begin(), newEdges.end()));
+  const auto integrated = integrate(
+      d,
+      makeVariable<Coord::Tof>({Dimension::Tof, windows}, newEdges.begin(),
+                               newEdges.end() - 1),
+      makeVariable<Coord::Tof>({Dimension::Tof, windows},
+                               newEdges.begin() + 1, newEdges.end()));
+  const auto expected = toVector(rebinned.get<const Data::Value>("sample"));
+  const auto result = toVector(integrated.get<const Data::Value>("sample"));
+  ASSERT_EQ(result.size(), expected.size());
+  for (gsl::index i = 0; i < result.size(); ++i)
+    EXPECT_NEAR(result[i], expected[i], 1e-9);
+}
+
+TEST(Integrate, cached) {
+  auto d = makeHistograms();
+  EXPECT_EQ(d.cumulativeSum(Dimension::Tof, "sample"), nullptr);
+  d.enableCumulativeSum(Dimension::Tof, "sample");
+  const auto cache = d.cumulativeSum(Dimension::Tof, "sample");
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(toVector(cache->get<const Data::CumulativeValue>()),
+            toVector(cumulativeSum(d[d.find(tag_id<Data::Value>, "sample")],
+                                   Dimension::Tof)
+                         .get<const Data::CumulativeValue>()));
+  // The cache is hidden.
+  EXPECT_EQ(d.size(), 4);
+  EXPECT_EQ(d.cumulativeSum(Dimension::Tof, "sample"), cache);
+  EXPECT_EQ(d.cumulativeSum(Dimension::Spectrum, "sample"), nullptr);
+
+  const auto begin = makeVariable<Coord::Tof>({Dimension::Tof, 1}, {0.0});
+  const auto end = makeVariable<Coord::Tof>({Dimension::Tof, 1}, {4.0});
+  EXPECT_EQ(toVector(integrate(d, begin, end).get<const Data::Value>("sample")),
+            (std::vector<double>{10.0, 100.0}));
+  // Modifying the values invalidates the cache.
+  d.get<Data::Value>("sample")[0] = 11.0;
+  EXPECT_EQ(toVector(integrate(d, begin, end).get<const Data::Value>("sample")),
+            (std::vector<double>{20.0, 100.0}));
+  EXPECT_EQ(d.cumulativeSum(Dimension::Tof, "sample")
+                ->get<const Data::CumulativeValue>()[4],
+            20.0);
+}
+
+TEST(Integrate, fail) {
+  const auto d = makeHistograms();
+  const auto bounds = makeVariable<Coord::Tof>({Dimension::Tof, 1}, {0.0});
+  EXPECT_THROW_MSG(
+      integrate(d, bounds, makeVariable<Coord::X>({Dimension::Tof, 1}, {1.0})),
+      std::runtime_error,
+      "Window bounds must be Coord::Tof variables with equal dimensions and "
+      "Dimension::Tof as inner dimension.");
+  EXPECT_THROW_MSG(
+      integrate(d,
+                makeVariable<Coord::Tof>(
+                    Dimensions({{Dimension::Tof, 1}, {Dimension::X, 2}}), 2),
+                makeVariable<Coord::Tof>(
+                    Dimensions({{Dimension::Tof, 1}, {Dimension::X, 2}}), 2)),
+      std::runtime_error,
+      "Bin edges and window bounds depending on other dimensions must have "
+      "the same dimensions as the data.");
+
+  Dataset points;
+  points.insert<Coord::Tof>({Dimension::Tof, 2}, {0.0, 1.0});
+  points.insert<Data::Value>("sample", {Dimension::Tof, 2}, {1.0, 2.0});
+  EXPECT_THROW_MSG(integrate(points, bounds, bounds), std::runtime_error,
+                   "Integration requires bin edges.");
+
+  auto withInt = d;
+  withInt.insert<Data::Int>("counts", {Dimension::Tof, 4}, {1l, 2l, 3l, 4l});
+  EXPECT_THROW_MSG(integrate(withInt, bounds, bounds), std::runtime_error,
+                   "Cannot integrate variables other than Data::Value and "
+                   "Data::Variance.");
+
+  auto withCache = d;
+  EXPECT_THROW_MSG(withCache.enableCumulativeSum(Dimension::X, "sample"),
+                   std::runtime_error,
+                   "Variable does not depend on the dimension of the "
+                   "cumulative sum.");
+  EXPECT_THROW_MSG(
+      withCache.enableCache<Data::CumulativeValue>("sample"),
+      std::runtime_error,
+      "Cumulative sums require a dimension, see enableCumulativeSum.");
+}
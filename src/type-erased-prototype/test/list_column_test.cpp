@@ -0,0 +1,93 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "dataset_view.h"
+#include "list_column.h"
+
+using Indices = std::vector<gsl::index>;
+
+Indices toVector(gsl::span<const gsl::index> item) {
+  return Indices(item.begin(), item.end());
+}
+
+TEST(IndexListColumn, construct) {
+  const IndexListColumn empty;
+  EXPECT_EQ(empty.size(), 0);
+  const IndexListColumn blank(2);
+  ASSERT_EQ(blank.size(), 2);
+  EXPECT_TRUE(blank[1].empty());
+
+  const IndexListColumn column(Vector<Indices>{{0, 2}, {}, {1}});
+  ASSERT_EQ(column.size(), 3);
+  EXPECT_EQ(column.offsets(), (Vector<int64_t>{0, 2, 2, 3}));
+  EXPECT_EQ(column.values(), (Vector<gsl::index>{0, 2, 1}));
+  EXPECT_EQ(toVector(column[0]), Indices({0, 2}));
+  EXPECT_TRUE(column[1].empty());
+  EXPECT_EQ(toVector(column[2]), Indices({1}));
+}
+
+TEST(IndexListColumn, assign) {
+  IndexListColumn column(Vector<Indices>{{0, 2}, {}, {1}});
+  const Indices a{3, 4, 5};
+  const Indices b{6, 7};
+  const Indices none;
+  column[1] = a;
+  column[0] = b;
+  column[2] = column[1];
+  EXPECT_EQ(column,
+            IndexListColumn(Vector<Indices>{{6, 7}, {3, 4, 5}, {3, 4, 5}}));
+  column[1] = none;
+  EXPECT_EQ(column.offsets(), (Vector<int64_t>{0, 2, 2, 5}));
+  EXPECT_EQ(column.values(), (Vector<gsl::index>{6, 7, 3, 4, 5}));
+}
+
+TEST(IndexListColumn, push_back_resize) {
+  IndexListColumn column;
+  const Indices a{1, 2};
+  column.push_back(a);
+  column.push_back(column[0]);
+  column.resize(3);
+  EXPECT_EQ(column, IndexListColumn(Vector<Indices>{{1, 2}, {1, 2}, {}}));
+  column.resize(1);
+  EXPECT_EQ(column.values(), (Vector<gsl::index>{1, 2}));
+}
+
+TEST(IndexListColumn, detector_grouping_is_columnar) {
+  Dataset d;
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 3},
+                                    Vector<Indices>{{0, 2}, {1}, {}});
+  const auto &var = d[d.find(tag_id<Coord::DetectorGrouping>, "")];
+  const auto &column = var.get<const Coord::DetectorGrouping>().column();
+  EXPECT_EQ(column.values(), (Vector<gsl::index>{0, 2, 1}));
+
+  // Copying the dataset shares the buffers, writing makes a copy.
+  auto copy(d);
+  const auto &copyVar = copy[copy.find(tag_id<Coord::DetectorGrouping>, "")];
+  EXPECT_EQ(&copyVar.get<const Coord::DetectorGrouping>().column(), &column);
+  const Indices detectors{3};
+  copy.get<Coord::DetectorGrouping>()[2] = detectors;
+  EXPECT_TRUE(d.get<const Coord::DetectorGrouping>()[2].empty());
+  EXPECT_EQ(toVector(copy.get<const Coord::DetectorGrouping>()[2]), detectors);
+}
+
+TEST(IndexListColumn, slice_and_concatenate) {
+  Dataset d;
+  d.insert<Coord::DetectorGrouping>({Dimension::Spectrum, 3},
+                                    Vector<Indices>{{0, 2}, {1}, {3, 4}});
+  const auto last = slice(d, Dimension::Spectrum, 2);
+  ASSERT_EQ(last.get<const Coord::DetectorGrouping>().size(), 1);
+  EXPECT_EQ(toVector(last.get<const Coord::DetectorGrouping>()[0]),
+            Indices({3, 4}));
+
+  const auto joined = concatenate(Dimension::Spectrum, d, d);
+  const auto grouping = joined.get<const Coord::DetectorGrouping>();
+  ASSERT_EQ(grouping.size(), 6);
+  EXPECT_EQ(grouping.column().values(),
+            (Vector<gsl::index>{0, 2, 1, 3, 4, 0, 2, 1, 3, 4}));
+}
@@ -0,0 +1,103 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+
+#include "dataset.h"
+#include "mask_column.h"
+
+TEST(MaskColumn, construct) {
+  MaskColumn empty;
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_TRUE(empty.words().empty());
+  MaskColumn unset(70);
+  ASSERT_EQ(unset.size(), 70);
+  EXPECT_EQ(unset.words().size(), 2);
+  EXPECT_EQ(unset.count(), 0);
+
+  MaskColumn set(70, 1);
+  EXPECT_EQ(set.count(), 70);
+  EXPECT_EQ(set.words()[0], ~uint64_t{0});
+  // Bits past the end are zero.
+  EXPECT_EQ(set.words()[1], uint64_t{0x3f});
+
+  MaskColumn column(Vector<char>{0, 1, 1, 0, 1});
+  ASSERT_EQ(column.size(), 5);
+  EXPECT_EQ(column[0], 0);
+  EXPECT_EQ(column[1], 1);
+  EXPECT_EQ(column[4], 1);
+  EXPECT_EQ(column.words()[0], uint64_t{0x16});
+  EXPECT_EQ(column, MaskColumn({0, 1, 1, 0, 1}));
+  EXPECT_NE(column, MaskColumn({0, 1, 1, 0, 0}));
+}
+
+TEST(MaskColumn, assign) {
+  MaskColumn column(130);
+  column[0] = 1;
+  column[64] = 1;
+  column[129] = 1;
+  EXPECT_EQ(column.count(), 3);
+  EXPECT_EQ(column[64], 1);
+  EXPECT_EQ(column[65], 0);
+  column[64] = 0;
+  EXPECT_EQ(column.count(), 2);
+  column.resize(100);
+  // Flag 129 is dropped, also when growing again.
+  column.resize(130);
+  EXPECT_EQ(column.count(), 1);
+  column.push_back(1);
+  EXPECT_EQ(column.size(), 131);
+  EXPECT_EQ(column[130], 1);
+}
+
+TEST(MaskColumn, forEachUnsetRange) {
+  MaskColumn column(300);
+  for (gsl::index i = 10; i < 200; ++i)
+    column[i] = 1;
+  column[250] = 1;
+  std::vector<std::pair<gsl::index, gsl::index>> ranges;
+  const auto collect = [&](const gsl::index begin, const gsl::index end) {
+    ranges.emplace_back(begin, end);
+  };
+  column.forEachUnsetRange(0, 300, collect);
+  EXPECT_EQ(ranges, (std::vector<std::pair<gsl::index, gsl::index>>{
+                        {0, 10}, {200, 250}, {251, 300}}));
+  ranges.clear();
+  column.forEachUnsetRange(5, 251, collect);
+  EXPECT_EQ(ranges, (std::vector<std::pair<gsl::index, gsl::index>>{
+                        {5, 10}, {200, 250}}));
+  ranges.clear();
+  column.forEachUnsetRange(20, 190, collect);
+  EXPECT_TRUE(ranges.empty());
+}
+
+TEST(MaskColumn, variable) {
+  Dataset d;
+  d.insert<Coord::Mask>({Dimension::Spectrum, 3}, Vector<char>{0, 0, 1});
+  d.get<Coord::Mask>()[0] = 1;
+  const auto mask = d.get<const Coord::Mask>();
+  EXPECT_EQ(std::vector<char>(mask.begin(), mask.end()),
+            (std::vector<char>{1, 0, 1}));
+
+  // Masks are combined word-wise, + is or, * is and.
+  auto a = makeVariable<Coord::Mask>({Dimension::Spectrum, 3},
+                                     Vector<char>{1, 1, 0});
+  const auto b = makeVariable<Coord::Mask>({Dimension::Spectrum, 3},
+                                           Vector<char>{0, 1, 0});
+  const auto either = a + b;
+  EXPECT_EQ(either.get<const Coord::Mask>().column(),
+            MaskColumn({1, 1, 0}));
+  a *= b;
+  EXPECT_EQ(a.get<const Coord::Mask>().column(), MaskColumn({0, 1, 0}));
+  EXPECT_THROW_MSG(a -= b, std::runtime_error, "Cannot subtract masks.");
+  EXPECT_THROW_MSG(
+      a += makeVariable<Coord::Mask>({}, 1, char{1}), std::runtime_error,
+      "Cannot broadcast masks.");
+}
@@ -0,0 +1,119 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "mask.h"
+
+namespace {
+std::vector<double> toVector(gsl::span<const double> values) {
+  return std::vector<double>(values.begin(), values.end());
+}
+}
+
+TEST(Mask, applyMask_spectra) {
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 3}});
+  const auto var =
+      makeVariable<Data::Value>(dims, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const auto mask = makeVariable<Coord::Mask>({Dimension::Spectrum, 3},
+                                              Vector<char>{0, 1, 0});
+  const auto masked = applyMask(var, mask);
+  EXPECT_EQ(masked.dimensions(), dims);
+  EXPECT_EQ(toVector(masked.get<const Data::Value>()),
+            (std::vector<double>{1.0, 2.0, 0.0, 0.0, 5.0, 6.0}));
+  // The input is unchanged.
+  EXPECT_EQ(var.get<const Data::Value>()[2], 3.0);
+}
+
+TEST(Mask, applyMask_elements) {
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}});
+  const auto var = makeVariable<Data::Variance>(dims, {1.0, 2.0, 3.0, 4.0});
+  const auto mask = makeVariable<Coord::Mask>(dims, Vector<char>{1, 0, 0, 1});
+  EXPECT_EQ(toVector(applyMask(var, mask).get<const Data::Variance>()),
+            (std::vector<double>{0.0, 2.0, 3.0, 0.0}));
+}
+
+TEST(Mask, masked_arithmetic) {
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}});
+  auto a = makeVariable<Data::Value>(dims, {1.0, 2.0, 3.0, 4.0});
+  const auto b = makeVariable<Data::Value>(dims, {10.0, 20.0, 30.0, 40.0});
+  const auto mask = makeVariable<Coord::Mask>({Dimension::Spectrum, 2},
+                                              Vector<char>{1, 0});
+  const auto copy(a);
+  maskedPlusEquals(a, b, mask);
+  EXPECT_EQ(toVector(a.get<const Data::Value>()),
+            (std::vector<double>{1.0, 2.0, 33.0, 44.0}));
+  // Copy-on-write, the copy is unchanged.
+  EXPECT_EQ(toVector(copy.get<const Data::Value>()),
+            (std::vector<double>{1.0, 2.0, 3.0, 4.0}));
+  maskedMinusEquals(a, b, mask);
+  EXPECT_EQ(a, copy);
+  maskedTimesEquals(a, b, mask);
+  EXPECT_EQ(toVector(a.get<const Data::Value>()),
+            (std::vector<double>{1.0, 2.0, 90.0, 160.0}));
+  // Aliasing operands.
+  maskedPlusEquals(a, a, mask);
+  EXPECT_EQ(toVector(a.get<const Data::Value>()),
+            (std::vector<double>{1.0, 2.0, 180.0, 320.0}));
+}
+
+TEST(Mask, large) {
+  // Many words, fully masked, unmasked, and mixed, processed in parallel, and
+  // checked element by element.
+  for (const gsl::index inner : {gsl::index{1}, gsl::index{3}}) {
+    const gsl::index spectra = 200003;
+    const Dimensions dims({{Dimension::Tof, inner},
+                           {Dimension::Spectrum, spectra}});
+    Vector<double> values(dims.volume());
+    for (gsl::index i = 0; i < values.size(); ++i)
+      values[i] = i;
+    Vector<char> flags(spectra);
+    for (gsl::index i = 0; i < spectra; ++i)
+      flags[i] = (i / 640) % 3 == 0 || ((i / 640) % 3 == 1 && i % 7 == 0);
+    const auto mask =
+        makeVariable<Coord::Mask>({Dimension::Spectrum, spectra}, flags);
+    const auto var = makeVariable<Data::Value>(dims, values);
+    auto sum = var;
+    maskedPlusEquals(sum, var, mask);
+    const auto masked = toVector(applyMask(var, mask).get<const Data::Value>());
+    const auto summed = toVector(sum.get<const Data::Value>());
+    for (gsl::index i = 0; i < values.size(); ++i) {
+      const bool isMasked = flags[i / inner];
+      ASSERT_EQ(masked[i], isMasked ? 0.0 : values[i]);
+      ASSERT_EQ(summed[i], isMasked ? values[i] : 2.0 * values[i]);
+    }
+  }
+}
+
+TEST(Mask, fail) {
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}});
+  auto a = makeVariable<Data::Value>(dims, 4);
+  const auto mask = makeVariable<Coord::Mask>({Dimension::Spectrum, 2}, 2);
+  EXPECT_THROW_MSG(
+      applyMask(a, makeVariable<Coord::Mask>({Dimension::Tof, 2}, 2)),
+      std::runtime_error,
+      "Mask dimensions must be the outer dimensions of the variable.");
+  EXPECT_THROW_MSG(
+      applyMask(a, makeVariable<Coord::Mask>({Dimension::Spectrum, 3}, 3)),
+      std::runtime_error,
+      "Mask dimensions must be the outer dimensions of the variable.");
+  EXPECT_THROW_MSG(applyMask(a, makeVariable<Data::Value>(
+                                    {Dimension::Spectrum, 2}, 2)),
+                   std::runtime_error, "Mask must be a Coord::Mask variable.");
+  EXPECT_THROW_MSG(
+      applyMask(makeVariable<Data::Int>(dims, 4), mask), std::runtime_error,
+      "Masked operations require variables of floating-point values.");
+  EXPECT_THROW_MSG(
+      maskedPlusEquals(a, makeVariable<Data::Value>({Dimension::Tof, 2}, 2),
+                       mask),
+      std::runtime_error,
+      "Masked operations require operands with equal dimensions.");
+  auto lengths = makeVariable<Data::Value>(dims, 4);
+  lengths.setUnit(Unit::Id::Length);
+  EXPECT_THROW_MSG(maskedPlusEquals(a, lengths, mask), std::runtime_error,
+                   "Cannot add Variables: Units do not match.");
+}
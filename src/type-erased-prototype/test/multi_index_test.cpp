@@ -400,3 +400,77 @@ TEST_F(MultiIndex3DTest, increment_3D_1D_1D) {
   EXPECT_EQ(i.get<1>(), 2);
   EXPECT_EQ(i.get<2>(), 2);
 }
+
+class MultiIndexRaggedTest : public ::testing::Test {
+public:
+  MultiIndexRaggedTest() {
+    // Rows of length 2, 0, 0, 3, 0.
+    ragged.add(Dimension::Tof,
+               makeVariable<Data::DimensionSize>({Dimension::Spectrum, 5},
+                                                 {2l, 0l, 0l, 3l, 0l}));
+    ragged.add(Dimension::Spectrum, 5);
+  }
+
+protected:
+  Dimensions ragged;
+  Dimensions spectrum{Dimension::Spectrum, 5};
+};
+
+TEST_F(MultiIndexRaggedTest, increment) {
+  MultiIndex i(ragged, {ragged, spectrum});
+  std::vector<gsl::index> full;
+  std::vector<gsl::index> spec;
+  for (gsl::index n = 0; n < ragged.volume(); ++n) {
+    EXPECT_EQ(i.index(), n);
+    full.push_back(i.get<0>());
+    spec.push_back(i.get<1>());
+    i.increment();
+  }
+  EXPECT_EQ(full, (std::vector<gsl::index>{0, 1, 2, 3, 4}));
+  EXPECT_EQ(spec, (std::vector<gsl::index>{0, 0, 3, 3, 3}));
+}
+
+TEST_F(MultiIndexRaggedTest, setIndex) {
+  MultiIndex i(ragged, {ragged, spectrum});
+  const std::vector<gsl::index> spec{0, 0, 3, 3, 3};
+  for (gsl::index n = 4; n >= 0; --n) {
+    i.setIndex(n);
+    EXPECT_EQ(i.get<0>(), n);
+    EXPECT_EQ(i.get<1>(), spec[n]);
+  }
+}
+
+TEST_F(MultiIndexRaggedTest, outer_dimension) {
+  // The ragged sizes do not depend on X, i.e., the pattern repeats.
+  auto dims(ragged);
+  dims.add(Dimension::X, 2);
+  Dimensions x(Dimension::X, 2);
+  MultiIndex i(dims, {dims, spectrum, x});
+  std::vector<gsl::index> spec;
+  std::vector<gsl::index> xs;
+  for (gsl::index n = 0; n < dims.volume(); ++n) {
+    EXPECT_EQ(i.get<0>(), n);
+    spec.push_back(i.get<1>());
+    xs.push_back(i.get<2>());
+    i.increment();
+  }
+  EXPECT_EQ(spec, (std::vector<gsl::index>{0, 0, 3, 3, 3, 0, 0, 3, 3, 3}));
+  EXPECT_EQ(xs, (std::vector<gsl::index>{0, 0, 0, 0, 0, 1, 1, 1, 1, 1}));
+  i.setIndex(7);
+  EXPECT_EQ(i.get<1>(), 3);
+  EXPECT_EQ(i.get<2>(), 1);
+}
+
+TEST_F(MultiIndexRaggedTest, construct_fail) {
+  Dimensions transposed;
+  transposed.add(Dimension::Spectrum, 5);
+  transposed.add(Dimension::Tof, ragged);
+  EXPECT_THROW_MSG(MultiIndex(transposed, {}), std::runtime_error,
+                   "MultiIndex: Ragged dimension must be the innermost "
+                   "dimension.");
+  Dimensions tofOnly;
+  tofOnly.add(Dimension::Tof, ragged);
+  EXPECT_THROW_MSG(MultiIndex(ragged, {tofOnly}), std::runtime_error,
+                   "MultiIndex: Ragged variables must have the iteration "
+                   "dimensions.");
+}
@@ -0,0 +1,73 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "dataset.h"
+#include "position_column.h"
+
+TEST(PositionColumn, construct) {
+  const PositionColumn empty;
+  EXPECT_TRUE(empty.empty());
+  const PositionColumn zeros(2);
+  ASSERT_EQ(zeros.size(), 2);
+  EXPECT_EQ(zeros[1], (Position{{0.0, 0.0, 0.0}}));
+
+  const PositionColumn column{Position{{1.0, 2.0, 3.0}},
+                              Position{{4.0, 5.0, 6.0}}};
+  ASSERT_EQ(column.size(), 2);
+  EXPECT_EQ(column.x(), (Vector<double>{1.0, 4.0}));
+  EXPECT_EQ(column.y(), (Vector<double>{2.0, 5.0}));
+  EXPECT_EQ(column.z(), (Vector<double>{3.0, 6.0}));
+  EXPECT_EQ(column[1], (Position{{4.0, 5.0, 6.0}}));
+  EXPECT_EQ(PositionColumn({1.0, 4.0}, {2.0, 5.0}, {3.0, 6.0}), column);
+  EXPECT_THROW_MSG(PositionColumn({1.0}, {2.0, 5.0}, {3.0, 6.0}),
+                   std::runtime_error, "Components of positions differ in "
+                                       "size.");
+}
+
+TEST(PositionColumn, assign) {
+  PositionColumn column(2);
+  column[1] = Position{{1.0, 2.0, 3.0}};
+  EXPECT_EQ(column[0], (Position{{0.0, 0.0, 0.0}}));
+  EXPECT_EQ(column[1], (Position{{1.0, 2.0, 3.0}}));
+  column[0] = column[1];
+  EXPECT_EQ(column[0], (Position{{1.0, 2.0, 3.0}}));
+  for (auto &z : column.z())
+    z = -1.0;
+  EXPECT_EQ(column[1], (Position{{1.0, 2.0, -1.0}}));
+}
+
+TEST(PositionColumn, variable) {
+  Dataset d;
+  d.insert<Coord::DetectorPosition>(
+      {Dimension::Detector, 2},
+      {Position{{1.0, 2.0, 3.0}}, Position{{4.0, 5.0, 6.0}}});
+  const auto positions = d.get<const Coord::DetectorPosition>();
+  ASSERT_EQ(positions.size(), 2);
+  EXPECT_EQ(positions[1], (Position{{4.0, 5.0, 6.0}}));
+  d.get<Coord::DetectorPosition>()[0] = Position{{0.0, 0.0, 1.0}};
+  EXPECT_EQ(d.get<const Coord::DetectorPosition>()[0],
+            (Position{{0.0, 0.0, 1.0}}));
+}
+
+TEST(PositionColumn, arithmetic) {
+  auto a = makeVariable<Coord::DetectorPosition>(
+      {Dimension::Detector, 2},
+      {Position{{1.0, 2.0, 3.0}}, Position{{4.0, 5.0, 6.0}}});
+  const auto b = makeVariable<Coord::DetectorPosition>(
+      {Dimension::Detector, 2},
+      {Position{{1.0, 1.0, 1.0}}, Position{{2.0, 2.0, 2.0}}});
+  a += b;
+  const auto sum = a.get<const Coord::DetectorPosition>();
+  EXPECT_EQ(sum[0], (Position{{2.0, 3.0, 4.0}}));
+  EXPECT_EQ(sum[1], (Position{{6.0, 7.0, 8.0}}));
+  a -= b;
+  EXPECT_EQ(a.get<const Coord::DetectorPosition>()[1],
+            (Position{{4.0, 5.0, 6.0}}));
+  EXPECT_THROW_MSG(a *= b, std::runtime_error, "Cannot multiply positions.");
+}
@@ -0,0 +1,197 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "test_macros.h"
+
+#include "rebin.h"
+
+TEST(RebinPlan, apply) {
+  const std::vector<double> oldEdges{0.0, 1.0, 2.0, 3.0, 4.0};
+  const std::vector<double> newEdges{-1.0, 0.5, 2.0, 4.5, 5.0};
+  const RebinPlan plan(oldEdges, newEdges);
+  EXPECT_EQ(plan.oldBins(), 4);
+  EXPECT_EQ(plan.newBins(), 4);
+
+  const std::vector<double> in{1.0, 2.0, 3.0, 4.0};
+  std::vector<double> out(4);
+  plan.apply(in.data(), out.data());
+  EXPECT_EQ(out, (std::vector<double>{0.5, 2.5, 7.0, 0.0}));
+
+  // Two interleaved histograms.
+  const std::vector<double> in2{1.0, 10.0, 2.0, 20.0, 3.0, 30.0, 4.0, 40.0};
+  std::vector<double> out2(8);
+  plan.apply(in2.data(), out2.data(), 2);
+  EXPECT_EQ(out2, (std::vector<double>{0.5, 5.0, 2.5, 25.0, 7.0, 70.0, 0.0,
+                                       0.0}));
+}
+
+TEST(RebinPlan, fail) {
+  const std::vector<double> edges{0.0, 1.0};
+  const std::vector<double> point{0.0};
+  const std::vector<double> unsorted{0.0, 2.0, 1.0};
+  EXPECT_THROW_MSG(RebinPlan(point, edges), std::runtime_error,
+                   "Bin edges must define at least one bin.");
+  EXPECT_THROW_MSG(RebinPlan(edges, unsorted), std::runtime_error,
+                   "Bin edges must be strictly increasing.");
+}
+
+namespace {
+Dataset makeHistograms(const Dimensions &dims, const Dimensions &edgeDims,
+                       const std::vector<double> &edges) {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 2}, {1, 2});
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>(edgeDims, edges.begin(),
+                                          edges.end()));
+  Vector<double> values(dims.volume());
+  std::iota(values.begin(), values.end(), 1.0);
+  d.insert<Data::Value>("sample", dims, values);
+  d.insert<Data::Variance>("sample", dims, values);
+  return d;
+}
+}
+
+TEST(Rebin, shared_edges) {
+  const auto d = makeHistograms(
+      Dimensions({{Dimension::Tof, 4}, {Dimension::Spectrum, 2}}),
+      {Dimension::Tof, 5}, {0.0, 1.0, 2.0, 3.0, 4.0});
+  const auto newEdges =
+      makeVariable<Coord::Tof>({Dimension::Tof, 2}, {0.5, 2.0});
+  const auto result = rebin(d, Dimension::Tof, newEdges);
+
+  EXPECT_EQ(result.size(), 4);
+  EXPECT_EQ(result.get<const Coord::SpectrumNumber>(),
+            d.get<const Coord::SpectrumNumber>());
+  EXPECT_EQ(result.dimensions<Coord::Tof>(), newEdges.dimensions());
+  const Dimensions dims({{Dimension::Tof, 1}, {Dimension::Spectrum, 2}});
+  EXPECT_EQ(result.dimensions<Data::Value>("sample"), dims);
+  const auto value = result.get<const Data::Value>("sample");
+  EXPECT_EQ(std::vector<double>(value.begin(), value.end()),
+            (std::vector<double>{2.5, 8.5}));
+  const auto variance = result.get<const Data::Variance>("sample");
+  EXPECT_EQ(std::vector<double>(variance.begin(), variance.end()),
+            (std::vector<double>{2.5, 8.5}));
+}
+
+TEST(Rebin, outer_dimension) {
+  const auto d = makeHistograms(
+      Dimensions({{Dimension::Spectrum, 2}, {Dimension::Tof, 4}}),
+      {Dimension::Tof, 5}, {0.0, 1.0, 2.0, 3.0, 4.0});
+  const auto result = rebin(
+      d, Dimension::Tof,
+      makeVariable<Coord::Tof>({Dimension::Tof, 3}, {0.0, 2.0, 4.0}));
+  const auto value = result.get<const Data::Value>("sample");
+  EXPECT_EQ(std::vector<double>(value.begin(), value.end()),
+            (std::vector<double>{4.0, 6.0, 12.0, 14.0}));
+}
+
+TEST(Rebin, spectrum_edges) {
+  const auto d = makeHistograms(
+      Dimensions({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}}),
+      Dimensions({{Dimension::Tof, 3}, {Dimension::Spectrum, 2}}),
+      {0.0, 1.0, 2.0, 1.0, 3.0, 5.0});
+  const auto result = rebin(
+      d, Dimension::Tof,
+      makeVariable<Coord::Tof>({Dimension::Tof, 3}, {0.0, 1.5, 4.0}));
+  const auto value = result.get<const Data::Value>("sample");
+  EXPECT_EQ(std::vector<double>(value.begin(), value.end()),
+            (std::vector<double>{2.0, 1.0, 0.75, 4.25}));
+}
+
+TEST(Rebin, large) {
+  // Enough histograms to run in parallel, and a number of histograms that is
+  // not a multiple of the block size. Per-spectrum edges with identical
+  // values must give the same result as shared edges.
+  const gsl::index spectra = 10007;
+  const gsl::index bins = 100;
+  std::vector<double> edges(bins + 1);
+  for (gsl::index i = 0; i <= bins; ++i)
+    edges[i] = 0.1 * i * i;
+  std::vector<double> spectrumEdges;
+  for (gsl::index i = 0; i < spectra; ++i)
+    spectrumEdges.insert(spectrumEdges.end(), edges.begin(), edges.end());
+  Dataset shared;
+  shared.insertAsEdge(Dimension::Tof,
+                      makeVariable<Coord::Tof>({Dimension::Tof, bins + 1},
+                                               edges.begin(), edges.end()));
+  Dataset individual;
+  individual.insertAsEdge(
+      Dimension::Tof,
+      makeVariable<Coord::Tof>(
+          Dimensions({{Dimension::Tof, bins + 1}, {Dimension::Spectrum,
+                                                   spectra}}),
+          spectrumEdges.begin(), spectrumEdges.end()));
+  const Dimensions dims({{Dimension::Tof, bins}, {Dimension::Spectrum,
+                                                  spectra}});
+  Vector<double> values(dims.volume());
+  for (gsl::index i = 0; i < dims.volume(); ++i)
+    values[i] = i % 17;
+  shared.insert<Data::Value>("sample", dims, values);
+  individual.insert<Data::Value>("sample", dims, values);
+
+  std::vector<double> newEdges;
+  for (double edge = -5.0; edge < 1100.0; edge += 7.3)
+    newEdges.push_back(edge);
+  const auto edgeVar = makeVariable<Coord::Tof>(
+      {Dimension::Tof, static_cast<gsl::index>(newEdges.size())},
+      newEdges.begin(), newEdges.end());
+  const auto a = rebin(shared, Dimension::Tof, edgeVar);
+  const auto b = rebin(individual, Dimension::Tof, edgeVar);
+  const auto valuesA = a.get<const Data::Value>("sample");
+  const auto valuesB = b.get<const Data::Value>("sample");
+  ASSERT_EQ(valuesA.size(), spectra * (newEdges.size() - 1));
+  ASSERT_EQ(valuesA.size(), valuesB.size());
+  for (gsl::index i = 0; i < valuesA.size(); ++i)
+    EXPECT_NEAR(valuesA[i], valuesB[i], 1e-9);
+  // Counts are conserved since the new edges cover the old edges.
+  for (gsl::index spectrum = 0; spectrum < spectra; spectrum += 1000) {
+    double before = 0.0;
+    double after = 0.0;
+    for (gsl::index i = 0; i < bins; ++i)
+      before += values[spectrum * bins + i];
+    for (gsl::index i = 0; i < newEdges.size() - 1; ++i)
+      after += valuesA[spectrum * (newEdges.size() - 1) + i];
+    EXPECT_NEAR(before, after, 1e-9);
+  }
+}
+
+TEST(Rebin, fail) {
+  const auto d = makeHistograms(
+      Dimensions({{Dimension::Tof, 2}, {Dimension::Spectrum, 2}}),
+      {Dimension::Tof, 3}, {0.0, 1.0, 2.0});
+  EXPECT_THROW_MSG(
+      rebin(d, Dimension::Tof,
+            makeVariable<Coord::X>({Dimension::Tof, 2}, {0.0, 1.0})),
+      std::runtime_error, "New bin edges must be a one-dimensional variable "
+                          "of the coordinate of the dimension.");
+  EXPECT_THROW_MSG(
+      rebin(d, Dimension::Tof,
+            makeVariable<Coord::Tof>({Dimension::Tof, 2}, {1.0, 0.0})),
+      std::runtime_error, "Bin edges must be strictly increasing.");
+  EXPECT_THROW_MSG(
+      rebin(d, Dimension::Spectrum,
+            makeVariable<Coord::Tof>({Dimension::Tof, 2}, {0.0, 1.0})),
+      std::runtime_error, "Rebinning is not supported for this dimension.");
+
+  auto withInt = d;
+  withInt.insert<Data::Int>("counts", {Dimension::Tof, 2}, {1l, 2l});
+  EXPECT_THROW_MSG(
+      rebin(withInt, Dimension::Tof,
+            makeVariable<Coord::Tof>({Dimension::Tof, 2}, {0.0, 1.0})),
+      std::runtime_error,
+      "Cannot rebin variables other than Data::Value and Data::Variance.");
+
+  Dataset points;
+  points.insert<Coord::Tof>({Dimension::Tof, 2}, {0.0, 1.0});
+  points.insert<Data::Value>("sample", {Dimension::Tof, 2}, {1.0, 2.0});
+  EXPECT_THROW_MSG(
+      rebin(points, Dimension::Tof,
+            makeVariable<Coord::Tof>({Dimension::Tof, 2}, {0.0, 1.0})),
+      std::runtime_error, "Rebinning requires bin edges.");
+}
@@ -0,0 +1,372 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include <omp.h>
+
+#include "test_macros.h"
+
+#include "reduce.h"
+
+namespace {
+std::vector<double> toVector(gsl::span<const double> values) {
+  return std::vector<double>(values.begin(), values.end());
+}
+
+/// Histograms with bin edges, 3 bins and 2 spectra.
+Dataset makeHistograms() {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 2}, {1, 2});
+  d.insert<Coord::L1>({}, {10.0});
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 4},
+                                          {0.0, 1.0, 2.0, 3.0}));
+  const Dimensions dims({{Dimension::Tof, 3}, {Dimension::Spectrum, 2}});
+  d.insert<Data::Value>("sample", dims, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  d.insert<Data::Variance>("sample", dims, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  return d;
+}
+}
+
+TEST(Reduce, sum_inner) {
+  const auto d = makeHistograms();
+  const auto result = sum(d, Dimension::Tof);
+  // The bin edges are dropped.
+  ASSERT_EQ(result.size(), 4);
+  EXPECT_EQ(result.get<const Coord::SpectrumNumber>(),
+            d.get<const Coord::SpectrumNumber>());
+  EXPECT_EQ(result.dimensions(), Dimensions(Dimension::Spectrum, 2));
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")),
+            (std::vector<double>{6.0, 15.0}));
+  EXPECT_EQ(toVector(result.get<const Data::Variance>("sample")),
+            (std::vector<double>{6.0, 15.0}));
+}
+
+TEST(Reduce, sum_outer) {
+  const auto d = makeHistograms();
+  const auto result = sum(d, Dimension::Spectrum);
+  ASSERT_EQ(result.size(), 4);
+  EXPECT_EQ(result.dimensions<Coord::Tof>(), Dimensions(Dimension::Tof, 4));
+  EXPECT_EQ(result.dimensions<Data::Value>("sample"),
+            Dimensions(Dimension::Tof, 3));
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")),
+            (std::vector<double>{5.0, 7.0, 9.0}));
+}
+
+TEST(Reduce, middle_dimension) {
+  Dataset d;
+  const Dimensions dims(
+      {{Dimension::X, 2}, {Dimension::Y, 3}, {Dimension::Z, 2}});
+  Vector<double> values(12);
+  std::iota(values.begin(), values.end(), 0.0);
+  d.insert<Data::Value>("", dims, values);
+  const auto result = sum(d, Dimension::Y);
+  EXPECT_EQ(result.dimensions<Data::Value>(),
+            Dimensions({{Dimension::X, 2}, {Dimension::Z, 2}}));
+  EXPECT_EQ(toVector(result.get<const Data::Value>()),
+            (std::vector<double>{6.0, 9.0, 24.0, 27.0}));
+}
+
+TEST(Reduce, mean) {
+  const auto result = mean(makeHistograms(), Dimension::Tof);
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")),
+            (std::vector<double>{2.0, 5.0}));
+  EXPECT_EQ(toVector(result.get<const Data::Variance>("sample")),
+            (std::vector<double>{6.0 / 9.0, 15.0 / 9.0}));
+}
+
+TEST(Reduce, min_max) {
+  auto d = makeHistograms();
+  d.erase<Data::Variance>();
+  EXPECT_EQ(toVector(min(d, Dimension::Tof).get<const Data::Value>("sample")),
+            (std::vector<double>{1.0, 4.0}));
+  EXPECT_EQ(toVector(max(d, Dimension::Tof).get<const Data::Value>("sample")),
+            (std::vector<double>{3.0, 6.0}));
+  EXPECT_EQ(
+      toVector(min(d, Dimension::Spectrum).get<const Data::Value>("sample")),
+      (std::vector<double>{1.0, 2.0, 3.0}));
+  EXPECT_EQ(
+      toVector(max(d, Dimension::Spectrum).get<const Data::Value>("sample")),
+      (std::vector<double>{4.0, 5.0, 6.0}));
+}
+
+TEST(Reduce, detector_grouping) {
+  Dataset d;
+  d.insert<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, 2}, Vector<std::vector<gsl::index>>{{0}, {1}});
+  d.insert<Data::Value>("", {Dimension::Detector, 2}, {1.0, 2.0});
+  const auto result = sum(d, Dimension::Detector);
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(toVector(result.get<const Data::Value>()),
+            (std::vector<double>{3.0}));
+}
+
+TEST(Reduce, large) {
+  // Covers splitting the work along the output and along the reduced
+  // dimension, for both inner and outer reduced dimensions. Integer values
+  // are summed exactly, so the order of operations does not matter.
+  for (const auto shape : {std::make_pair(gsl::index{3}, gsl::index{100003}),
+                           std::make_pair(gsl::index{100003}, gsl::index{3}),
+                           std::make_pair(gsl::index{1000}, gsl::index{999})}) {
+    const auto nx = shape.first;
+    const auto ny = shape.second;
+    Dataset d;
+    Vector<double> values(nx * ny);
+    for (gsl::index i = 0; i < values.size(); ++i)
+      values[i] = i % 7;
+    d.insert<Data::Value>("", Dimensions({{Dimension::X, nx},
+                                          {Dimension::Y, ny}}),
+                          values);
+    const auto sumX = toVector(sum(d, Dimension::X).get<const Data::Value>());
+    const auto sumY = toVector(sum(d, Dimension::Y).get<const Data::Value>());
+    const auto maxY = toVector(max(d, Dimension::Y).get<const Data::Value>());
+    ASSERT_EQ(sumX.size(), ny);
+    ASSERT_EQ(sumY.size(), nx);
+    std::vector<double> expectedX(ny, 0.0);
+    std::vector<double> expectedY(nx, 0.0);
+    std::vector<double> expectedMaxY(nx, 0.0);
+    for (gsl::index y = 0; y < ny; ++y)
+      for (gsl::index x = 0; x < nx; ++x) {
+        expectedX[y] += values[y * nx + x];
+        expectedY[x] += values[y * nx + x];
+        expectedMaxY[x] = std::max(expectedMaxY[x], values[y * nx + x]);
+      }
+    EXPECT_EQ(sumX, expectedX);
+    EXPECT_EQ(sumY, expectedY);
+    EXPECT_EQ(maxY, expectedMaxY);
+  }
+}
+
+TEST(Reduce, reproducible) {
+  // Long reduced dimensions, such that threads split the reduced dimension.
+  // The result must not depend on the number of threads.
+  const int maxThreads = omp_get_max_threads();
+  for (const auto shape : {std::make_pair(gsl::index{3}, gsl::index{300007}),
+                           std::make_pair(gsl::index{300007}, gsl::index{3})}) {
+    Dataset d;
+    const auto size = shape.first * shape.second;
+    Vector<double> values(size);
+    for (gsl::index i = 0; i < size; ++i)
+      values[i] = 1.0 / (1 + i % 1013) + 1e-3 * (i % 7);
+    d.insert<Data::Value>("", Dimensions({{Dimension::X, shape.first},
+                                          {Dimension::Y, shape.second}}),
+                          values);
+    const auto dim =
+        shape.first > shape.second ? Dimension::X : Dimension::Y;
+    for (const auto mode :
+         {ReductionMode::Reproducible, ReductionMode::Compensated}) {
+      std::vector<double> reference;
+      for (int threads = 1; threads <= std::max(8, maxThreads); ++threads) {
+        omp_set_num_threads(threads);
+        const auto result =
+            toVector(sum(d, dim, mode).get<const Data::Value>());
+        if (reference.empty())
+          reference = result;
+        else
+          EXPECT_EQ(result, reference);
+      }
+    }
+  }
+  omp_set_num_threads(maxThreads);
+}
+
+TEST(Reduce, compensated) {
+  Dataset d;
+  d.insert<Data::Value>("", {Dimension::X, 4}, {1.0, 1e100, 1.0, -1e100});
+  EXPECT_EQ(toVector(sum(d, Dimension::X).get<const Data::Value>()),
+            (std::vector<double>{0.0}));
+  EXPECT_EQ(toVector(sum(d, Dimension::X, ReductionMode::Compensated)
+                         .get<const Data::Value>()),
+            (std::vector<double>{2.0}));
+  EXPECT_EQ(toVector(mean(d, Dimension::X, ReductionMode::Compensated)
+                         .get<const Data::Value>()),
+            (std::vector<double>{0.5}));
+}
+
+TEST(Reduce, fail) {
+  const auto d = makeHistograms();
+  EXPECT_THROW_MSG(sum(d, Dimension::X), std::runtime_error,
+                   "Dataset does not contain the dimension to reduce.");
+  EXPECT_THROW_MSG(min(d, Dimension::Tof), std::runtime_error,
+                   "Cannot compute minimum or maximum of variances.");
+  auto withInt = d;
+  withInt.insert<Data::Int>("counts", {Dimension::Tof, 3}, {1l, 2l, 3l});
+  EXPECT_THROW_MSG(sum(withInt, Dimension::Tof), std::runtime_error,
+                   "Cannot reduce variables other than Data::Value and "
+                   "Data::Variance.");
+}
+
+TEST(Reduce, masked) {
+  const auto d = makeHistograms();
+  const auto mask = makeVariable<Coord::Mask>({Dimension::Spectrum, 2},
+                                              Vector<char>{1, 0});
+  const auto summed = sum(d, Dimension::Spectrum, mask);
+  EXPECT_EQ(toVector(summed.get<const Data::Value>("sample")),
+            (std::vector<double>{4.0, 5.0, 6.0}));
+  EXPECT_EQ(toVector(summed.get<const Data::Variance>("sample")),
+            (std::vector<double>{4.0, 5.0, 6.0}));
+  const auto tofMask =
+      makeVariable<Coord::Mask>({Dimension::Tof, 3}, Vector<char>{0, 1, 0});
+  const auto averaged = mean(d, Dimension::Tof, tofMask);
+  EXPECT_EQ(toVector(averaged.get<const Data::Value>("sample")),
+            (std::vector<double>{2.0, 5.0}));
+  EXPECT_EQ(toVector(averaged.get<const Data::Variance>("sample")),
+            (std::vector<double>{1.0, 2.5}));
+  auto values = d;
+  values.erase<Data::Variance>();
+  EXPECT_EQ(toVector(min(values, Dimension::Tof, tofMask)
+                         .get<const Data::Value>("sample")),
+            (std::vector<double>{1.0, 4.0}));
+  EXPECT_EQ(toVector(max(values, Dimension::Spectrum, mask)
+                         .get<const Data::Value>("sample")),
+            (std::vector<double>{4.0, 5.0, 6.0}));
+}
+
+TEST(Reduce, masked_large) {
+  // As Reduce.large, with masked slices in whole words and in mixed words.
+  for (const auto shape : {std::make_pair(gsl::index{3}, gsl::index{100003}),
+                           std::make_pair(gsl::index{100003}, gsl::index{3}),
+                           std::make_pair(gsl::index{1000}, gsl::index{999})}) {
+    const auto nx = shape.first;
+    const auto ny = shape.second;
+    Dataset d;
+    Vector<double> values(nx * ny);
+    for (gsl::index i = 0; i < values.size(); ++i)
+      values[i] = i % 7;
+    d.insert<Data::Value>("", Dimensions({{Dimension::X, nx},
+                                          {Dimension::Y, ny}}),
+                          values);
+    const auto masked = [](const gsl::index i) {
+      return (i / 128) % 3 == 0 || i % 5 == 0;
+    };
+    Vector<char> flagsX(nx);
+    for (gsl::index x = 0; x < nx; ++x)
+      flagsX[x] = masked(x);
+    Vector<char> flagsY(ny);
+    for (gsl::index y = 0; y < ny; ++y)
+      flagsY[y] = masked(y);
+    const auto sumX = toVector(
+        sum(d, Dimension::X,
+            makeVariable<Coord::Mask>({Dimension::X, nx}, flagsX))
+            .get<const Data::Value>());
+    const auto sumY = toVector(
+        sum(d, Dimension::Y,
+            makeVariable<Coord::Mask>({Dimension::Y, ny}, flagsY))
+            .get<const Data::Value>());
+    std::vector<double> expectedX(ny, 0.0);
+    std::vector<double> expectedY(nx, 0.0);
+    for (gsl::index y = 0; y < ny; ++y)
+      for (gsl::index x = 0; x < nx; ++x) {
+        if (!flagsX[x])
+          expectedX[y] += values[y * nx + x];
+        if (!flagsY[y])
+          expectedY[x] += values[y * nx + x];
+      }
+    EXPECT_EQ(sumX, expectedX);
+    EXPECT_EQ(sumY, expectedY);
+  }
+}
+
+TEST(Reduce, masked_fail) {
+  const auto d = makeHistograms();
+  EXPECT_THROW_MSG(
+      sum(d, Dimension::Spectrum,
+          makeVariable<Coord::Mask>({Dimension::Tof, 3}, 3)),
+      std::runtime_error,
+      "Mask must be a one-dimensional Coord::Mask variable along the reduced "
+      "dimension.");
+}
+
+namespace {
+Variable makeGrouping(const Vector<std::vector<gsl::index>> &groups) {
+  return makeVariable<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, static_cast<gsl::index>(groups.size())}, groups);
+}
+}
+
+TEST(GroupSum, histograms) {
+  auto d = makeHistograms();
+  d.insert<Coord::DetectorGrouping>(
+      {Dimension::Spectrum, 2}, Vector<std::vector<gsl::index>>{{0}, {1, 2}});
+  // Spectrum 1 is part of both groups, spectrum 0 of neither.
+  const auto result = groupSum(d, makeGrouping({{1}, {}, {1, 0}}));
+
+  // Coord::SpectrumNumber is dropped.
+  ASSERT_EQ(result.size(), 5);
+  EXPECT_EQ(result.dimensions<Coord::Tof>(), Dimensions(Dimension::Tof, 4));
+  const Dimensions dims({{Dimension::Tof, 3}, {Dimension::Spectrum, 3}});
+  EXPECT_EQ(result.dimensions<Data::Value>("sample"), dims);
+  const std::vector<double> expected{4.0, 5.0, 6.0, 0.0, 0.0,
+                                     0.0, 5.0, 7.0, 9.0};
+  EXPECT_EQ(toVector(result.get<const Data::Value>("sample")), expected);
+  EXPECT_EQ(toVector(result.get<const Data::Variance>("sample")), expected);
+  const auto detectors = result.get<const Coord::DetectorGrouping>();
+  ASSERT_EQ(detectors.size(), 3);
+  EXPECT_EQ(std::vector<gsl::index>(detectors[0].begin(), detectors[0].end()),
+            (std::vector<gsl::index>{1, 2}));
+  EXPECT_TRUE(detectors[1].empty());
+  EXPECT_EQ(std::vector<gsl::index>(detectors[2].begin(), detectors[2].end()),
+            (std::vector<gsl::index>{1, 2, 0}));
+}
+
+TEST(GroupSum, outer_dimensions) {
+  // Spectrum is the inner dimension, with an outer dimension.
+  Dataset d;
+  d.insert<Data::Value>(
+      "", Dimensions({{Dimension::Spectrum, 3}, {Dimension::Tof, 2}}),
+      {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const auto result = groupSum(d, makeGrouping({{0, 2}, {1}}));
+  EXPECT_EQ(result.dimensions(),
+            Dimensions({{Dimension::Spectrum, 2}, {Dimension::Tof, 2}}));
+  EXPECT_EQ(toVector(result.get<const Data::Value>()),
+            (std::vector<double>{4.0, 2.0, 10.0, 5.0}));
+}
+
+TEST(GroupSum, large) {
+  // Few large groups, such that threads split the rows of the output, and many
+  // small groups. Integer values are summed exactly.
+  const gsl::index spectra = 20011;
+  const gsl::index bins = 37;
+  const Dimensions dims({{Dimension::Tof, bins}, {Dimension::Spectrum,
+                                                  spectra}});
+  Vector<double> values(dims.volume());
+  for (gsl::index i = 0; i < values.size(); ++i)
+    values[i] = i % 7;
+  Dataset d;
+  d.insert<Data::Value>("", dims, values);
+  for (const gsl::index groups : {gsl::index{3}, gsl::index{5003}}) {
+    Vector<std::vector<gsl::index>> grouping(groups);
+    for (gsl::index spectrum = 0; spectrum < spectra; ++spectrum)
+      grouping[spectrum % groups].push_back(spectrum);
+    const auto result =
+        toVector(groupSum(d, makeGrouping(grouping)).get<const Data::Value>());
+    std::vector<double> expected(groups * bins, 0.0);
+    for (gsl::index spectrum = 0; spectrum < spectra; ++spectrum)
+      for (gsl::index bin = 0; bin < bins; ++bin)
+        expected[(spectrum % groups) * bins + bin] +=
+            values[spectrum * bins + bin];
+    EXPECT_EQ(result, expected);
+  }
+}
+
+TEST(GroupSum, fail) {
+  const auto d = makeHistograms();
+  EXPECT_THROW_MSG(groupSum(d, makeGrouping({{0}, {2}})), std::runtime_error,
+                   "Spectrum index in grouping out of range.");
+  EXPECT_THROW_MSG(groupSum(d, makeVariable<Coord::DetectorGrouping>(
+                                   {Dimension::Detector, 1},
+                                   Vector<std::vector<gsl::index>>{{0}})),
+                   std::runtime_error,
+                   "Grouping must be a Coord::DetectorGrouping variable with "
+                   "Dimension::Spectrum.");
+  Dataset noSpectra;
+  noSpectra.insert<Data::Value>("", {Dimension::Tof, 2}, {1.0, 2.0});
+  EXPECT_THROW_MSG(groupSum(noSpectra, makeGrouping({{0}})),
+                   std::runtime_error,
+                   "Dataset does not contain the dimension to reduce.");
+}
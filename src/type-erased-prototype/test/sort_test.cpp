@@ -0,0 +1,529 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "test_macros.h"
+
+#include "sort.h"
+
+namespace {
+template <class T> std::vector<T> toVector(gsl::span<const T> values) {
+  return std::vector<T>(values.begin(), values.end());
+}
+}
+
+TEST(Sort, table) {
+  Dataset table;
+  table.insert<Coord::Temperature>({Dimension::Row, 4},
+                                   {300.0, 4.0, 77.0, 4.0});
+  table.insert<Data::Value>("counts", {Dimension::Row, 4},
+                            {1.0, 2.0, 3.0, 4.0});
+  table.insert<Data::String>("comment", {Dimension::Row, 4},
+                             std::vector<std::string>{"a", "b", "c", "d"});
+  table.insert<Data::Value>("total", {}, {10.0});
+  const auto sorted = sort<Coord::Temperature>(table, Dimension::Row);
+
+  ASSERT_EQ(sorted.size(), 4);
+  EXPECT_EQ(toVector(sorted.get<const Coord::Temperature>()),
+            (std::vector<double>{4.0, 4.0, 77.0, 300.0}));
+  // Stable, rows with equal temperature keep their order.
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>("counts")),
+            (std::vector<double>{2.0, 4.0, 3.0, 1.0}));
+  const auto comment = sorted.get<const Data::String>("comment");
+  EXPECT_EQ(std::vector<std::string>(comment.begin(), comment.end()),
+            (std::vector<std::string>{"b", "d", "c", "a"}));
+  // Variables without the dimension share their data.
+  EXPECT_EQ(&sorted[sorted.find(tag_id<Data::Value>, "total")].data(),
+            &table[table.find(tag_id<Data::Value>, "total")].data());
+  // The input is unchanged.
+  EXPECT_EQ(toVector(table.get<const Coord::Temperature>()),
+            (std::vector<double>{300.0, 4.0, 77.0, 4.0}));
+}
+
+TEST(Sort, spectra) {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {3, 1, 2});
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 3},
+                                          {0.0, 1.0, 2.0}));
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 3}});
+  d.insert<Data::Value>("sample", dims, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const auto sorted = sort<Coord::SpectrumNumber>(d, Dimension::Spectrum);
+  EXPECT_EQ(toVector(sorted.get<const Coord::SpectrumNumber>()),
+            (std::vector<int32_t>{1, 2, 3}));
+  EXPECT_EQ(sorted.dimensions<Coord::Tof>(), Dimensions(Dimension::Tof, 3));
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>("sample")),
+            (std::vector<double>{3.0, 4.0, 5.0, 6.0, 1.0, 2.0}));
+}
+
+TEST(Sort, inner_dimension) {
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 3}, {2.0, 0.0, 1.0});
+  d.insert<Data::Value>(
+      "", Dimensions({{Dimension::X, 3}, {Dimension::Y, 2}}),
+      {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const auto sorted = sort<Coord::X>(d, Dimension::X);
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>()),
+            (std::vector<double>{2.0, 3.0, 1.0, 5.0, 6.0, 4.0}));
+}
+
+TEST(Sort, nan_last) {
+  const auto nan = std::numeric_limits<double>::quiet_NaN();
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 5}, {nan, 1.0, nan, -1.0, 0.0});
+  d.insert<Data::Value>("", {Dimension::X, 5}, {1.0, 2.0, 3.0, 4.0, 5.0});
+  const auto sorted = sort<Coord::X>(d, Dimension::X);
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>()),
+            (std::vector<double>{4.0, 5.0, 2.0, 1.0, 3.0}));
+}
+
+TEST(Sort, strings) {
+  Dataset d;
+  d.insert<Coord::RowLabel>({Dimension::Row, 3},
+                            std::vector<std::string>{"c", "ab", "b"});
+  d.insert<Data::Value>("", {Dimension::Row, 3}, {1.0, 2.0, 3.0});
+  const auto sorted = sort<Coord::RowLabel>(d, Dimension::Row);
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>()),
+            (std::vector<double>{2.0, 3.0, 1.0}));
+}
+
+TEST(Sort, large) {
+  // Enough elements for the parallel sort, compared against std::stable_sort.
+  const gsl::index size = 300007;
+  Vector<int32_t> keys(size);
+  Vector<double> values(size);
+  for (gsl::index i = 0; i < size; ++i) {
+    keys[i] = (i * 7919) % 1009;
+    values[i] = i;
+  }
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, size}, keys);
+  d.insert<Data::Value>("a", {Dimension::Spectrum, size}, values);
+  d.insert<Data::Variance>("a", {Dimension::Spectrum, size}, values);
+  const auto sorted = sort<Coord::SpectrumNumber>(d, Dimension::Spectrum);
+
+  std::vector<gsl::index> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const gsl::index a, const gsl::index b) {
+                     return keys[a] < keys[b];
+                   });
+  std::vector<double> expected(size);
+  for (gsl::index i = 0; i < size; ++i)
+    expected[i] = values[order[i]];
+  EXPECT_EQ(toVector(sorted.get<const Data::Value>("a")), expected);
+  EXPECT_EQ(toVector(sorted.get<const Data::Variance>("a")), expected);
+  const auto sortedKeys = toVector(sorted.get<const Coord::SpectrumNumber>());
+  EXPECT_TRUE(std::is_sorted(sortedKeys.begin(), sortedKeys.end()));
+}
+
+TEST(Sort, fail) {
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 2}, {1.0, 0.0});
+  d.insert<Coord::Y>({Dimension::Y, 2}, {1.0, 0.0});
+  d.insert<Coord::DetectorGrouping>(
+      {Dimension::X, 2}, Vector<std::vector<gsl::index>>{{0}, {1}});
+  EXPECT_THROW_MSG(sort<Coord::Y>(d, Dimension::X), std::runtime_error,
+                   "Sort key must be a one-dimensional variable along the "
+                   "sorted dimension.");
+  EXPECT_THROW_MSG(sort<Coord::DetectorGrouping>(d, Dimension::X),
+                   std::runtime_error,
+                   "Sort key must be a variable of numbers or strings.");
+  EXPECT_THROW_MSG(sort<Coord::Z>(d, Dimension::X), std::runtime_error,
+                   "Dataset does not contain such a variable.");
+
+  Dataset edges;
+  edges.insert<Coord::Y>({Dimension::Y, 2}, {1.0, 0.0});
+  edges.insertAsEdge(Dimension::Y,
+                     makeVariable<Coord::X>({Dimension::Y, 3},
+                                            {0.0, 1.0, 2.0}));
+  EXPECT_THROW_MSG(sort<Coord::Y>(edges, Dimension::Y), std::runtime_error,
+                   "Cannot sort along a dimension with bin edges.");
+}
+
+TEST(Filter, table) {
+  Dataset table;
+  table.insert<Coord::Temperature>({Dimension::Row, 4},
+                                   {300.0, 4.0, 77.0, 4.0});
+  table.insert<Data::String>("comment", {Dimension::Row, 4},
+                             std::vector<std::string>{"a", "b", "c", "d"});
+  table.insert<Data::Value>("total", {}, {10.0});
+  const auto mask =
+      makeVariable<Coord::Mask>({Dimension::Row, 4}, Vector<char>{1, 0, 0, 1});
+  const auto filtered = filter(table, Dimension::Row, mask);
+
+  ASSERT_EQ(filtered.size(), 3);
+  EXPECT_EQ(filtered.dimensions().size(Dimension::Row), 2);
+  EXPECT_EQ(toVector(filtered.get<const Coord::Temperature>()),
+            (std::vector<double>{4.0, 77.0}));
+  const auto comment = filtered.get<const Data::String>("comment");
+  EXPECT_EQ(std::vector<std::string>(comment.begin(), comment.end()),
+            (std::vector<std::string>{"b", "c"}));
+  EXPECT_EQ(&filtered[filtered.find(tag_id<Data::Value>, "total")].data(),
+            &table[table.find(tag_id<Data::Value>, "total")].data());
+}
+
+TEST(Filter, masked_spectra) {
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, 3}, {1, 2, 3});
+  d.insert<Coord::Mask>({Dimension::Spectrum, 3}, Vector<char>{0, 1, 0});
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 3},
+                                          {0.0, 1.0, 2.0}));
+  const Dimensions dims({{Dimension::Tof, 2}, {Dimension::Spectrum, 3}});
+  d.insert<Data::Value>("sample", dims, {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const auto filtered =
+      filter(d, Dimension::Spectrum, d[d.find(tag_id<Coord::Mask>, "")]);
+  EXPECT_EQ(toVector(filtered.get<const Coord::SpectrumNumber>()),
+            (std::vector<int32_t>{1, 3}));
+  EXPECT_EQ(filtered.dimensions<Coord::Tof>(), Dimensions(Dimension::Tof, 3));
+  EXPECT_EQ(toVector(filtered.get<const Data::Value>("sample")),
+            (std::vector<double>{1.0, 2.0, 5.0, 6.0}));
+}
+
+TEST(Filter, large) {
+  // Several blocks of the mask, compacted in parallel.
+  const gsl::index size = 300007;
+  Vector<char> mask(size);
+  Vector<double> values(size);
+  std::vector<double> expected;
+  for (gsl::index i = 0; i < size; ++i) {
+    mask[i] = (i * 7919) % 13 < 5;
+    values[i] = i;
+    if (!mask[i])
+      expected.push_back(i);
+  }
+  Dataset d;
+  d.insert<Data::Value>("a", {Dimension::Row, size}, values);
+  d.insert<Data::Variance>("a", Dimensions({{Dimension::X, 2},
+                                            {Dimension::Row, size}}),
+                           2 * size, 1.0);
+  const auto filtered = filter(
+      d, Dimension::Row, makeVariable<Coord::Mask>({Dimension::Row, size},
+                                                   mask));
+  EXPECT_EQ(toVector(filtered.get<const Data::Value>("a")), expected);
+  EXPECT_EQ(filtered.dimensions<Data::Variance>("a"),
+            Dimensions({{Dimension::X, 2},
+                        {Dimension::Row,
+                         static_cast<gsl::index>(expected.size())}}));
+}
+
+TEST(Filter, fail) {
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 2}, {1.0, 0.0});
+  d.insertAsEdge(Dimension::X,
+                 makeVariable<Coord::Y>({Dimension::X, 3}, {0.0, 1.0, 2.0}));
+  EXPECT_THROW_MSG(
+      filter(d, Dimension::X,
+             makeVariable<Coord::Mask>({Dimension::X, 3}, 3, char{1})),
+      std::runtime_error,
+      "Mask must be a one-dimensional Coord::Mask variable along the "
+      "filtered dimension.");
+  EXPECT_THROW_MSG(
+      filter(d, Dimension::X, makeVariable<Coord::X>({Dimension::X, 2}, 2)),
+      std::runtime_error,
+      "Mask must be a one-dimensional Coord::Mask variable along the "
+      "filtered dimension.");
+  EXPECT_THROW_MSG(
+      filter(d, Dimension::X,
+             makeVariable<Coord::Mask>({Dimension::X, 2}, 2, char{0})),
+      std::runtime_error, "Cannot filter along a dimension with bin edges.");
+  EXPECT_THROW_MSG(
+      filter(d, Dimension::X,
+             makeVariable<Coord::Mask>({Dimension::X, 2}, 2, char{1})),
+      std::runtime_error, "Cannot filter out all slices.");
+}
+
+namespace {
+Dataset makeDetectorTable() {
+  Dataset d;
+  d.insert<Coord::DetectorId>({Dimension::Row, 5}, {3, 1, 7, 3, 2});
+  d.insert<Data::Value>("counts", {Dimension::Row, 5},
+                        {1.0, 2.0, 3.0, 4.0, 5.0});
+  d.insert<Data::Value>("total", {}, {15.0});
+  return d;
+}
+
+Dataset makeCalibrationTable() {
+  Dataset d;
+  d.insert<Coord::DetectorId>({Dimension::Row, 4}, {1, 2, 3, 4});
+  d.insert<Data::Value>("efficiency", {Dimension::Row, 4},
+                        {0.1, 0.2, 0.3, 0.4});
+  d.insert<Data::String>("status", {Dimension::Row, 4},
+                         std::vector<std::string>{"a", "b", "c", "d"});
+  d.insert<Data::Value>("total", {}, {15.0});
+  return d;
+}
+
+std::vector<std::string> strings(const Dataset &d, const std::string &name) {
+  const auto values = d.get<const Data::String>(name);
+  return std::vector<std::string>(values.begin(), values.end());
+}
+}
+
+TEST(Join, inner) {
+  const auto joined =
+      join<Coord::DetectorId>(makeDetectorTable(), makeCalibrationTable(),
+                              Dimension::Row);
+  ASSERT_EQ(joined.size(), 5);
+  EXPECT_EQ(joined.dimensions(), Dimensions(Dimension::Row, 4));
+  EXPECT_EQ(toVector(joined.get<const Coord::DetectorId>()),
+            (std::vector<int32_t>{3, 1, 3, 2}));
+  EXPECT_EQ(toVector(joined.get<const Data::Value>("counts")),
+            (std::vector<double>{1.0, 2.0, 4.0, 5.0}));
+  EXPECT_EQ(toVector(joined.get<const Data::Value>("efficiency")),
+            (std::vector<double>{0.3, 0.1, 0.3, 0.2}));
+  EXPECT_EQ(strings(joined, "status"),
+            (std::vector<std::string>{"c", "a", "c", "b"}));
+  EXPECT_EQ(toVector(joined.get<const Data::Value>("total")),
+            (std::vector<double>{15.0}));
+}
+
+TEST(Join, left) {
+  const auto joined =
+      join<Coord::DetectorId>(makeDetectorTable(), makeCalibrationTable(),
+                              Dimension::Row, JoinMode::Left);
+  EXPECT_EQ(toVector(joined.get<const Coord::DetectorId>()),
+            (std::vector<int32_t>{3, 1, 7, 3, 2}));
+  EXPECT_EQ(toVector(joined.get<const Data::Value>("counts")),
+            (std::vector<double>{1.0, 2.0, 3.0, 4.0, 5.0}));
+  auto efficiency = toVector(joined.get<const Data::Value>("efficiency"));
+  ASSERT_EQ(efficiency.size(), 5);
+  EXPECT_TRUE(std::isnan(efficiency[2]));
+  efficiency[2] = 0.0;
+  EXPECT_EQ(efficiency, (std::vector<double>{0.3, 0.1, 0.0, 0.3, 0.2}));
+  EXPECT_EQ(strings(joined, "status"),
+            (std::vector<std::string>{"c", "a", "", "c", "b"}));
+}
+
+TEST(Join, outer) {
+  const auto joined =
+      join<Coord::DetectorId>(makeDetectorTable(), makeCalibrationTable(),
+                              Dimension::Row, JoinMode::Outer);
+  EXPECT_EQ(toVector(joined.get<const Coord::DetectorId>()),
+            (std::vector<int32_t>{3, 1, 7, 3, 2, 4}));
+  auto counts = toVector(joined.get<const Data::Value>("counts"));
+  ASSERT_EQ(counts.size(), 6);
+  EXPECT_TRUE(std::isnan(counts[5]));
+  EXPECT_EQ(toVector(joined.get<const Data::Value>("efficiency"))[5], 0.4);
+  EXPECT_EQ(strings(joined, "status")[5], "d");
+}
+
+TEST(Join, string_keys) {
+  Dataset left;
+  left.insert<Coord::RowLabel>({Dimension::Row, 3},
+                               Vector<std::string>{"x", "y", "z"});
+  left.insert<Data::Value>("a", {Dimension::Row, 3}, {1.0, 2.0, 3.0});
+  Dataset right;
+  right.insert<Coord::RowLabel>({Dimension::Row, 2},
+                                Vector<std::string>{"z", "w"});
+  right.insert<Data::Int>("b", {Dimension::Row, 2}, {10l, 20l});
+  const auto joined =
+      join<Coord::RowLabel>(left, right, Dimension::Row, JoinMode::Outer);
+  const auto labels = joined.get<const Coord::RowLabel>();
+  EXPECT_EQ(std::vector<std::string>(labels.begin(), labels.end()),
+            (std::vector<std::string>{"x", "y", "z", "w"}));
+  EXPECT_EQ(toVector(joined.get<const Data::Int>("b")),
+            (std::vector<int64_t>{0, 0, 10, 20}));
+}
+
+TEST(Join, large) {
+  // Large enough for the index to be built in partitions. Every other
+  // detector of the data has a calibration, in reverse order.
+  const gsl::index detectors = 1000003;
+  Vector<int32_t> ids(detectors);
+  std::iota(ids.begin(), ids.end(), 0);
+  Dataset data;
+  data.insert<Coord::DetectorId>({Dimension::Row, detectors}, ids);
+  Vector<double> counts(ids.begin(), ids.end());
+  data.insert<Data::Value>("counts", {Dimension::Row, detectors}, counts);
+
+  const gsl::index calibrated = (detectors + 1) / 2;
+  Vector<int32_t> calibrationIds(calibrated);
+  Vector<double> efficiency(calibrated);
+  for (gsl::index i = 0; i < calibrated; ++i) {
+    calibrationIds[i] = 2 * (calibrated - 1 - i);
+    efficiency[i] = 0.5 * calibrationIds[i];
+  }
+  Dataset calibration;
+  calibration.insert<Coord::DetectorId>({Dimension::Row, calibrated},
+                                        calibrationIds);
+  calibration.insert<Data::Value>("efficiency", {Dimension::Row, calibrated},
+                                  efficiency);
+
+  const auto joined =
+      join<Coord::DetectorId>(data, calibration, Dimension::Row);
+  ASSERT_EQ(joined.dimensions(), Dimensions(Dimension::Row, calibrated));
+  const auto joinedIds = joined.get<const Coord::DetectorId>();
+  const auto joinedCounts = joined.get<const Data::Value>("counts");
+  const auto joinedEfficiency = joined.get<const Data::Value>("efficiency");
+  for (gsl::index i = 0; i < calibrated; ++i) {
+    ASSERT_EQ(joinedIds[i], 2 * i);
+    ASSERT_EQ(joinedCounts[i], 2 * i);
+    ASSERT_EQ(joinedEfficiency[i], i);
+  }
+
+  const auto outer = join<Coord::DetectorId>(calibration, data,
+                                             Dimension::Row, JoinMode::Outer);
+  ASSERT_EQ(outer.dimensions(), Dimensions(Dimension::Row, detectors));
+  const auto outerIds = outer.get<const Coord::DetectorId>();
+  // Detectors without calibration follow in order.
+  for (gsl::index i = calibrated; i < detectors; ++i)
+    ASSERT_EQ(outerIds[i], 2 * (i - calibrated) + 1);
+}
+
+TEST(Join, fail) {
+  const auto data = makeDetectorTable();
+  auto calibration = makeCalibrationTable();
+  EXPECT_THROW_MSG(
+      join<Coord::SpectrumNumber>(data, calibration, Dimension::Row),
+      std::runtime_error,
+      "Join key must be a one-dimensional coordinate along the joined "
+      "dimension in both datasets.");
+  EXPECT_THROW_MSG(join<Coord::DetectorId>(calibration, data, Dimension::Row),
+                   std::runtime_error,
+                   "Axis contains duplicate labels. Cannot use it to index "
+                   "into the data.");
+  Dataset positions;
+  positions.insert<Coord::DetectorId>({Dimension::Row, 1}, {9});
+  positions.insert<Data::Value>("counts", {Dimension::Row, 1}, {1.0});
+  EXPECT_THROW_MSG(join<Coord::DetectorId>(data, positions, Dimension::Row),
+                   std::runtime_error,
+                   "Cannot join datasets without matching keys.");
+  EXPECT_THROW_MSG(join<Coord::DetectorId>(data, positions, Dimension::Row,
+                                           JoinMode::Left),
+                   std::runtime_error,
+                   "Attempt to insert data of same type with duplicate name.");
+  calibration.get<Data::Value>("total")[0] = 1.0;
+  EXPECT_THROW_MSG(join<Coord::DetectorId>(data, calibration, Dimension::Row),
+                   std::runtime_error,
+                   "Cannot join datasets with different variables not "
+                   "depending on the joined dimension.");
+}
+
+TEST(Select, points) {
+  Dataset d;
+  d.insert<Coord::Temperature>({Dimension::Temperature, 5},
+                               {4.0, 10.0, 77.0, 200.0, 300.0});
+  d.insert<Data::Value>(
+      "sample",
+      Dimensions({{Dimension::X, 2}, {Dimension::Temperature, 5}}),
+      {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0});
+  d.insert<Data::Value>("total", {}, {55.0});
+  EXPECT_EQ(selectRange<Coord::Temperature>(d, Dimension::Temperature, 10.0,
+                                            250.0),
+            std::make_pair(gsl::index{1}, gsl::index{4}));
+  // The upper bound is exclusive.
+  EXPECT_EQ(selectRange<Coord::Temperature>(d, Dimension::Temperature, 0.0,
+                                            200.0),
+            std::make_pair(gsl::index{0}, gsl::index{3}));
+  EXPECT_EQ(selectRange<Coord::Temperature>(d, Dimension::Temperature, 301.0,
+                                            400.0),
+            std::make_pair(gsl::index{5}, gsl::index{5}));
+  EXPECT_EQ(selectRange<Coord::Temperature>(d, Dimension::Temperature, 80.0,
+                                            20.0),
+            std::make_pair(gsl::index{3}, gsl::index{3}));
+
+  const auto selected =
+      select<Coord::Temperature>(d, Dimension::Temperature, 10.0, 250.0);
+  EXPECT_EQ(toVector(selected.get<const Coord::Temperature>()),
+            (std::vector<double>{10.0, 77.0, 200.0}));
+  EXPECT_EQ(toVector(selected.get<const Data::Value>("sample")),
+            (std::vector<double>{3.0, 4.0, 5.0, 6.0, 7.0, 8.0}));
+  EXPECT_EQ(&selected[selected.find(tag_id<Data::Value>, "total")].data(),
+            &d[d.find(tag_id<Data::Value>, "total")].data());
+}
+
+TEST(Select, bin_edges) {
+  Dataset d;
+  d.insertAsEdge(Dimension::Tof,
+                 makeVariable<Coord::Tof>({Dimension::Tof, 5},
+                                          {0.0, 1.0, 2.0, 4.0, 8.0}));
+  d.insert<Data::Value>("sample", {Dimension::Tof, 4}, {1.0, 2.0, 3.0, 4.0});
+  // Bins overlapping the range.
+  EXPECT_EQ(selectRange<Coord::Tof>(d, Dimension::Tof, 1.5, 4.0),
+            std::make_pair(gsl::index{1}, gsl::index{3}));
+  EXPECT_EQ(selectRange<Coord::Tof>(d, Dimension::Tof, -1.0, 100.0),
+            std::make_pair(gsl::index{0}, gsl::index{4}));
+  EXPECT_EQ(selectRange<Coord::Tof>(d, Dimension::Tof, 8.0, 9.0),
+            std::make_pair(gsl::index{4}, gsl::index{4}));
+
+  const auto selected = select<Coord::Tof>(d, Dimension::Tof, 1.5, 4.0);
+  EXPECT_EQ(selected.dimensions(), Dimensions(Dimension::Tof, 2));
+  EXPECT_EQ(toVector(selected.get<const Coord::Tof>()),
+            (std::vector<double>{1.0, 2.0, 4.0}));
+  EXPECT_EQ(toVector(selected.get<const Data::Value>("sample")),
+            (std::vector<double>{2.0, 3.0}));
+}
+
+TEST(Select, nearest) {
+  Dataset d;
+  d.insert<Coord::X>({Dimension::X, 4}, {0.0, 1.0, 3.0, 7.0});
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, -5.0), 0);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 0.4), 0);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 0.5), 0);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 0.6), 1);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 3.0), 2);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 5.5), 3);
+  EXPECT_EQ(nearest<Coord::X>(d, Dimension::X, 100.0), 3);
+
+  Dataset histogram;
+  histogram.insertAsEdge(
+      Dimension::Tof,
+      makeVariable<Coord::Tof>({Dimension::Tof, 4}, {0.0, 1.0, 2.0, 4.0}));
+  histogram.insert<Data::Value>("", {Dimension::Tof, 3}, {1.0, 2.0, 3.0});
+  EXPECT_EQ(nearest<Coord::Tof>(histogram, Dimension::Tof, -1.0), 0);
+  EXPECT_EQ(nearest<Coord::Tof>(histogram, Dimension::Tof, 1.0), 1);
+  EXPECT_EQ(nearest<Coord::Tof>(histogram, Dimension::Tof, 3.9), 2);
+  EXPECT_EQ(nearest<Coord::Tof>(histogram, Dimension::Tof, 4.0), 2);
+}
+
+TEST(Select, large) {
+  // Integer coordinates compare exactly with the bounds.
+  const gsl::index size = 1000003;
+  Vector<int32_t> numbers(size);
+  std::iota(numbers.begin(), numbers.end(), 0);
+  for (auto &number : numbers)
+    number *= 3;
+  Dataset d;
+  d.insert<Coord::SpectrumNumber>({Dimension::Spectrum, size}, numbers);
+  EXPECT_EQ(selectRange<Coord::SpectrumNumber>(d, Dimension::Spectrum,
+                                               1000.0, 2000.0),
+            std::make_pair(gsl::index{334}, gsl::index{667}));
+  EXPECT_EQ(nearest<Coord::SpectrumNumber>(d, Dimension::Spectrum, 2000.0),
+            667);
+  const auto selected = select<Coord::SpectrumNumber>(d, Dimension::Spectrum,
+                                                      999.0, 2001.0);
+  EXPECT_EQ(selected.dimensions(), Dimensions(Dimension::Spectrum, 334));
+  EXPECT_EQ(selected.get<const Coord::SpectrumNumber>()[0], 999);
+}
+
+TEST(Select, fail) {
+  Dataset d;
+  d.insert<Coord::X>(
+      Dimensions({{Dimension::X, 2}, {Dimension::Y, 2}}), 4);
+  d.insert<Coord::RowLabel>({Dimension::Row, 2},
+                            Vector<std::string>{"a", "b"});
+  d.insert<Coord::Y>({Dimension::Y, 2}, {0.0, 1.0});
+  EXPECT_THROW_MSG(select<Coord::X>(d, Dimension::X, 0.0, 1.0),
+                   std::runtime_error,
+                   "Selection requires a one-dimensional coordinate along "
+                   "the selected dimension.");
+  EXPECT_THROW_MSG(select<Coord::Z>(d, Dimension::Z, 0.0, 1.0),
+                   std::runtime_error,
+                   "Selection requires a one-dimensional coordinate along "
+                   "the selected dimension.");
+  EXPECT_THROW_MSG(nearest<Coord::RowLabel>(d, Dimension::Row, 0.0),
+                   std::runtime_error,
+                   "Selection requires a coordinate of numbers.");
+  EXPECT_THROW_MSG(select<Coord::Y>(d, Dimension::Y, 2.0, 3.0),
+                   std::runtime_error, "Cannot select an empty range.");
+}
@@ -0,0 +1,154 @@
+/// @file
+/// SPDX-License-Identifier: GPL-3.0-or-later
+/// @author Simon Heybrock
+/// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
+/// National Laboratory, and European Spallation Source ERIC.
+#include <gtest/gtest.h>
+
+#include "test_macros.h"
+
+#include "dataset_view.h"
+#include "string_column.h"
+
+TEST(StringColumn, construct) {
+  StringColumn empty;
+  EXPECT_EQ(empty.size(), 0);
+  StringColumn blank(3);
+  ASSERT_EQ(blank.size(), 3);
+  EXPECT_EQ(blank[2], "");
+
+  StringColumn column(Vector<std::string>{"a", "", "bcd"});
+  ASSERT_EQ(column.size(), 3);
+  EXPECT_EQ(column[0], "a");
+  EXPECT_EQ(column[1], "");
+  EXPECT_EQ(column[2], "bcd");
+  EXPECT_EQ(column.offsets(), (Vector<int64_t>{0, 1, 1, 4}));
+  EXPECT_EQ(column.values().size(), 4);
+}
+
+TEST(StringColumn, construct_from_buffers) {
+  StringColumn column(Vector<int64_t>{0, 2, 3}, Vector<char>{'a', 'b', 'c'});
+  EXPECT_EQ(column, StringColumn({"ab", "c"}));
+  EXPECT_THROW_MSG(
+      StringColumn(Vector<int64_t>{0, 2}, Vector<char>{'a'}),
+      std::runtime_error, "Offsets do not match buffer size.");
+  EXPECT_THROW_MSG(
+      StringColumn(Vector<int64_t>{0, 2, 1}, Vector<char>{'a'}),
+      std::runtime_error, "Offsets must be non-decreasing.");
+}
+
+TEST(StringColumn, assign) {
+  StringColumn column({"a", "bc", "d"});
+  column[1] = "xy";
+  EXPECT_EQ(column, StringColumn({"a", "xy", "d"}));
+  column[1] = "longer";
+  EXPECT_EQ(column, StringColumn({"a", "longer", "d"}));
+  column[0] = "";
+  EXPECT_EQ(column, StringColumn({"", "longer", "d"}));
+  EXPECT_EQ(column.offsets(), (Vector<int64_t>{0, 0, 6, 7}));
+}
+
+TEST(StringColumn, assign_from_self) {
+  StringColumn column({"a", "bcd", "e"});
+  column[0] = column[1];
+  EXPECT_EQ(column, StringColumn({"bcd", "bcd", "e"}));
+  column[2] = column[0];
+  EXPECT_EQ(column, StringColumn({"bcd", "bcd", "bcd"}));
+  column.push_back(column[0]);
+  EXPECT_EQ(column[3], "bcd");
+}
+
+TEST(StringColumn, resize) {
+  StringColumn column({"a", "bc"});
+  column.resize(3);
+  EXPECT_EQ(column, StringColumn({"a", "bc", ""}));
+  column.resize(1);
+  EXPECT_EQ(column, StringColumn({"a"}));
+  EXPECT_EQ(column.values().size(), 1);
+}
+
+TEST(StringColumn, iterate) {
+  StringColumn column({"a", "bc"});
+  std::vector<std::string> strings;
+  for (const auto &item : column)
+    strings.emplace_back(item);
+  EXPECT_EQ(strings, std::vector<std::string>({"a", "bc"}));
+  for (auto item : column)
+    item = "x";
+  EXPECT_EQ(column, StringColumn({"x", "x"}));
+}
+
+TEST(DictionaryColumn, encode) {
+  DictionaryColumn column({"up", "down", "up", "up"});
+  ASSERT_EQ(column.size(), 4);
+  EXPECT_EQ(column[2], "up");
+  EXPECT_EQ(column.codes(), (Vector<int32_t>{0, 1, 0, 0}));
+  EXPECT_EQ(column.dictionary(), StringColumn({"up", "down"}));
+  column[0] = "down";
+  column[1] = "none";
+  EXPECT_EQ(column.codes(), (Vector<int32_t>{1, 2, 0, 0}));
+  EXPECT_EQ(column.dictionary().size(), 3);
+}
+
+TEST(DictionaryColumn, resize) {
+  DictionaryColumn column(2);
+  EXPECT_EQ(column[1], "");
+  column.resize(1);
+  column.resize(3);
+  EXPECT_EQ(column.codes(), (Vector<int32_t>{0, 0, 0}));
+}
+
+TEST(DictionaryColumn, comparison) {
+  DictionaryColumn a({"up", "down"});
+  DictionaryColumn b(Vector<int32_t>{1, 0}, StringColumn({"down", "up"}));
+  EXPECT_EQ(a, b);
+  b[1] = "up";
+  EXPECT_NE(a, b);
+  EXPECT_THROW_MSG(DictionaryColumn(Vector<int32_t>{2}, StringColumn({"a"})),
+                   std::runtime_error, "Dictionary code out of range.");
+}
+
+TEST(StringColumn, variable_copy_on_write) {
+  auto a = makeVariable<Data::String>({Dimension::X, 2},
+                                      Vector<std::string>{"a", "b"});
+  auto b(a);
+  EXPECT_EQ(a.get<const Data::String>()[0].data(),
+            b.get<const Data::String>()[0].data());
+  b.get<Data::String>()[0] = "changed";
+  EXPECT_EQ(a.get<const Data::String>()[0], "a");
+  EXPECT_EQ(b.get<const Data::String>()[0], "changed");
+}
+
+TEST(StringColumn, variable_slice_and_concatenate) {
+  auto var = makeVariable<Data::String>(
+      Dimensions({{Dimension::X, 2}, {Dimension::Y, 2}}),
+      Vector<std::string>{"a", "bb", "ccc", ""});
+  auto x1 = slice(var, Dimension::X, 1);
+  EXPECT_EQ(x1, makeVariable<Data::String>({Dimension::Y, 2},
+                                           Vector<std::string>{"bb", ""}));
+  auto y0 = slice(var, Dimension::Y, 0);
+  EXPECT_EQ(y0, makeVariable<Data::String>({Dimension::X, 2},
+                                           Vector<std::string>{"a", "bb"}));
+
+  auto joined = concatenate(Dimension::X, var, var);
+  EXPECT_EQ(joined,
+            makeVariable<Data::String>(
+                Dimensions({{Dimension::X, 4}, {Dimension::Y, 2}}),
+                Vector<std::string>{"a", "bb", "a", "bb", "ccc", "", "ccc",
+                                    ""}));
+}
+
+TEST(StringColumn, dataset_view) {
+  Dataset d;
+  d.insert<Coord::Polarization>({Dimension::Polarization, 3},
+                                Vector<std::string>{"up", "down", "up"});
+  d.insert<Data::Value>("", {Dimension::Polarization, 3}, {1.0, 2.0, 3.0});
+  DatasetView<Coord::Polarization, const Data::Value> view(d);
+  for (const auto &item : view)
+    if (item.value() > 2.5)
+      item.get<Coord::Polarization>() = "down";
+  const auto labels = d.get<const Coord::Polarization>();
+  EXPECT_EQ(labels[0], "up");
+  EXPECT_EQ(labels[2], "down");
+  EXPECT_EQ(labels.column().dictionary().size(), 2);
+}
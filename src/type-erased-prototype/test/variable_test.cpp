@@ -134,6 +134,25 @@ TEST(Variable, operator_plus_equal_transpose) {
   EXPECT_EQ(a.get<Data::Value>()[5], 12.0);
 }
 
+TEST(Variable, operator_plus_equal_transpose_large) {
+  // Large enough to be split into chunks for multiple threads.
+  const gsl::index nx = 300;
+  const gsl::index ny = 301;
+  auto a = makeVariable<Data::Value>(
+      Dimensions({{Dimension::X, nx}, {Dimension::Y, ny}}), nx * ny);
+  auto transpose = makeVariable<Data::Value>(
+      Dimensions({{Dimension::Y, ny}, {Dimension::X, nx}}), nx * ny);
+  auto data = transpose.get<Data::Value>();
+  for (gsl::index i = 0; i < data.size(); ++i)
+    data[i] = static_cast<double>(i);
+
+  EXPECT_NO_THROW(a += transpose);
+  const auto result = a.get<const Data::Value>();
+  for (gsl::index y = 0; y < ny; ++y)
+    for (gsl::index x = 0; x < nx; ++x)
+      ASSERT_EQ(result[y * nx + x], static_cast<double>(x * ny + y));
+}
+
 TEST(Variable, operator_plus_equal_different_dimensions) {
   auto a = makeVariable<Data::Value>({Dimension::X, 2}, {1.1, 2.2});
 
@@ -339,3 +358,37 @@ TEST(Variable, concatenate_unit_fail) {
   b.setUnit(Unit::Id::Length);
   EXPECT_NO_THROW(concatenate(Dimension::X, a, b));
 }
+
+TEST(Variable, gather) {
+  const auto parent = makeVariable<Data::Value>(
+      Dimensions({{Dimension::X, 2}, {Dimension::Y, 3}}),
+      {1.0, 2.0, 3.0, 4.0, 5.0, 6.0});
+  const std::vector<gsl::index> indices{2, 0, 2, 1};
+  const auto y = gather(parent, Dimension::Y, indices);
+  ASSERT_EQ(y.dimensions(), Dimensions({{Dimension::X, 2}, {Dimension::Y, 4}}));
+  const auto dataY = y.get<const Data::Value>();
+  EXPECT_EQ(std::vector<double>(dataY.begin(), dataY.end()),
+            (std::vector<double>{5.0, 6.0, 1.0, 2.0, 5.0, 6.0, 3.0, 4.0}));
+  const std::vector<gsl::index> swap{1, 0};
+  const auto x = gather(parent, Dimension::X, swap);
+  const auto dataX = x.get<const Data::Value>();
+  EXPECT_EQ(std::vector<double>(dataX.begin(), dataX.end()),
+            (std::vector<double>{2.0, 1.0, 4.0, 3.0, 6.0, 5.0}));
+  // The parent is unchanged.
+  EXPECT_EQ(parent.get<const Data::Value>()[0], 1.0);
+
+  const auto strings =
+      makeVariable<Data::String>({Dimension::Row, 2},
+                                 std::vector<std::string>{"a", "bc"});
+  const std::vector<gsl::index> rows{1, 1, 0};
+  const auto gathered = gather(strings, Dimension::Row, rows);
+  const auto data = gathered.get<const Data::String>();
+  ASSERT_EQ(data.size(), 3);
+  EXPECT_EQ(data[0], "bc");
+  EXPECT_EQ(data[1], "bc");
+  EXPECT_EQ(data[2], "a");
+
+  const std::vector<gsl::index> outOfRange{2};
+  EXPECT_THROW_MSG(gather(parent, Dimension::X, outOfRange),
+                   std::runtime_error, "Slice index out of range");
+}
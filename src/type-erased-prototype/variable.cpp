@@ -3,22 +3,26 @@
 /// @author Simon Heybrock
 /// Copyright &copy; 2018 ISIS Rutherford Appleton Laboratory, NScD Oak Ridge
 /// National Laboratory, and European Spallation Source ERIC.
+#include <algorithm>
+#include <functional>
+
 #include "variable.h"
+#include "parallel.h"
 #include "variable_view.h"
 
 template <template <class> class Op, class T> struct ArithmeticHelper {
   static void apply(Vector<T> &a, const VariableView<const Vector<T>> &b) {
-    std::transform(a.begin(), a.end(), b.begin(), a.begin(), Op<T>());
+    parallel::transform(a.size(), a.begin(), b.begin(), a.begin(), Op<T>());
   }
   static void apply(Vector<T> &a, const Vector<T> &b) {
-    std::transform(a.begin(), a.end(), b.begin(), a.begin(), Op<T>());
+    parallel::transform(a.size(), a.begin(), b.begin(), a.begin(), Op<T>());
   }
 };
 
 template <template <class> class Op, class T>
 struct ArithmeticHelper<Op, std::vector<T>> {
-  template <class Other>
-  static void apply(Vector<std::vector<T>> &a, const Other &b) {
+  template <class Container, class Other>
+  static void apply(Container &a, const Other &b) {
     throw std::runtime_error("Not an arithmetic type. Cannot apply operand.");
   }
 };
@@ -31,9 +35,55 @@ struct ArithmeticHelper<Op, std::pair<T, T>> {
   }
 };
 
+// Positions are added (and subtracted) component-wise, e.g., to move
+// detectors. Broadcasting is not supported.
+template <template <class> class Op> struct ArithmeticHelper<Op, Position> {
+  static void apply(PositionColumn &a, const PositionColumn &b) {
+    parallel::transform(a.size(), a.x().begin(), b.x().begin(), a.x().begin(),
+                        Op<double>());
+    parallel::transform(a.size(), a.y().begin(), b.y().begin(), a.y().begin(),
+                        Op<double>());
+    parallel::transform(a.size(), a.z().begin(), b.z().begin(), a.z().begin(),
+                        Op<double>());
+  }
+  template <class Other> static void apply(PositionColumn &, const Other &) {
+    throw std::runtime_error("Cannot broadcast positions.");
+  }
+};
+
+template <> struct ArithmeticHelper<std::multiplies, Position> {
+  template <class Other> static void apply(PositionColumn &, const Other &) {
+    throw std::runtime_error("Cannot multiply positions.");
+  }
+};
+
+// Masks are combined word-wise, i.e., 64 flags at a time. Addition is logical
+// or, multiplication logical and. Broadcasting is not supported.
+template <class WordOp> struct MaskArithmeticHelper {
+  static void apply(MaskColumn &a, const MaskColumn &b) {
+    const auto words = a.words();
+    parallel::transform(words.size(), words.begin(), b.words().begin(),
+                        words.begin(), WordOp());
+  }
+  template <class Other> static void apply(MaskColumn &, const Other &) {
+    throw std::runtime_error("Cannot broadcast masks.");
+  }
+};
+
+template <>
+struct ArithmeticHelper<std::plus, char>
+    : MaskArithmeticHelper<std::bit_or<uint64_t>> {};
+template <>
+struct ArithmeticHelper<std::multiplies, char>
+    : MaskArithmeticHelper<std::bit_and<uint64_t>> {};
+template <> struct ArithmeticHelper<std::minus, char> {
+  template <class Other> static void apply(MaskColumn &, const Other &) {
+    throw std::runtime_error("Cannot subtract masks.");
+  }
+};
+
 template <template <class> class Op> struct ArithmeticHelper<Op, std::string> {
-  template <class Other>
-  static void apply(Vector<std::string> &a, const Other) {
+  template <class T, class Other> static void apply(T &a, const Other &) {
     throw std::runtime_error("Cannot add strings. Use append() instead.");
   }
 };
@@ -48,6 +98,119 @@ void VariableConcept::setDimensions(const Dimensions &dimensions) {
   resize(m_dimensions.volume());
 }
 
+namespace {
+template <class T> struct is_vector : std::false_type {};
+template <class T> struct is_vector<Vector<T>> : std::true_type {};
+
+// Copies the slice `index` of `source` along `dim` to `target`. Source and
+// target must be contiguous containers.
+template <class Source, class Target>
+void copySliceData(const Source &source, const Dimensions &sourceDimensions,
+                   Target &target, const Dimension dim,
+                   const gsl::index index) {
+  auto data = gsl::make_span(source.data() +
+                                 index * sourceDimensions.offset(dim),
+                             &*source.end());
+  auto sliceDims = sourceDimensions;
+  if (index >= sliceDims.size(dim) || index < 0)
+    throw std::runtime_error("Slice index out of range");
+  if (sliceDims.label(sliceDims.count() - 1) == dim) {
+    // Slicing slowest dimension so data is contiguous, avoid using view.
+    parallel::copy(target.size(), data.begin(), target.begin());
+  } else {
+    sliceDims.erase(dim);
+    VariableView<const decltype(data)> sliceView(data, sliceDims,
+                                                 sourceDimensions);
+    parallel::copy(target.size(), sliceView.begin(), target.begin());
+  }
+}
+
+// Copies `source` to `target` starting at `offset` along `dim`. Source and
+// target must be contiguous containers.
+template <class Source, class Target>
+void copyFromData(const Source &source, const Dimensions &sourceDimensions,
+                  Target &target, const Dimensions &targetDimensions,
+                  const Dimension dim, const gsl::index offset) {
+  // TODO Can probably merge this method with copySliceData.
+  auto iterationDimensions = targetDimensions;
+  if (!sourceDimensions.contains(dim))
+    iterationDimensions.erase(dim);
+  else
+    iterationDimensions.resize(dim, sourceDimensions.size(dim));
+
+  auto targetSpan =
+      gsl::make_span(target.data() + offset * targetDimensions.offset(dim),
+                     &*target.end());
+  // For cases for minimizing use of VariableView --- just copy contiguous
+  // range where possible.
+  if (targetDimensions.label(targetDimensions.count() - 1) == dim) {
+    if (iterationDimensions == sourceDimensions) {
+      parallel::copy(source.size(), source.begin(), targetSpan.begin());
+    } else {
+      VariableView<const Source> sourceView(source, iterationDimensions,
+                                            sourceDimensions);
+      parallel::copy(iterationDimensions.volume(), sourceView.begin(),
+                     targetSpan.begin());
+    }
+  } else {
+    VariableView<decltype(targetSpan)> view(targetSpan, iterationDimensions,
+                                            targetDimensions);
+    if (iterationDimensions == sourceDimensions) {
+      parallel::copy(source.size(), source.begin(), view.begin());
+    } else {
+      VariableView<const Source> sourceView(source, iterationDimensions,
+                                            sourceDimensions);
+      parallel::copy(iterationDimensions.volume(), sourceView.begin(),
+                     view.begin());
+    }
+  }
+}
+
+// Copies the slice `indices[i]` of `source` along `dim` to the slice `i` of
+// `target`. A slice consists of blocks of contiguous elements, each thread
+// copies a range of blocks of the target.
+template <class Source, class Target>
+void gatherData(const Source &source, const Dimensions &sourceDimensions,
+                Target &target, const Dimension dim,
+                gsl::span<const gsl::index> indices) {
+  const auto size = sourceDimensions.size(dim);
+  const auto inner = sourceDimensions.offset(dim);
+  const gsl::index count = indices.size();
+  const auto outer = size * inner == 0
+                         ? 0
+                         : sourceDimensions.volume() / (size * inner);
+  parallel::forEachChunk(
+      outer * count,
+      [&](const gsl::index begin, const gsl::index end) {
+        const auto in = source.data();
+        const auto out = target.data();
+        auto slice = begin / count;
+        auto i = begin % count;
+        for (auto block = begin; block < end; ++block) {
+          const auto offset = (slice * size + indices[i]) * inner;
+          if (inner == 1)
+            out[block] = in[offset];
+          else
+            std::copy(in + offset, in + offset + inner, out + block * inner);
+          if (++i == count) {
+            i = 0;
+            ++slice;
+          }
+        }
+      },
+      std::max(gsl::index{1}, parallel::grainSize / std::max(gsl::index{1},
+                                                             inner)));
+}
+
+// Columns such as StringColumn cannot be written element-wise in parallel and
+// in arbitrary order. We slice and concatenate views of their elements instead
+// and build a new column from the result.
+template <class T>
+Vector<typename T::const_reference> elementViews(const T &column) {
+  return Vector<typename T::const_reference>(column.begin(), column.end());
+}
+}
+
 template <class T> class VariableModel final : public VariableConcept {
 public:
   VariableModel(Dimensions dimensions, T model)
@@ -108,57 +271,59 @@ public:
   void copySlice(const VariableConcept &otherConcept, const Dimension dim,
                  const gsl::index index) override {
     const auto &other = dynamic_cast<const VariableModel<T> &>(otherConcept);
-    auto data = gsl::make_span(other.m_model.data() +
-                                   index * other.dimensions().offset(dim),
-                               &*other.m_model.end());
-    auto sliceDims = other.dimensions();
-    if (index >= sliceDims.size(dim) || index < 0)
-      throw std::runtime_error("Slice index out of range");
-    if (sliceDims.label(sliceDims.count() - 1) == dim) {
-      // Slicing slowest dimension so data is contiguous, avoid using view.
-      std::copy(data.begin(), data.begin() + m_model.size(), m_model.begin());
-    } else {
-      sliceDims.erase(dim);
-      VariableView<const decltype(data)> sliceView(data, sliceDims,
-                                                   other.dimensions());
-      std::copy(sliceView.begin(), sliceView.end(), m_model.begin());
-    }
+    copySlice(other, dim, index, is_vector<T>{});
+  }
+
+  void copySlice(const VariableModel<T> &other, const Dimension dim,
+                 const gsl::index index, std::true_type) {
+    copySliceData(other.m_model, other.dimensions(), m_model, dim, index);
+  }
+
+  void copySlice(const VariableModel<T> &other, const Dimension dim,
+                 const gsl::index index, std::false_type) {
+    Vector<typename T::const_reference> target(m_model.size());
+    copySliceData(elementViews(other.m_model), other.dimensions(), target, dim,
+                  index);
+    m_model = T(target.begin(), target.end());
   }
 
   void copyFrom(const VariableConcept &otherConcept, const Dimension dim,
                 const gsl::index offset) override {
-    // TODO Can probably merge this method with copySlice.
     const auto &other = dynamic_cast<const VariableModel<T> &>(otherConcept);
+    copyFrom(other, dim, offset, is_vector<T>{});
+  }
 
-    auto iterationDimensions = dimensions();
-    if (!other.dimensions().contains(dim))
-      iterationDimensions.erase(dim);
-    else
-      iterationDimensions.resize(dim, other.dimensions().size(dim));
-
-    auto target = gsl::make_span(
-        m_model.data() + offset * dimensions().offset(dim), &*m_model.end());
-    // For cases for minimizing use of VariableView --- just copy contiguous
-    // range where possible.
-    if (dimensions().label(dimensions().count() - 1) == dim) {
-      if (iterationDimensions == other.dimensions()) {
-        std::copy(other.m_model.begin(), other.m_model.end(), target.begin());
-      } else {
-        VariableView<const T> otherView(other.m_model, iterationDimensions,
-                                        other.dimensions());
-        std::copy(otherView.begin(), otherView.end(), target.begin());
-      }
-    } else {
-      VariableView<decltype(target)> view(target, iterationDimensions,
-                                          dimensions());
-      if (iterationDimensions == other.dimensions()) {
-        std::copy(other.m_model.begin(), other.m_model.end(), view.begin());
-      } else {
-        VariableView<const T> otherView(other.m_model, iterationDimensions,
-                                        other.dimensions());
-        std::copy(otherView.begin(), otherView.end(), view.begin());
-      }
-    }
+  void copyFrom(const VariableModel<T> &other, const Dimension dim,
+                const gsl::index offset, std::true_type) {
+    copyFromData(other.m_model, other.dimensions(), m_model, dimensions(), dim,
+                 offset);
+  }
+
+  void copyFrom(const VariableModel<T> &other, const Dimension dim,
+                const gsl::index offset, std::false_type) {
+    auto target = elementViews(m_model);
+    copyFromData(elementViews(other.m_model), other.dimensions(), target,
+                 dimensions(), dim, offset);
+    m_model = T(target.begin(), target.end());
+  }
+
+  void gather(const VariableConcept &otherConcept, const Dimension dim,
+              gsl::span<const gsl::index> indices) override {
+    const auto &other = dynamic_cast<const VariableModel<T> &>(otherConcept);
+    gather(other, dim, indices, is_vector<T>{});
+  }
+
+  void gather(const VariableModel<T> &other, const Dimension dim,
+              gsl::span<const gsl::index> indices, std::true_type) {
+    gatherData(other.m_model, other.dimensions(), m_model, dim, indices);
+  }
+
+  void gather(const VariableModel<T> &other, const Dimension dim,
+              gsl::span<const gsl::index> indices, std::false_type) {
+    Vector<typename T::const_reference> target(m_model.size());
+    gatherData(elementViews(other.m_model), other.dimensions(), target, dim,
+               indices);
+    m_model = T(target.begin(), target.end());
   }
 
   T m_model;
@@ -175,7 +340,7 @@ void Variable::setDimensions(const Dimensions &dimensions) {
   if (dimensions == m_object->dimensions())
     return;
   m_object = m_object->cloneEmpty();
-  m_object.access().setDimensions(dimensions);
+  access().setDimensions(dimensions);
 }
 
 template <class T> const T &Variable::cast() const {
@@ -183,23 +348,25 @@ template <class T> const T &Variable::cast() const {
 }
 
 template <class T> T &Variable::cast() {
-  return dynamic_cast<VariableModel<T> &>(m_object.access()).m_model;
+  return dynamic_cast<VariableModel<T> &>(access()).m_model;
 }
 
-#define INSTANTIATE(...)                                                       \
+#define INSTANTIATE_STORAGE(...)                                               \
   template Variable::Variable(uint32_t, const Unit::Id, Dimensions,            \
-                              Vector<__VA_ARGS__>);                            \
-  template Vector<__VA_ARGS__> &Variable::cast<Vector<__VA_ARGS__>>();         \
-  template const Vector<__VA_ARGS__> &Variable::cast<Vector<__VA_ARGS__>>()    \
-      const;
-
-INSTANTIATE(std::string)
+                              __VA_ARGS__);                                    \
+  template __VA_ARGS__ &Variable::cast<__VA_ARGS__>();                         \
+  template const __VA_ARGS__ &Variable::cast<__VA_ARGS__>() const;
+#define INSTANTIATE(...) INSTANTIATE_STORAGE(Vector<__VA_ARGS__>)
+
+INSTANTIATE_STORAGE(StringColumn)
+INSTANTIATE_STORAGE(DictionaryColumn)
+INSTANTIATE_STORAGE(IndexListColumn)
+INSTANTIATE_STORAGE(PositionColumn)
+INSTANTIATE_STORAGE(MaskColumn)
 INSTANTIATE(double)
-INSTANTIATE(char)
 INSTANTIATE(int32_t)
 INSTANTIATE(int64_t)
 INSTANTIATE(std::pair<int64_t, int64_t>)
-INSTANTIATE(std::vector<gsl::index>)
 
 bool Variable::operator==(const Variable &other) const {
   // Compare even before pointer comparison since data may be shared even if
@@ -232,7 +399,7 @@ Variable &Variable::operator+=(const Variable &other) {
   if (dimensions().contains(other.dimensions())) {
     // Note: This will broadcast/transpose the RHS if required. We do not
     // support changing the dimensions of the LHS though!
-    m_object.access() += *other.m_object;
+    access() += *other.m_object;
   } else {
     throw std::runtime_error("Cannot add Variables: Dimensions do not match.");
   }
@@ -244,7 +411,7 @@ Variable &Variable::operator-=(const Variable &other) {
   if (m_unit != other.m_unit)
     throw std::runtime_error("Cannot subtract Variables: Units do not match.");
   if (dimensions().contains(other.dimensions())) {
-    m_object.access() -= *other.m_object;
+    access() -= *other.m_object;
   } else {
     throw std::runtime_error(
         "Cannot subtract Variables: Dimensions do not match.");
@@ -258,7 +425,7 @@ Variable &Variable::operator*=(const Variable &other) {
     throw std::runtime_error(
         "Cannot multiply Variables: Dimensions do not match.");
   m_unit = m_unit * other.m_unit;
-  m_object.access() *= *other.m_object;
+  access() *= *other.m_object;
   return *this;
 }
 
@@ -287,6 +454,26 @@ Variable slice(const Variable &var, const Dimension dim,
   return out;
 }
 
+Variable gather(const Variable &var, const Dimension dim,
+                gsl::span<const gsl::index> indices) {
+  const auto &dims = var.dimensions();
+  if (dims.isRagged())
+    throw std::runtime_error("Cannot gather ragged variables.");
+  const auto size = dims.size(dim);
+  if (std::any_of(indices.begin(), indices.end(),
+                  [size](const gsl::index i) { return i < 0 || i >= size; }))
+    throw std::runtime_error("Slice index out of range");
+  auto out(var);
+  auto outDims = dims;
+  outDims.resize(dim, indices.size());
+  // Replace rather than copy-on-write the data shared with `var`, which would
+  // copy it only to overwrite it.
+  out.setDimensions(Dimensions{});
+  out.setDimensions(outDims);
+  out.data().gather(var.data(), dim, indices);
+  return out;
+}
+
 Variable concatenate(const Dimension dim, const Variable &a1,
                      const Variable &a2) {
   if (a1.type() != a2.type())
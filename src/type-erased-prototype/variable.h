@@ -34,6 +34,8 @@ public:
                          const gsl::index index) = 0;
   virtual void copyFrom(const VariableConcept &other, const Dimension dim,
                         const gsl::index offset) = 0;
+  virtual void gather(const VariableConcept &other, const Dimension dim,
+                      gsl::span<const gsl::index> indices) = 0;
 
   const Dimensions &dimensions() const { return m_dimensions; }
   void setDimensions(const Dimensions &dimensions);
@@ -78,7 +80,7 @@ public:
   void setDimensions(const Dimensions &dimensions);
 
   const VariableConcept &data() const { return *m_object; }
-  VariableConcept &data() { return m_object.access(); }
+  VariableConcept &data() { return access(); }
 
   template <class Tag> bool valueTypeIs() const {
     return tag_id<Tag> == m_type;
@@ -87,11 +89,18 @@ public:
   uint16_t type() const { return m_type; }
   bool isCoord() const { return m_type < std::tuple_size<Coord::tags>::value; }
 
+  /// Returns true if the events in this variable are sorted by `Tag` within
+  /// each spectrum, see sortEvents. Any write access to the data clears this.
+  template <class Tag> bool isSortedBy() const {
+    return m_sortedBy == tag_id<Tag>;
+  }
+  uint16_t sortedBy() const { return m_sortedBy; }
+  void setSortedBy(const uint16_t id) { m_sortedBy = id; }
+
   template <class Tag> auto get() const {
-    // For now we support only variables that are a std::vector. In principle we
-    // could support anything that is convertible to gsl::span (or an adequate
-    // replacement).
-    return gsl::make_span(cast<Vector<typename Tag::type>>());
+    // Returns gsl::span for variables stored as Vector, ColumnSpan for other
+    // storage types, see storage_t.
+    return makeSpan(cast<storage_t<Tag>>());
   }
 
   template <class Tag>
@@ -101,14 +110,31 @@ public:
 
   template <class Tag>
   auto get(std::enable_if_t<!std::is_const<Tag>::value> * = nullptr) {
-    return gsl::make_span(cast<Vector<typename Tag::type>>());
+    return makeSpan(cast<storage_t<Tag>>());
   }
 
 private:
+  template <class T> static auto makeSpan(Vector<T> &data) {
+    return gsl::make_span(data);
+  }
+  template <class T> static auto makeSpan(const Vector<T> &data) {
+    return gsl::make_span(data);
+  }
+  template <class Column> static auto makeSpan(Column &data) {
+    return ColumnSpan<Column>(data);
+  }
+
   template <class T> const T &cast() const;
   template <class T> T &cast();
+  VariableConcept &access() {
+    m_sortedBy = unsorted;
+    return m_object.access();
+  }
 
+  static constexpr uint16_t unsorted =
+      std::tuple_size<detail::all_tags>::value;
   uint16_t m_type;
+  uint16_t m_sortedBy{unsorted};
   Unit m_unit;
   std::string m_name;
   cow_ptr<VariableConcept> m_object;
@@ -117,15 +143,19 @@ private:
 template <class Tag, class... Args>
 Variable makeVariable(Dimensions dimensions, Args &&... args) {
   return Variable(tag_id<Tag>, Tag::unit, std::move(dimensions),
-                  Vector<typename Tag::type>(std::forward<Args>(args)...));
+                  storage_t<Tag>(std::forward<Args>(args)...));
 }
 
 template <class Tag, class T>
 Variable makeVariable(Dimensions dimensions, std::initializer_list<T> values) {
   return Variable(tag_id<Tag>, Tag::unit, std::move(dimensions),
-                  Vector<typename Tag::type>(values));
+                  storage_t<Tag>(values));
 }
 
+/// Type returned by Variable::get<Tag>, i.e., gsl::span or ColumnSpan.
+template <class Tag>
+using span_t = decltype(std::declval<Variable &>().template get<Tag>());
+
 Variable operator+(Variable a, const Variable &b);
 Variable operator-(Variable a, const Variable &b);
 Variable operator*(Variable a, const Variable &b);
@@ -134,5 +164,9 @@ Variable slice(const Variable &var, const Dimension dim,
                const gsl::index index);
 Variable concatenate(const Dimension dim, const Variable &a1,
                      const Variable &a2);
+/// Returns a variable whose slice `i` along `dim` is the slice `indices[i]`
+/// of `var`, e.g., to reorder or select slices. Indices may repeat.
+Variable gather(const Variable &var, const Dimension dim,
+                gsl::span<const gsl::index> indices);
 
 #endif // VARIABLE_H